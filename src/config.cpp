@@ -1,4 +1,5 @@
 #include "config.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -24,6 +25,11 @@ bool Config::Load() {
     // Set default values
     sensitivity = 50;
     ffb_gain = 0.3f;
+    ffb_tick_rate = 1000;
+    ffb_curve = ffb::DefaultCurvePoints();
+    ffb_physics = ffb::PhysicsParams{};
+    report_keepalive_ms = 0;
+    io_backend = io::Backend::kEpoll;
     
     // Set default button mappings (for reference - hardcoded in wheel_device.cpp)
     button_map["KEY_Q"] = BTN_TRIGGER;
@@ -87,6 +93,20 @@ void Config::ParseINI(const std::string& content) {
         // Check for section
         if (line[0] == '[' && line[line.length() - 1] == ']') {
             section = line.substr(1, line.length() - 2);
+            if (section.rfind("wheel.", 0) == 0) {
+                int index = 0;
+                try {
+                    index = std::stoi(section.substr(6));
+                } catch (...) {
+                }
+                if (index < 1 || index >= kMaxWheels) {
+                    std::cerr << "Ignoring [" << section << "] (wheels are numbered 1-" << kMaxWheels - 1 << ")"
+                              << std::endl;
+                    section.clear();
+                } else {
+                    extra_wheels[index];  // an empty section still adds the wheel
+                }
+            }
             continue;
         }
         
@@ -110,6 +130,26 @@ void Config::ParseINI(const std::string& content) {
                 keyboard_device = value;
             } else if (key == "mouse") {
                 mouse_device = value;
+            } else if (key == "udc") {
+                udc = value;
+            }
+        } else if (section.rfind("wheel.", 0) == 0) {
+            WheelConfig& wheel = extra_wheels[std::stoi(section.substr(6))];
+            if (key == "keyboard") {
+                wheel.keyboard_device = value;
+            } else if (key == "mouse") {
+                wheel.mouse_device = value;
+            } else if (key == "sensitivity") {
+                wheel.sensitivity = std::clamp(std::stoi(value), 1, 100);
+            } else if (key == "udc") {
+                wheel.udc = value;
+            } else if (key == "remote") {
+                wheel.remote_listen = value;
+            } else {
+                std::string error;
+                if (!SetKeyBinding(wheel.bindings, key, value, error)) {
+                    std::cerr << "Ignoring " << key << " in [" << section << "]: " << error << std::endl;
+                }
             }
         } else if (section == "sensitivity") {
             if (key == "sensitivity") {
@@ -125,6 +165,78 @@ void Config::ParseINI(const std::string& content) {
                 if (val < 0.1f) val = 0.1f;
                 if (val > 4.0f) val = 4.0f;
                 ffb_gain = val;
+            } else if (key == "tick_rate") {
+                int val = std::stoi(value);
+                if (val < 100) val = 100;
+                if (val > 4000) val = 4000;
+                ffb_tick_rate = val;
+            } else if (key == "inertia") {
+                ffb_physics.inertia = std::clamp(std::stof(value), 0.05f, 20.0f);
+            } else if (key == "stiffness") {
+                ffb_physics.stiffness = std::clamp(std::stof(value), 1.0f, 2000.0f);
+            } else if (key == "damping") {
+                ffb_physics.damping = std::clamp(std::stof(value), 0.0f, 200.0f);
+            } else if (key == "friction") {
+                ffb_physics.friction = std::clamp(std::stof(value), 0.0f, 200000.0f);
+            } else if (key == "end_stop") {
+                ffb_physics.end_stop = std::clamp(std::stof(value), 1000.0f, 32767.0f);
+            } else if (key == "end_stop_stiffness") {
+                ffb_physics.end_stop_stiffness = std::clamp(std::stof(value), 0.0f, 100000.0f);
+            } else if (key == "physics_rate") {
+                ffb_physics.step_hz = std::clamp(std::stoi(value), 500, 8000);
+            } else if (key == "record") {
+                ffb_record_path = value;
+            } else if (key == "curve") {
+                std::string error;
+                if (!ffb::ParseCurvePoints(value, ffb_curve, error)) {
+                    std::cerr << "Ignoring [ffb] curve (" << error << "), using default" << std::endl;
+                    ffb_curve = ffb::DefaultCurvePoints();
+                }
+            }
+        } else if (section == "output") {
+            if (key == "keepalive_ms") {
+                report_keepalive_ms = std::clamp(std::stoi(value), 0, 10000);
+            }
+        } else if (section == "io") {
+            if (key == "backend" && !io::ParseBackend(value, io_backend)) {
+                std::cerr << "Ignoring [io] backend=" << value << " (expected epoll or io_uring)" << std::endl;
+            }
+        } else if (section == "metrics") {
+            if (key == "socket") {
+                metrics_socket = value;
+            }
+        } else if (section == "telemetry") {
+            if (key == "shm") {
+                telemetry_shm = value;
+                if (!telemetry_shm.empty() && telemetry_shm[0] != '/') {
+                    telemetry_shm.insert(telemetry_shm.begin(), '/');
+                }
+            } else if (key == "slots") {
+                telemetry_slots = std::clamp(std::stoi(value), 16, 1 << 20);
+            }
+        } else if (section == "inject") {
+            if (key == "shm") {
+                inject_shm = value;
+                if (!inject_shm.empty() && inject_shm[0] != '/') {
+                    inject_shm.insert(inject_shm.begin(), '/');
+                }
+            } else if (key == "sources") {
+                std::string error;
+                if (!inject::ParseLaneConfigs(value, inject_lanes, error) || inject_lanes.empty()) {
+                    std::cerr << "Ignoring [inject] sources (" << (error.empty() ? "no lanes" : error)
+                              << "), using external:1" << std::endl;
+                    inject_lanes = {{"external", 1}};
+                }
+            } else if (key == "hold_ms") {
+                inject_hold_ms = std::clamp(std::stoi(value), 0, 60000);
+            }
+        } else if (section == "remote") {
+            if (key == "listen") {
+                remote_listen = value;
+            } else if (key == "priority") {
+                remote_priority = std::stoi(value);
+            } else if (key == "hold_ms") {
+                remote_hold_ms = std::clamp(std::stoi(value), 0, 60000);
             }
         } else if (section == "button_mapping") {
             // Map button code to key name (format: BUTTON=KEY)
@@ -160,6 +272,16 @@ void Config::ParseINI(const std::string& content) {
             }
         }
     }
+
+    // Each [ffb] key is clamped on its own, but light inertia with a stiff end stop
+    // needs a faster step than physics_rate may give (SteeringModel enforces the same).
+    const int stable_hz = ffb::MinStableStepHz(ffb_physics);
+    if (ffb_physics.step_hz < stable_hz) {
+        std::cerr << "[ffb] physics_rate=" << ffb_physics.step_hz << " is unstable with inertia="
+                  << ffb_physics.inertia << " and stiffness " << ffb_physics.stiffness << "+"
+                  << ffb_physics.end_stop_stiffness << "; using " << stable_hz << std::endl;
+        ffb_physics.step_hz = stable_hz;
+    }
 }
 
 void Config::SaveDefault(const char* path) {
@@ -177,15 +299,88 @@ void Config::SaveDefault(const char* path) {
     file << "# keyboard=/dev/input/event6\n";
     file << "# mouse=/dev/input/event11\n";
     file << "keyboard=\n";
-    file << "mouse=\n\n";
+    file << "mouse=\n";
+    file << "# USB device controller (see /sys/class/udc); blank takes the first one free\n";
+    file << "udc=\n\n";
     
     file << "[sensitivity]\n";
     file << "sensitivity=50\n\n";
 
     file << "[ffb]\n";
     file << "# Overall force feedback strength multiplier (0.1 - 4.0)\n";
-    file << "gain=0.3\n\n";
+    file << "gain=0.3\n";
+    file << "# Physics loop wake rate in Hz (100 - 4000)\n";
+    file << "tick_rate=1000\n";
+    file << "# Torque shaping: |force|:output control points, linearly interpolated\n";
+    file << "curve=" << ffb::FormatCurvePoints(ffb::DefaultCurvePoints()) << "\n";
+    file << "# Steering model, integrated at physics_rate Hz regardless of tick_rate\n";
+    file << "# inertia (0.05-20), stiffness = hand pull toward the FFB target (1-2000),\n";
+    file << "# damping (0-200), friction = Coulomb friction (0-200000),\n";
+    file << "# end_stop = offset where the stop spring engages (1000-32767)\n";
+    file << "inertia=1.0\n";
+    file << "stiffness=120\n";
+    file << "damping=8\n";
+    file << "friction=0\n";
+    file << "end_stop=22000\n";
+    file << "end_stop_stiffness=4000\n";
+    file << "physics_rate=2000\n";
+    file << "# Record every FFB OUTPUT packet to this file for --ffb-sim replay (blank disables)\n";
+    file << "record=\n\n";
     
+    file << "[output]\n";
+    file << "# Identical IN reports are not rewritten. Hosts that expect a steady report\n";
+    file << "# stream can have the last one resent after this many ms (0 - 10000, 0 disables)\n";
+    file << "keepalive_ms=0\n\n";
+
+    file << "[io]\n";
+    file << "# epoll: one read()/write() per device wakeup and report (default)\n";
+    file << "# io_uring: multishot reads on input devices and the gadget endpoint, ring-submitted\n";
+    file << "# report writes; needs Linux 6.7+ and falls back to epoll otherwise\n";
+    file << "backend=epoll\n\n";
+
+    file << "[metrics]\n";
+    file << "# Unix socket serving runtime counters as text (blank disables)\n";
+    file << "socket=/run/wheel-emulator/metrics.sock\n\n";
+
+    file << "[telemetry]\n";
+    file << "# Shared-memory ring (/dev/shm/<name>) carrying every wheel state change and FFB\n";
+    file << "# tick for overlays and loggers; layout in src/telemetry/telemetry_ring.h (blank disables)\n";
+    file << "shm=\n";
+    file << "# Records kept before the oldest is overwritten (rounded up to a power of two)\n";
+    file << "slots=4096\n\n";
+
+    file << "[inject]\n";
+    file << "# Shared-memory lanes (/dev/shm/<name>) through which other processes set steering,\n";
+    file << "# pedals, D-pad and buttons; layout in src/input/injection_channel.h (blank disables)\n";
+    file << "shm=\n";
+    file << "# name:priority per lane. Keyboard and mouse are priority 0 and lose ties; each control\n";
+    file << "# follows its highest-priority holder\n";
+    file << "sources=external:1\n";
+    file << "# A lane that sends nothing for this long releases its controls (0 = hold until released)\n";
+    file << "hold_ms=500\n\n";
+
+    file << "[remote]\n";
+    file << "# UDP address (host:port) for input packets from another process or host; same\n";
+    file << "# controls as [inject], format in src/input/remote_input.h (blank disables)\n";
+    file << "listen=\n";
+    file << "priority=1\n";
+    file << "hold_ms=500\n\n";
+
+    file << "# More wheels, each its own USB gadget (g29wheel1, ...) on its own UDC, driven by\n";
+    file << "# the same process. Add one [wheel.N] section per extra wheel, N = 1-7. [ffb], [io],\n";
+    file << "# [output] and [inject] apply to all; shm names and the FFB record path get a .N suffix.\n";
+    file << "# Every wheel, wheel 0 included, then needs its own keyboard= and mouse= under\n";
+    file << "# [devices] or [wheel.N]. A wheel may rebind controls (throttle, brake, clutch,\n";
+    file << "# dpad_up/down/left/right, button1-button26) to KEY_* names or none.\n";
+    file << "# [wheel.1]\n";
+    file << "# keyboard=/dev/input/event7\n";
+    file << "# mouse=/dev/input/event12\n";
+    file << "# sensitivity=50\n";
+    file << "# udc=dummy_udc.1\n";
+    file << "# remote=0.0.0.0:9772\n";
+    file << "# throttle=KEY_KP8\n";
+    file << "# brake=KEY_KP5\n\n";
+
     file << "[controls]\n";
     file << "# Logitech G29 Racing Wheel Controls\n";
     file << "# Format: CONTROL=KEYBOARD_KEY or MOUSE_BUTTON\n\n";
@@ -3,13 +3,51 @@
 
 #include <string>
 #include <map>
+#include <vector>
+
+#include "ffb/steering_model.h"
+#include "ffb/torque_curve.h"
+#include "input/injection_channel.h"
+#include "input/key_bindings.h"
+#include "io/uring.h"
+
+// A wheel beyond the first, from a [wheel.N] section. Everything else ([ffb], [io],
+// [inject], ...) is shared; the top-level keys describe wheel 0. With several wheels,
+// each one needs its own keyboard and mouse.
+struct WheelConfig {
+    std::string keyboard_device;
+    std::string mouse_device;
+    int sensitivity = 0;        // 0 = same as [sensitivity]
+    std::string udc;            // empty = first UDC no other gadget holds
+    std::string remote_listen;  // host:port for this wheel's UDP input; empty disables
+    KeyBindings bindings = DefaultKeyBindings();  // throttle=KEY_KP8, button1=none, ...
+};
 
 class Config {
 public:
+    static constexpr int kMaxWheels = 8;
+
     int sensitivity = 50;
     float ffb_gain = 0.3f;
+    int ffb_tick_rate = 1000;     // FFB physics loop wake rate in Hz
+    std::vector<ffb::CurvePoint> ffb_curve = ffb::DefaultCurvePoints();  // |force| -> torque
+    ffb::PhysicsParams ffb_physics;  // steering model, see [ffb] inertia/damping/...
+    int report_keepalive_ms = 0;  // resend an unchanged IN report after this long; 0 disables
+    io::Backend io_backend = io::Backend::kEpoll;  // evdev/hidg syscall path, see [io] backend
+    std::string ffb_record_path;  // FFB OUTPUT trace for --ffb-sim; empty disables
     std::string keyboard_device;  // e.g. "/dev/input/event6"
     std::string mouse_device;     // e.g. "/dev/input/event11"
+    std::string udc;              // USB device controller for wheel 0; empty picks the first free one
+    std::string metrics_socket = "/run/wheel-emulator/metrics.sock";  // empty disables
+    std::string telemetry_shm;    // shm_open() name for the live state ring; empty disables
+    int telemetry_slots = 4096;   // ring capacity in records, rounded up to a power of two
+    std::string inject_shm;       // shm_open() name for external input lanes; empty disables
+    std::vector<inject::LaneConfig> inject_lanes = {{"external", 1}};  // [inject] sources
+    int inject_hold_ms = 500;     // a silent lane releases its controls after this; 0 = never
+    std::string remote_listen;    // host:port for UDP input packets; empty disables
+    int remote_priority = 1;      // merge priority of the UDP source (keyboard/mouse are 0)
+    int remote_hold_ms = 500;     // a silent sender releases its controls after this; 0 = never
+    std::map<int, WheelConfig> extra_wheels;  // [wheel.1] ... [wheel.7]
     std::map<std::string, int> button_map;
     
     // Load configuration from default locations
@@ -18,9 +56,11 @@ public:
     
     // Save default configuration to specified path
     void SaveDefault(const char* path);
+
+    // Parse a config file without generating defaults (used by diagnostic tools)
+    bool LoadFromFile(const char* path);
     
 private:
-    bool LoadFromFile(const char* path);
     void ParseINI(const std::string& content);
 };
 
@@ -0,0 +1,81 @@
+#include "command_queue.h"
+
+namespace ffb {
+
+namespace {
+
+// Slots a packet reads or writes; default-spring and extended commands touch none.
+unsigned SlotMask(const CommandPacket& packet) {
+    if (packet[0] == 0xf8) {
+        return 0;
+    }
+    switch (packet[0] & 0x0f) {
+        case 0x0:  // Download
+        case 0x1:  // Download and play
+        case 0x2:  // Play
+        case 0x3:  // Stop
+        case 0xc:  // Refresh
+            return packet[0] >> 4;
+        default:
+            return 0;
+    }
+}
+
+// Download(+play)/refresh of a constant or variable level: only the newest matters.
+bool IsLevelUpdate(const CommandPacket& packet) {
+    unsigned op = packet[0] & 0x0f;
+    bool download = op == 0x0 || op == 0x1 || op == 0xc;
+    return download && SlotMask(packet) != 0 && (packet[1] == 0x00 || packet[1] == 0x08);
+}
+
+}  // namespace
+
+CommandQueue::CommandQueue() : head_(0), tail_(0), packets_{} {}
+
+bool CommandQueue::Push(const CommandPacket& packet) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity) {
+        return false;
+    }
+    packets_[head & (kCapacity - 1)] = packet;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandQueue::Pop(CommandPacket& packet) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    packet = packets_[tail & (kCapacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandQueue::Empty() const {
+    return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+}
+
+CommandBatch::CommandBatch() : packets_{}, count_(0) {}
+
+bool CommandBatch::Add(const CommandPacket& packet) {
+    if (IsLevelUpdate(packet)) {
+        const unsigned mask = SlotMask(packet);
+        for (size_t i = count_; i-- > 0;) {
+            const CommandPacket& staged = packets_[i];
+            if (staged[0] == packet[0] && IsLevelUpdate(staged)) {
+                packets_[i] = packet;
+                return true;
+            }
+            if (SlotMask(staged) & mask) {
+                break;
+            }
+        }
+    }
+    if (count_ < kCapacity) {
+        packets_[count_++] = packet;
+    }
+    return false;
+}
+
+}  // namespace ffb
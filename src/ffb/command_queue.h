@@ -0,0 +1,63 @@
+#ifndef FFB_COMMAND_QUEUE_H
+#define FFB_COMMAND_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ffb {
+
+using CommandPacket = std::array<uint8_t, 7>;
+
+// Single-producer/single-consumer ring of raw OUTPUT packets. USBGadgetOutputThread
+// pushes, FFBUpdateThread pops; neither side ever blocks the other.
+class CommandQueue {
+public:
+    static constexpr size_t kCapacity = 256;
+
+    CommandQueue();
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    // Producer side. Returns false when the ring is full.
+    bool Push(const CommandPacket& packet);
+    // Consumer side.
+    bool Pop(CommandPacket& packet);
+    bool Empty() const;
+
+private:
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+    alignas(64) std::atomic<size_t> head_;  // next slot the producer writes
+    alignas(64) std::atomic<size_t> tail_;  // next slot the consumer reads
+    std::array<CommandPacket, kCapacity> packets_;
+};
+
+// Packets decoded from one read burst, staged by the producer before they enter the
+// queue. A constant-force level update replaces an earlier one for the same slots
+// unless a command touching those slots sits between them, so a host streaming
+// torque at a high rate costs the physics loop one packet per burst.
+class CommandBatch {
+public:
+    static constexpr size_t kCapacity = 64;
+
+    CommandBatch();
+
+    // Returns true if the packet superseded an earlier staged update.
+    bool Add(const CommandPacket& packet);
+    bool Full() const { return count_ == kCapacity; }
+    bool Empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    const CommandPacket& operator[](size_t index) const { return packets_[index]; }
+    void Clear() { count_ = 0; }
+
+private:
+    std::array<CommandPacket, kCapacity> packets_;
+    size_t count_;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_COMMAND_QUEUE_H
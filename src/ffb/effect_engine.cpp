@@ -0,0 +1,390 @@
+#include "effect_engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ffb {
+
+namespace {
+
+constexpr size_t kPacketSize = 7;
+constexpr float kDefaultAutocenter = 1024.0f;
+
+// Condition scaling: a unit coefficient yields full-scale force at full lock (spring),
+// at one full-range sweep per second (damper), or for any motion (friction).
+constexpr float kSpringForce = kFullScaleForce;
+constexpr float kDamperForce = kFullScaleForce * 0.5f;
+constexpr float kFrictionForce = kFullScaleForce * 0.25f;
+// Velocity (position units/s) at which friction reaches half strength; keeps the
+// sign change smooth instead of chattering around zero.
+constexpr float kFrictionKnee = 0.02f;
+
+enum EffectType : uint8_t {
+    kConstant = 0x00,
+    kSpring = 0x01,
+    kDamper = 0x02,
+    kAutoCenterSpring = 0x03,
+    kSawtoothUp = 0x04,
+    kSawtoothDown = 0x05,
+    kTrapezoid = 0x06,
+    kRectangle = 0x07,
+    kVariable = 0x08,
+    kRamp = 0x09,
+    kSquare = 0x0a,
+    kHighResSpring = 0x0b,
+    kHighResDamper = 0x0c,
+    kHighResAutoCenterSpring = 0x0d,
+    kFriction = 0x0e,
+};
+
+// Level bytes are centered on 0x80; the host's positive direction is our negative
+// torque, matching the original single-slot parser.
+float LevelForce(uint8_t level) {
+    return -static_cast<float>(static_cast<int>(level) - 0x80) * 48.0f;
+}
+
+float Position8(uint8_t value) {
+    return (static_cast<float>(value) - 127.5f) / 127.5f;
+}
+
+float Position11(unsigned value) {
+    return (static_cast<float>(value) - 1023.5f) / 1023.5f;
+}
+
+float Coefficient(float magnitude, bool invert) {
+    return invert ? -magnitude : magnitude;
+}
+
+float ClipForce(uint8_t clip) {
+    // Hosts that never set CLIP send zero; treat that as "no limit".
+    return clip == 0 ? kFullScaleForce : static_cast<float>(clip) * (kFullScaleForce / 255.0f);
+}
+
+float PeriodSeconds(float milliseconds) {
+    return std::max(milliseconds, 1.0f) * 0.001f;
+}
+
+}  // namespace
+
+EffectTable::EffectTable() : default_autocenter_(kDefaultAutocenter), generation_(0) {
+    Reset();
+}
+
+void EffectTable::Reset() {
+    for (size_t slot = 0; slot < kEffectSlots; ++slot) {
+        ClearSlot(slot);
+    }
+    slots_.autocenter = 0.0f;
+    default_autocenter_ = kDefaultAutocenter;
+    ++generation_;
+}
+
+void EffectTable::ClearSlot(size_t slot) {
+    EffectSlots::Lane* lanes[] = {
+        &slots_.active,     &slots_.level,       &slots_.amplitude,    &slots_.start_phase,
+        &slots_.duty,       &slots_.wave_saw,    &slots_.wave_square,  &slots_.wave_trapezoid,
+        &slots_.dead_low,   &slots_.dead_high,   &slots_.spring_neg,   &slots_.spring_pos,
+        &slots_.damper_neg, &slots_.damper_pos,  &slots_.friction_neg, &slots_.friction_pos,
+        &slots_.slope,      &slots_.sweep_span,
+    };
+    for (auto* lane : lanes) {
+        (*lane)[slot] = 0.0f;
+    }
+    slots_.period_s[slot] = 1.0f;
+    slots_.clip[slot] = kFullScaleForce;
+    loaded_[slot] = false;
+}
+
+bool EffectTable::Download(size_t slot, const uint8_t* data) {
+    const float active = slots_.active[slot];
+    ClearSlot(slot);
+    slots_.active[slot] = active;
+
+    switch (data[1]) {
+        case kConstant:
+            // Bytes 2-5 are the levels of forces 1-4, one per slot.
+            slots_.level[slot] = LevelForce(data[2 + slot]);
+            break;
+        case kVariable: {
+            // Forces 1/3 use L1, T1:S1 (byte 4) and D1 (byte 6 bit 0); forces 2/4 use L2,
+            // T2:S2 (byte 5) and D2 (bit 4). The level steps by S every T ms in direction
+            // D until the level byte runs out of range.
+            const bool second = (slot & 1) != 0;
+            const uint8_t level = data[second ? 3 : 2];
+            const uint8_t timing = data[second ? 5 : 4];
+            const bool down = data[6] & (second ? 0x10 : 0x01);
+            SetSweep(slot, level, down ? 0 : 255, timing & 0x0f, timing >> 4);
+            break;
+        }
+        case kRamp: {
+            // L1/L2 endpoints, T:S (byte 4) step, byte 5 bit 0 = direction: clear rises
+            // from the lower level to the higher, set falls from the higher to the lower.
+            const uint8_t high = std::max(data[2], data[3]);
+            const uint8_t low = std::min(data[2], data[3]);
+            const bool down = data[5] & 0x01;
+            SetSweep(slot, down ? high : low, down ? low : high, data[4] & 0x0f, data[4] >> 4);
+            break;
+        }
+        case kSawtoothUp:
+        case kSawtoothDown: {
+            // L1 max, L2 min, L0 start, high nibble of byte 5 = ms per step, byte 6 = step.
+            int high = std::max(data[2], data[3]);
+            int low = std::min(data[2], data[3]);
+            int span = std::max(high - low, 1);
+            float step_ms = static_cast<float>(std::max(data[5] >> 4, 1));
+            float steps = static_cast<float>(span) / static_cast<float>(std::max<int>(data[6], 1));
+            float hi_force = LevelForce(static_cast<uint8_t>(high));
+            float lo_force = LevelForce(static_cast<uint8_t>(low));
+            slots_.level[slot] = 0.5f * (hi_force + lo_force);
+            slots_.amplitude[slot] = 0.5f * (hi_force - lo_force);
+            slots_.period_s[slot] = PeriodSeconds(steps * step_ms);
+            float start = std::clamp(static_cast<float>(data[4] - low) / span, 0.0f, 1.0f);
+            bool up = data[1] == kSawtoothUp;
+            slots_.wave_saw[slot] = up ? 1.0f : -1.0f;
+            slots_.start_phase[slot] = up ? start : 1.0f - start;
+            break;
+        }
+        case kTrapezoid: {
+            // L1/L2 plateaus, T1/T2 hold times (ms), byte 6 = step per ms on the ramps.
+            float hi_force = LevelForce(data[2]);
+            float lo_force = LevelForce(data[3]);
+            float ramp_ms = static_cast<float>(std::abs(data[2] - data[3])) / std::max<int>(data[6], 1);
+            slots_.level[slot] = 0.5f * (hi_force + lo_force);
+            slots_.amplitude[slot] = 0.5f * (hi_force - lo_force);
+            slots_.period_s[slot] = PeriodSeconds(data[4] + data[5] + 2.0f * ramp_ms);
+            slots_.wave_trapezoid[slot] = 1.0f;
+            break;
+        }
+        case kRectangle: {
+            // L1/L2 levels, T1 high time, T2 low time (ms), byte 6 = start phase.
+            float hi_force = LevelForce(data[2]);
+            float lo_force = LevelForce(data[3]);
+            float total = static_cast<float>(data[4] + data[5]);
+            slots_.level[slot] = 0.5f * (hi_force + lo_force);
+            slots_.amplitude[slot] = 0.5f * (hi_force - lo_force);
+            slots_.period_s[slot] = PeriodSeconds(total);
+            slots_.duty[slot] = total > 0.0f ? data[4] / total : 0.5f;
+            slots_.start_phase[slot] = static_cast<float>(data[6]) / 256.0f;
+            slots_.wave_square[slot] = 1.0f;
+            break;
+        }
+        case kSquare: {
+            // A amplitude around zero, TL/TH low/high times (ms).
+            float total = static_cast<float>(data[3] + data[4]);
+            slots_.amplitude[slot] = static_cast<float>(data[2]) * 24.0f;
+            slots_.period_s[slot] = PeriodSeconds(total);
+            slots_.duty[slot] = total > 0.0f ? data[4] / total : 0.5f;
+            slots_.wave_square[slot] = 1.0f;
+            break;
+        }
+        case kSpring:
+        case kHighResSpring: {
+            if (data[1] == kSpring) {
+                slots_.dead_low[slot] = Position8(data[2]);
+                slots_.dead_high[slot] = Position8(data[3]);
+            } else {
+                slots_.dead_low[slot] = Position11((data[2] << 3) | ((data[5] >> 1) & 0x07));
+                slots_.dead_high[slot] = Position11((data[3] << 3) | ((data[5] >> 5) & 0x07));
+            }
+            if (slots_.dead_low[slot] > slots_.dead_high[slot]) {
+                std::swap(slots_.dead_low[slot], slots_.dead_high[slot]);
+            }
+            slots_.spring_neg[slot] = Coefficient((data[4] & 0x0f) / 15.0f, data[5] & 0x01);
+            slots_.spring_pos[slot] = Coefficient((data[4] >> 4) / 15.0f, data[5] & 0x10);
+            slots_.clip[slot] = ClipForce(data[6]);
+            break;
+        }
+        case kDamper:
+            slots_.damper_neg[slot] = Coefficient((data[2] & 0x0f) / 15.0f, data[3] & 0x01);
+            slots_.damper_pos[slot] = Coefficient((data[4] & 0x0f) / 15.0f, data[5] & 0x01);
+            break;
+        case kHighResDamper:
+            slots_.damper_neg[slot] = Coefficient(data[2] / 255.0f, data[3] & 0x01);
+            slots_.damper_pos[slot] = Coefficient(data[4] / 255.0f, data[5] & 0x01);
+            slots_.clip[slot] = ClipForce(data[6]);
+            break;
+        case kAutoCenterSpring:
+        case kHighResAutoCenterSpring: {
+            float scale = data[1] == kAutoCenterSpring ? 1.0f / 15.0f : 1.0f / 255.0f;
+            uint8_t mask = data[1] == kAutoCenterSpring ? 0x0f : 0xff;
+            slots_.spring_neg[slot] = (data[2] & mask) * scale;
+            slots_.spring_pos[slot] = (data[3] & mask) * scale;
+            slots_.clip[slot] = ClipForce(data[4]);
+            break;
+        }
+        case kFriction:
+            slots_.friction_neg[slot] = Coefficient(data[2] / 255.0f, data[5] & 0x01);
+            slots_.friction_pos[slot] = Coefficient(data[3] / 255.0f, data[5] & 0x10);
+            slots_.clip[slot] = ClipForce(data[4]);
+            break;
+        default:
+            slots_.active[slot] = 0.0f;
+            return false;
+    }
+    loaded_[slot] = true;
+    return true;
+}
+
+void EffectTable::SetSweep(size_t slot, uint8_t from, uint8_t to, int step, int step_ms) {
+    const float start = LevelForce(from);
+    const float end = LevelForce(to);
+    slots_.level[slot] = start;
+    if (step <= 0 || from == to) {
+        return;
+    }
+    const float rate = static_cast<float>(step) * 48.0f / (static_cast<float>(std::max(step_ms, 1)) * 0.001f);
+    slots_.slope[slot] = end > start ? rate : -rate;
+    slots_.sweep_span[slot] = std::fabs(end - start);
+}
+
+bool EffectTable::HasPeriodic() const {
+    for (size_t slot = 0; slot < kEffectSlots; ++slot) {
+        if (slots_.active[slot] != 0.0f && slots_.amplitude[slot] != 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EffectTable::ApplyCommand(const uint8_t* data, size_t size) {
+    if (size != kPacketSize || data[0] == 0xf8) {  // 0xf8: extended (range, LEDs, mode)
+        return false;
+    }
+
+    const unsigned mask = data[0] >> 4;
+    const unsigned op = data[0] & 0x0f;
+    bool changed = false;
+
+    switch (op) {
+        case 0x0:  // Download
+        case 0xc:  // Refresh: same layout, keeps the slot playing
+        case 0x1:  // Download and play
+            for (size_t slot = 0; slot < kEffectSlots; ++slot) {
+                if (!(mask & (1u << slot))) {
+                    continue;
+                }
+                changed = true;
+                if (Download(slot, data) && op == 0x1) {
+                    slots_.active[slot] = 1.0f;
+                    ++slots_.start_seq[slot];
+                }
+            }
+            break;
+        case 0x2:  // Play
+            for (size_t slot = 0; slot < kEffectSlots; ++slot) {
+                if ((mask & (1u << slot)) && loaded_[slot]) {
+                    slots_.active[slot] = 1.0f;
+                    ++slots_.start_seq[slot];
+                    changed = true;
+                }
+            }
+            break;
+        case 0x3:  // Stop
+            for (size_t slot = 0; slot < kEffectSlots; ++slot) {
+                if (mask & (1u << slot)) {
+                    slots_.active[slot] = 0.0f;
+                    changed = true;
+                }
+            }
+            break;
+        case 0x4:  // Default spring on
+            if (slots_.autocenter != default_autocenter_) {
+                slots_.autocenter = default_autocenter_;
+                changed = true;
+            }
+            break;
+        case 0x5:  // Default spring off
+            if (slots_.autocenter != 0.0f) {
+                slots_.autocenter = 0.0f;
+                changed = true;
+            }
+            break;
+        case 0xe:  // Configure default spring (0xfe 0x0d strength ...)
+            if (data[1] == 0x0d) {
+                float strength = static_cast<float>(data[2]) * 16.0f;
+                if (strength > 0.0f) {
+                    default_autocenter_ = strength;
+                }
+                if (slots_.autocenter != strength) {
+                    slots_.autocenter = strength;
+                    changed = true;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (changed) {
+        ++generation_;
+    }
+    return changed;
+}
+
+EffectKernel::EffectKernel() {
+    Reset();
+}
+
+void EffectKernel::Reset() {
+    phase_.fill(0.0f);
+    elapsed_s_.fill(0.0f);
+    seen_start_seq_.fill(0);
+}
+
+bool EffectKernel::Sweeping(const EffectSlots& slots) const {
+    for (size_t i = 0; i < kEffectSlots; ++i) {
+        if (slots.active[i] != 0.0f && std::fabs(slots.slope[i] * elapsed_s_[i]) < slots.sweep_span[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+EffectForces EffectKernel::Evaluate(const EffectSlots& slots, float position, float velocity, float dt) {
+    for (size_t i = 0; i < kEffectSlots; ++i) {
+        if (seen_start_seq_[i] != slots.start_seq[i]) {
+            seen_start_seq_[i] = slots.start_seq[i];
+            phase_[i] = slots.start_phase[i];
+            elapsed_s_[i] = 0.0f;
+        }
+    }
+
+    // Every slot evaluates every term; parameters of other effect types are zero, so
+    // the loop has no per-type branches and the compiler can keep it in vector lanes.
+    const float moving_positive = velocity > 0.0f ? 1.0f : 0.0f;
+    const float friction_shape = velocity / (std::fabs(velocity) + kFrictionKnee);
+    float open_loop = 0.0f;
+    float conditional = 0.0f;
+    for (size_t i = 0; i < kEffectSlots; ++i) {
+        float phase = phase_[i] + dt / slots.period_s[i];
+        phase -= std::floor(phase);
+        phase_[i] = phase;
+
+        float saw = 2.0f * phase - 1.0f;
+        float square = phase < slots.duty[i] ? 1.0f : -1.0f;
+        float triangle = 1.0f - 4.0f * std::fabs(phase - 0.5f);
+        float trapezoid = std::clamp(2.0f * triangle, -1.0f, 1.0f);
+        float wave = slots.wave_saw[i] * saw + slots.wave_square[i] * square +
+                     slots.wave_trapezoid[i] * trapezoid;
+        // Sweeps stop at their end level; capping the clock keeps it from losing precision.
+        elapsed_s_[i] = std::min(elapsed_s_[i] + dt, 3600.0f);
+        float sweep = std::clamp(slots.slope[i] * elapsed_s_[i], -slots.sweep_span[i], slots.sweep_span[i]);
+        open_loop += slots.active[i] * (slots.level[i] + sweep + slots.amplitude[i] * wave);
+
+        float over = std::max(position - slots.dead_high[i], 0.0f);
+        float under = std::min(position - slots.dead_low[i], 0.0f);
+        float spring = -(slots.spring_pos[i] * over + slots.spring_neg[i] * under) * kSpringForce;
+        float damper_k = slots.damper_neg[i] + (slots.damper_pos[i] - slots.damper_neg[i]) * moving_positive;
+        float damper = -damper_k * velocity * kDamperForce;
+        float friction_k =
+            slots.friction_neg[i] + (slots.friction_pos[i] - slots.friction_neg[i]) * moving_positive;
+        float friction = -friction_k * friction_shape * kFrictionForce;
+        float condition = std::clamp(spring + damper + friction, -slots.clip[i], slots.clip[i]);
+        conditional += slots.active[i] * condition;
+    }
+
+    conditional -= position * slots.autocenter;
+    return {open_loop, conditional};
+}
+
+}  // namespace ffb
@@ -0,0 +1,98 @@
+#ifndef FFB_EFFECT_ENGINE_H
+#define FFB_EFFECT_ENGINE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ffb {
+
+// The G29 classic protocol addresses four effect slots; the high nibble of byte 0
+// is the slot mask (0x10 = slot 0 ... 0x80 = slot 3), the low nibble the command.
+constexpr size_t kEffectSlots = 4;
+
+// Raw-force units at full deflection of an 8-bit level byte (127 * 48). Constant
+// forces keep the scale the single-slot parser used, so ShapeFFBTorque is unchanged.
+constexpr float kFullScaleForce = 6096.0f;
+
+// Parameters of every slot, stored structure-of-arrays so EffectKernel can evaluate
+// all slots in one straight-line loop. Unused terms of a slot stay zero.
+struct EffectSlots {
+    using Lane = std::array<float, kEffectSlots>;
+
+    Lane active{};          // 1 while playing, 0 otherwise
+    Lane level{};           // constant term / periodic midpoint (raw-force units)
+    Lane amplitude{};       // periodic half swing (raw-force units)
+    Lane period_s{};        // periodic period, seconds (never zero)
+    Lane start_phase{};     // phase applied when the slot (re)starts, [0, 1)
+    Lane duty{};            // rectangle high fraction, [0, 1]
+    Lane wave_saw{};        // +1 sawtooth up, -1 sawtooth down
+    Lane wave_square{};     // weight of rectangle/square shape
+    Lane wave_trapezoid{};  // weight of trapezoid shape
+    Lane dead_low{};        // spring deadband, normalized position [-1, 1]
+    Lane dead_high{};
+    Lane spring_neg{};      // spring coefficient left of the deadband
+    Lane spring_pos{};      // spring coefficient right of the deadband
+    Lane damper_neg{};      // damper coefficient for negative velocity
+    Lane damper_pos{};
+    Lane friction_neg{};
+    Lane friction_pos{};
+    Lane clip{};            // condition saturation (raw-force units)
+    Lane slope{};           // variable/ramp level change, raw-force units per second
+    Lane sweep_span{};      // how far the level may move from its start (raw-force units)
+    std::array<uint32_t, kEffectSlots> start_seq{};  // bumped on every play
+
+    float autocenter = 0.0f;  // default spring strength (raw-force units at full lock)
+};
+
+// Host-facing side: decodes OUTPUT packets into EffectSlots. Not thread-safe; the
+// owner serializes access (WheelDevice holds state_mutex).
+class EffectTable {
+public:
+    EffectTable();
+
+    // Applies one 7-byte command. Returns true if any effect parameter changed.
+    bool ApplyCommand(const uint8_t* data, size_t size);
+    void Reset();
+
+    const EffectSlots& slots() const { return slots_; }
+    // True while a playing slot has a periodic term, so forces change with time alone.
+    bool HasPeriodic() const;
+    uint64_t generation() const { return generation_; }
+
+private:
+    bool Download(size_t slot, const uint8_t* data);
+    void SetSweep(size_t slot, uint8_t from, uint8_t to, int step, int step_ms);
+    void ClearSlot(size_t slot);
+
+    EffectSlots slots_;
+    std::array<bool, kEffectSlots> loaded_{};
+    float default_autocenter_;
+    uint64_t generation_;
+};
+
+struct EffectForces {
+    float open_loop = 0.0f;    // constant + periodic torque, shaped by the caller
+    float conditional = 0.0f;  // spring/damper/friction + autocenter, already in output units
+};
+
+// Tick-side evaluator; owns the running phase of each periodic slot.
+class EffectKernel {
+public:
+    EffectKernel();
+
+    // position: steering normalized to [-1, 1]; velocity: position units per second.
+    EffectForces Evaluate(const EffectSlots& slots, float position, float velocity, float dt);
+    // True while a playing variable/ramp slot has not reached its end level yet.
+    bool Sweeping(const EffectSlots& slots) const;
+    void Reset();
+
+private:
+    EffectSlots::Lane phase_;
+    EffectSlots::Lane elapsed_s_;  // since the slot (re)started; drives level sweeps
+    std::array<uint32_t, kEffectSlots> seen_start_seq_;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_EFFECT_ENGINE_H
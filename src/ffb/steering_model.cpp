@@ -0,0 +1,57 @@
+#include "steering_model.h"
+
+namespace ffb {
+
+namespace {
+
+constexpr float kSteeringLimit = 32767.0f;
+
+}  // namespace
+
+int MinStableStepHz(const PhysicsParams& params) {
+    const float spring = std::max(params.stiffness, 0.0f) + std::max(params.end_stop_stiffness, 0.0f);
+    const float omega = std::sqrt(spring / std::max(params.inertia, 0.01f));
+    return static_cast<int>(std::floor(omega)) + 1;
+}
+
+void SteeringModel::SetParams(const PhysicsParams& params) {
+    params_ = params;
+    params_.inertia = std::max(params_.inertia, 0.01f);
+    params_.step_hz = std::max(params_.step_hz, MinStableStepHz(params_));
+    step_ = 1.0f / static_cast<float>(params_.step_hz);
+    inv_inertia_ = 1.0f / params_.inertia;
+    filter_alpha_ = 1.0f - std::exp(-step_ * std::max(params_.force_filter_hz, 0.0f));
+}
+
+void SteeringModel::Step(const EffectForces& forces, float gain) {
+    open_loop_ = forces.open_loop;
+    filtered_force_ += (forces.open_loop - filtered_force_) * filter_alpha_;
+    float target = (filtered_force_ + forces.conditional) * gain;
+    target = std::clamp(target, -params_.end_stop, params_.end_stop);
+    target_ = target;
+
+    float force = params_.stiffness * (target - offset_);
+    float excess = std::fabs(offset_) - params_.end_stop;
+    if (excess > 0.0f) {
+        force -= std::copysign(excess * params_.end_stop_stiffness, offset_);
+    }
+
+    // Explicit spring/end-stop, implicit viscous damping, then Coulomb friction that
+    // can only bring the rim to rest, never reverse it.
+    float velocity = (velocity_ + force * inv_inertia_ * step_) / (1.0f + params_.damping * inv_inertia_ * step_);
+    float friction_dv = params_.friction * inv_inertia_ * step_;
+    if (std::fabs(velocity) <= friction_dv) {
+        velocity = 0.0f;
+    } else {
+        velocity -= std::copysign(friction_dv, velocity);
+    }
+
+    velocity_ = velocity;
+    offset_ += velocity_ * step_;
+    if (std::fabs(offset_) > kSteeringLimit) {
+        offset_ = std::copysign(kSteeringLimit, offset_);
+        velocity_ = 0.0f;
+    }
+}
+
+}  // namespace ffb
@@ -0,0 +1,96 @@
+#ifndef FFB_STEERING_MODEL_H
+#define FFB_STEERING_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "effect_engine.h"
+
+namespace ffb {
+
+// Rigid-body parameters for the FFB steering offset. Forces are expressed per unit
+// inertia in steering counts/s^2, so the defaults reproduce the former spring-damper
+// (stiffness 120, damping 8, offset limit 22000) with no Coulomb friction.
+struct PhysicsParams {
+    float inertia = 1.0f;              // relative rim inertia; higher responds slower
+    float stiffness = 120.0f;          // pull of the hand toward the commanded offset (1/s^2)
+    float damping = 8.0f;              // viscous damping (1/s)
+    float friction = 0.0f;             // Coulomb friction (counts/s^2 at inertia 1)
+    float end_stop = 22000.0f;         // |offset| where the end-stop spring engages (counts)
+    float end_stop_stiffness = 4000.0f;  // end-stop spring rate (1/s^2)
+    float force_filter_hz = 38.0f;     // low-pass on shaped constant/periodic torque
+    int step_hz = 2000;                // fixed integration rate, independent of the wake rate
+};
+
+// Lowest step rate at which the stiffest spring the rim can feel (hand plus end stop)
+// keeps omega * step < 1. The semi-implicit step goes unstable at 2; past that the
+// rim chatters against the steering clamp at the end stop.
+int MinStableStepHz(const PhysicsParams& params);
+
+// Fixed-step, semi-implicit integration of the FFB offset. Advance() consumes wall time
+// in whole steps and carries the remainder, so the trajectory is the same whether the
+// FFB thread wakes at 250 Hz or 2 kHz; only how often it is sampled changes.
+class SteeringModel {
+public:
+    // Caps the catch-up after a stalled wake so one tick never runs unbounded steps.
+    static constexpr float kMaxElapsed = 0.05f;
+
+    SteeringModel() { SetParams(PhysicsParams{}); }
+
+    void SetParams(const PhysicsParams& params);
+    const PhysicsParams& params() const { return params_; }
+
+    // Adopts externally reset state (e.g. WheelDevice zeroing the offset on neutral).
+    void SetState(float offset, float velocity) {
+        offset_ = offset;
+        velocity_ = velocity;
+    }
+    void ResetClock() { accumulator_ = 0.0f; }
+
+    float offset() const { return offset_; }
+    float velocity() const { return velocity_; }
+    // Offset the last step pulled toward: shaped forces times gain, end-stop clamped.
+    float target() const { return target_; }
+    float step_seconds() const { return step_; }
+
+    // True when the last step left the rim at rest on its target with the force
+    // filter converged, so further steps under the same forces change nothing
+    // visible. `tolerance` is in steering counts (and counts/s for velocity).
+    bool Settled(float tolerance) const {
+        return std::fabs(velocity_) <= tolerance && std::fabs(target_ - offset_) <= tolerance &&
+               std::fabs(open_loop_ - filtered_force_) <= tolerance;
+    }
+
+    // Runs as many fixed steps as `elapsed` covers. `forces(offset, velocity, step)`
+    // returns the effect forces for the current state (open loop already shaped).
+    // Returns the number of steps taken.
+    template <typename ForceFn>
+    int Advance(float elapsed, float gain, ForceFn&& forces) {
+        accumulator_ += std::clamp(elapsed, 0.0f, kMaxElapsed);
+        int steps = 0;
+        while (accumulator_ >= step_) {
+            accumulator_ -= step_;
+            Step(forces(offset_, velocity_, step_), gain);
+            ++steps;
+        }
+        return steps;
+    }
+
+private:
+    void Step(const EffectForces& forces, float gain);
+
+    PhysicsParams params_;
+    float step_ = 0.0005f;
+    float inv_inertia_ = 1.0f;
+    float filter_alpha_ = 0.0f;
+    float accumulator_ = 0.0f;
+    float filtered_force_ = 0.0f;
+    float open_loop_ = 0.0f;
+    float target_ = 0.0f;
+    float offset_ = 0.0f;
+    float velocity_ = 0.0f;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_STEERING_MODEL_H
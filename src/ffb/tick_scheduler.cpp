@@ -0,0 +1,85 @@
+#include "tick_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "../metrics/metrics.h"
+
+namespace ffb {
+
+TickScheduler::TickScheduler() : running_(false), wake_(false), parked_(false), tick_hz_(1000) {}
+
+TickScheduler::~TickScheduler() {
+    Stop();
+}
+
+size_t TickScheduler::Add(StepFn step) {
+    slots_.emplace_back();
+    slots_.back().step = std::move(step);
+    return slots_.size() - 1;
+}
+
+void TickScheduler::SetTickRate(int hz) {
+    tick_hz_.store(std::clamp(hz, 100, 4000), std::memory_order_relaxed);
+}
+
+void TickScheduler::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&TickScheduler::Loop, this);
+}
+
+void TickScheduler::Stop() {
+    running_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TickScheduler::Wake(size_t slot) {
+    slots_[slot].wake.store(true);
+    wake_.store(true);
+    // Same handshake as WheelDevice::WakeFFB: a parked thread is only notified after
+    // it has released the mutex inside wait(), so the notify cannot be lost.
+    if (parked_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_all();
+}
+
+void TickScheduler::Loop() {
+    static metrics::Counter& wakeups = metrics::ThreadWakeups("ffb");
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto woken = [this]() { return wake_.load() || !running_.load(); };
+            const bool active = std::any_of(slots_.begin(), slots_.end(), [](const Slot& s) { return s.active; });
+            if (!active) {
+                parked_.store(true);
+                cv_.wait(lock, woken);
+                parked_.store(false);
+            } else {
+                const int tick_hz = tick_hz_.load(std::memory_order_relaxed);
+                cv_.wait_for(lock, std::chrono::microseconds(1000000 / tick_hz), woken);
+            }
+            if (!running_.load()) {
+                break;
+            }
+            wake_.store(false, std::memory_order_relaxed);
+        }
+        wakeups.Increment();
+        for (Slot& slot : slots_) {
+            const bool woken = slot.wake.exchange(false);
+            if (slot.active || woken) {
+                slot.active = slot.step();
+            }
+        }
+    }
+}
+
+}  // namespace ffb
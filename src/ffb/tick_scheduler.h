@@ -0,0 +1,59 @@
+#ifndef FFB_TICK_SCHEDULER_H
+#define FFB_TICK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace ffb {
+
+// One FFB thread for several wheels. Each wheel registers its step function (what
+// FFBUpdateThread runs per wake) and gets a slot. Every pass steps each slot that was
+// woken or whose last step reported it still active; the thread ticks at the shared
+// rate while any slot is active and parks otherwise, as a per-wheel thread does.
+class TickScheduler {
+public:
+    using StepFn = std::function<bool()>;  // false once settled or disabled
+
+    TickScheduler();
+    ~TickScheduler();
+
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    // Call before Start() and before anything can call Wake(): adding a slot is not
+    // synchronized with Wake(). Returns the slot to pass to Wake().
+    size_t Add(StepFn step);
+    void SetTickRate(int hz);
+    void Start();
+    void Stop();
+
+    // Steps `slot` on the next pass. Safe from any thread, also before Start().
+    void Wake(size_t slot);
+
+private:
+    struct Slot {
+        StepFn step;
+        std::atomic<bool> wake{false};
+        bool active = false;  // scheduler thread only
+    };
+
+    void Loop();
+
+    std::deque<Slot> slots_;  // stable addresses; never resized once any slot can be woken
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> wake_;    // some slot was woken since the last pass
+    std::atomic<bool> parked_;  // thread is in an untimed wait
+    std::atomic<int> tick_hz_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_TICK_SCHEDULER_H
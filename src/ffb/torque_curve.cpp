@@ -0,0 +1,148 @@
+#include "torque_curve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace ffb {
+
+namespace {
+
+bool ValidatePoints(std::vector<CurvePoint>& points, std::string& error) {
+    if (points.empty()) {
+        error = "no control points";
+        return false;
+    }
+    if (points.front().force < 0.0f) {
+        error = "forces must be non-negative";
+        return false;
+    }
+    if (points.front().force > 0.0f) {
+        points.insert(points.begin(), CurvePoint{0.0f, 0.0f});
+    }
+    if (points.size() < 2) {
+        error = "need at least one point beyond 0";
+        return false;
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!std::isfinite(points[i].force) || !std::isfinite(points[i].output) || points[i].output < 0.0f) {
+            error = "outputs must be finite and non-negative";
+            return false;
+        }
+        if (i > 0 && points[i].force <= points[i - 1].force) {
+            error = "forces must be strictly increasing";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+const std::vector<CurvePoint>& DefaultCurvePoints() {
+    static const std::vector<CurvePoint> points = {
+        {0.0f, 0.0f},        {40.0f, 20.0f},      {80.0f, 60.0f},      {500.0f, 376.0f},
+        {1000.0f, 760.0f},   {2000.0f, 1586.0f},  {3000.0f, 2547.0f},  {4000.0f, 3714.0f},
+        {4500.0f, 3881.0f},  {5000.0f, 4875.0f},  {6000.0f, 7200.0f},  {7000.0f, 9975.0f},
+        {8000.0f, 13200.0f}, {9000.0f, 16875.0f}, {10000.0f, 21000.0f}, {12000.0f, 30600.0f},
+        {14000.0f, 42000.0f},
+    };
+    return points;
+}
+
+bool ParseCurvePoints(const std::string& text, std::vector<CurvePoint>& points, std::string& error) {
+    std::vector<CurvePoint> parsed;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty()) {
+            continue;
+        }
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            error = "expected force:output, got '" + item + "'";
+            return false;
+        }
+        char* end = nullptr;
+        std::string force_text = item.substr(0, colon);
+        std::string output_text = item.substr(colon + 1);
+        float force = std::strtof(force_text.c_str(), &end);
+        if (end == force_text.c_str() || *end != '\0') {
+            error = "bad force in '" + item + "'";
+            return false;
+        }
+        float output = std::strtof(output_text.c_str(), &end);
+        if (end == output_text.c_str() || *end != '\0') {
+            error = "bad output in '" + item + "'";
+            return false;
+        }
+        parsed.push_back({force, output});
+    }
+    if (!ValidatePoints(parsed, error)) {
+        return false;
+    }
+    points = std::move(parsed);
+    return true;
+}
+
+std::string FormatCurvePoints(const std::vector<CurvePoint>& points) {
+    std::string text;
+    for (const auto& point : points) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%s%g:%g", text.empty() ? "" : ", ", point.force, point.output);
+        text += buf;
+    }
+    return text;
+}
+
+TorqueCurve::TorqueCurve() {
+    Compile(DefaultCurvePoints());
+}
+
+TorqueCurve::TorqueCurve(const std::vector<CurvePoint>& points) {
+    std::vector<CurvePoint> checked = points;
+    std::string error;
+    Compile(ValidatePoints(checked, error) ? checked : DefaultCurvePoints());
+}
+
+void TorqueCurve::Compile(const std::vector<CurvePoint>& points) {
+    points_ = points;
+    max_force_ = points_.back().force;
+    tail_gain_ = points_.back().output / max_force_;
+    const float step = max_force_ / static_cast<float>(kTableSize - 1);
+    inv_step_ = 1.0f / step;
+    for (size_t i = 0; i < kTableSize; ++i) {
+        table_[i] = Evaluate(static_cast<float>(i) * step);
+    }
+    table_[kTableSize - 1] = points_.back().output;
+}
+
+float TorqueCurve::Evaluate(float magnitude) const {
+    if (magnitude >= max_force_) {
+        return magnitude * tail_gain_;
+    }
+    auto upper = std::upper_bound(points_.begin(), points_.end(), magnitude,
+                                  [](float value, const CurvePoint& point) { return value < point.force; });
+    const CurvePoint& hi = *upper;
+    const CurvePoint& lo = *(upper - 1);
+    float t = (magnitude - lo.force) / (hi.force - lo.force);
+    return lo.output + (hi.output - lo.output) * t;
+}
+
+float TorqueCurve::Apply(float raw_force) const {
+    float magnitude = std::fabs(raw_force);
+    float position = magnitude * inv_step_;
+    if (position >= static_cast<float>(kTableSize - 1)) {
+        return raw_force * tail_gain_;
+    }
+    size_t index = static_cast<size_t>(position);
+    float frac = position - static_cast<float>(index);
+    float shaped = table_[index] + (table_[index + 1] - table_[index]) * frac;
+    return std::copysign(shaped, raw_force);
+}
+
+}  // namespace ffb
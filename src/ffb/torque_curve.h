@@ -0,0 +1,55 @@
+#ifndef FFB_TORQUE_CURVE_H
+#define FFB_TORQUE_CURVE_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ffb {
+
+// One control point of the |force| -> |torque| shaping curve, both in raw-force units.
+struct CurvePoint {
+    float force;
+    float output;
+};
+
+// Points that reproduce the former hardcoded ShapeFFBTorque knees (80, 4000, 14000,
+// boost 3.0); the old curve's small steps at 80 and 4000 become straight segments.
+const std::vector<CurvePoint>& DefaultCurvePoints();
+
+// Parses "force:output, force:output, ...". Forces must be strictly increasing and
+// outputs non-negative; a missing 0:0 origin is added. On failure `error` explains why.
+bool ParseCurvePoints(const std::string& text, std::vector<CurvePoint>& points, std::string& error);
+std::string FormatCurvePoints(const std::vector<CurvePoint>& points);
+
+// Piecewise-linear curve compiled into a fixed table indexed by |force|, so Apply costs
+// one multiply, one table interpolation, and a sign copy regardless of point count.
+// Beyond the last point the output keeps that point's output/force ratio.
+class TorqueCurve {
+public:
+    static constexpr size_t kTableSize = 1024;
+
+    TorqueCurve();
+    // Expects points accepted by ParseCurvePoints; anything else falls back to defaults.
+    explicit TorqueCurve(const std::vector<CurvePoint>& points);
+
+    float Apply(float raw_force) const;
+    // Direct evaluation of the control points, used to build the table and by tools.
+    float Evaluate(float magnitude) const;
+
+    const std::vector<CurvePoint>& points() const { return points_; }
+
+private:
+    void Compile(const std::vector<CurvePoint>& points);
+
+    std::vector<CurvePoint> points_;
+    std::array<float, kTableSize> table_;
+    float max_force_;
+    float inv_step_;
+    float tail_gain_;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_TORQUE_CURVE_H
@@ -0,0 +1,89 @@
+#include "trace.h"
+
+#include <cinttypes>
+
+namespace ffb {
+
+TraceWriter::TraceWriter() : file_(nullptr), base_ns_(-1) {}
+
+TraceWriter::~TraceWriter() {
+    Close();
+}
+
+bool TraceWriter::Open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        std::fclose(file_);
+    }
+    file_ = std::fopen(path.c_str(), "w");
+    base_ns_ = -1;
+    if (!file_) {
+        return false;
+    }
+    std::fputs("# wheel-emulator FFB trace: <microseconds> <7 hex bytes>\n", file_);
+    return true;
+}
+
+void TraceWriter::Write(int64_t now_ns, const CommandPacket& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;
+    }
+    if (base_ns_ < 0) {
+        base_ns_ = now_ns;
+    }
+    std::fprintf(file_, "%" PRId64 " %02x %02x %02x %02x %02x %02x %02x\n", (now_ns - base_ns_) / 1000,
+                 packet[0], packet[1], packet[2], packet[3], packet[4], packet[5], packet[6]);
+}
+
+void TraceWriter::Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+TraceReader::TraceReader() : file_(nullptr), skipped_(0) {}
+
+TraceReader::~TraceReader() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool TraceReader::Open(const std::string& path) {
+    if (file_) {
+        std::fclose(file_);
+    }
+    file_ = std::fopen(path.c_str(), "r");
+    skipped_ = 0;
+    return file_ != nullptr;
+}
+
+bool TraceReader::Next(TraceRecord& record) {
+    if (!file_) {
+        return false;
+    }
+    char line[128];
+    while (std::fgets(line, sizeof(line), file_)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        int64_t micros = 0;
+        unsigned bytes[7];
+        if (std::sscanf(line, "%" SCNd64 " %x %x %x %x %x %x %x", &micros, &bytes[0], &bytes[1], &bytes[2],
+                        &bytes[3], &bytes[4], &bytes[5], &bytes[6]) != 8) {
+            ++skipped_;
+            continue;
+        }
+        record.time_ns = micros * 1000;
+        for (size_t i = 0; i < record.packet.size(); ++i) {
+            record.packet[i] = static_cast<uint8_t>(bytes[i]);
+        }
+        return true;
+    }
+    return false;
+}
+
+}  // namespace ffb
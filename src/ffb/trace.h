@@ -0,0 +1,59 @@
+#ifndef FFB_TRACE_H
+#define FFB_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include "command_queue.h"
+
+namespace ffb {
+
+// One OUTPUT packet and its arrival time relative to the first recorded packet.
+struct TraceRecord {
+    int64_t time_ns = 0;
+    CommandPacket packet{};
+};
+
+// Text trace, one packet per line: "<microseconds> b0 b1 b2 b3 b4 b5 b6" (hex bytes).
+// Lines starting with '#' are comments.
+class TraceWriter {
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool Open(const std::string& path);
+    void Write(int64_t now_ns, const CommandPacket& packet);
+    void Close();
+
+private:
+    std::mutex mutex_;
+    FILE* file_;
+    int64_t base_ns_;
+};
+
+class TraceReader {
+public:
+    TraceReader();
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool Open(const std::string& path);
+    // Returns false at end of file; malformed lines are skipped and counted.
+    bool Next(TraceRecord& record);
+    size_t skipped() const { return skipped_; }
+
+private:
+    FILE* file_;
+    size_t skipped_;
+};
+
+}  // namespace ffb
+
+#endif  // FFB_TRACE_H
@@ -0,0 +1,79 @@
+#ifndef HID_G29_PROFILE_H
+#define HID_G29_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "report_layout.h"
+
+// Logitech G29 as the host sees it: one 13-byte IN report (four 16-bit axes, an 8-way
+// hat, 26 buttons) and a 7-byte vendor OUTPUT report that carries FFB commands. The
+// items and their order reproduce the real wheel's descriptor byte for byte.
+namespace hid {
+
+enum G29Usage : uint8_t {
+    kGenericDesktopPage = 0x01,
+    kButtonPage = 0x09,
+    kPointerUsage = 0x01,
+    kMouseUsage = 0x02,
+    kJoystickUsage = 0x04,
+    kXUsage = 0x30,
+    kYUsage = 0x31,
+    kZUsage = 0x32,
+    kRzUsage = 0x35,
+    kHatSwitchUsage = 0x39,
+};
+
+// Unsigned, released pedals read 65535.
+struct G29Axes : Field<16, 4> {
+    static constexpr size_t kSteering = 0;  // X, 32768 = center
+    static constexpr size_t kClutch = 1;    // Y
+    static constexpr size_t kThrottle = 2;  // Z
+    static constexpr size_t kBrake = 3;     // Rz
+
+    static constexpr auto Descriptor() {
+        return Item<kUsage, kPointerUsage>() + Item<kCollection, kPhysical>() +
+               UsageList<kXUsage, kYUsage, kZUsage, kRzUsage>() + LogicalRange<0, 65535>() +
+               PhysicalRange<0, 65535>() + InputItem<G29Axes, kData | kVariable>() + Item<kEndCollection>();
+    }
+};
+
+// 0 = up, clockwise in 45 degree steps; anything past 7 is the null state.
+struct G29Hat : Field<4, 1> {
+    static constexpr uint32_t kCentered = 0x0F;
+
+    static constexpr auto Descriptor() {
+        return Item<kUsage, kHatSwitchUsage>() + LogicalRange<0, 7>() + PhysicalRange<0, 315>() +
+               Item<kUnit, 0x14>() + InputItem<G29Hat, kData | kVariable | kNullState>();
+    }
+};
+
+struct G29Buttons : Field<1, 26> {
+    static constexpr auto Descriptor() {
+        return Item<kUsagePage, kButtonPage>() + Item<kUsageMinimum, 1>() + Item<kUsageMaximum, kCount>() +
+               LogicalRange<0, 1>() + InputItem<G29Buttons, kData | kVariable>();
+    }
+};
+
+using G29Report = InputReport<G29Axes, G29Hat, Padding<4>, G29Buttons, Padding<6>>;
+using WheelReport = G29Report::Buffer;
+
+constexpr size_t kG29OutputReportSize = 7;
+
+constexpr auto G29ReportDescriptor() {
+    return Item<kUsagePage, kGenericDesktopPage>() + Item<kUsage, kJoystickUsage>() +
+           Item<kCollection, kApplication>() + Item<kCollection, kLogical>() + G29Report::Descriptor() +
+           Item<kEndCollection>() +
+           Item<kCollection, kLogical>() + Item<kUsage, kMouseUsage>() + LogicalRange<0, 255>() +
+           Item<kReportCount, kG29OutputReportSize>() + Item<kReportSize, 8>() + Item<kOutput, kData | kVariable>() +
+           Item<kEndCollection>() +
+           Item<kEndCollection>();
+}
+
+static_assert(G29Report::kSize == 13, "G29 IN report is 13 bytes");
+static_assert(G29Report::BitOffset<G29Buttons>() == 72, "G29 buttons start at byte 9");
+static_assert(decltype(G29ReportDescriptor())::size() == 106, "G29 report descriptor changed size");
+
+}  // namespace hid
+
+#endif  // HID_G29_PROFILE_H
@@ -1,5 +1,6 @@
 #include "hid_device.h"
 
+#include <algorithm>
 #include <array>
 #include <cerrno>
 #include <chrono>
@@ -12,43 +13,54 @@
 #include <fstream>
 #include <poll.h>
 #include <string>
+#include <sys/eventfd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "../logging/logger.h"
+#include "../metrics/metrics.h"
 
 namespace hid {
 namespace {
 constexpr uint16_t kVendorId = 0x046d;
 constexpr uint16_t kProductId = 0xc24f;
 constexpr uint16_t kVersion = 0x0111;
-constexpr size_t kReportLength = 13;
-constexpr const char* kGadgetName = "g29wheel";
-constexpr const char* kHidFunction = "hid.usb0";
-constexpr const char* kHidDevicePath = "/dev/hidg0";
+constexpr const char* kGadgetRoot = "/sys/kernel/config/usb_gadget/";
+constexpr const char* kFallbackDevicePath = "/dev/hidg0";
 constexpr int kDefaultPollTimeoutMs = 50;
-
-constexpr uint8_t kG29HidDescriptor[] = {
-    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0xA1, 0x02, 0x09, 0x01, 0xA1, 0x00,
-    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x15, 0x00,
-    0x27, 0xFF, 0xFF, 0x00, 0x00, 0x35, 0x00,
-    0x47, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10,
-    0x95, 0x04, 0x81, 0x02, 0xC0,
-    0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46, 0x3B, 0x01,
-    0x65, 0x14, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
-    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
-    0x05, 0x09, 0x19, 0x01, 0x29, 0x1A, 0x15, 0x00, 0x25, 0x01,
-    0x75, 0x01, 0x95, 0x1A, 0x81, 0x02,
-    0x75, 0x06, 0x95, 0x01, 0x81, 0x03,
-    0xC0,
-    0xA1, 0x02, 0x09, 0x02, 0x15, 0x00, 0x26, 0xFF, 0x00,
-    0x95, 0x07, 0x75, 0x08, 0x91, 0x02,
-    0xC0,
-    0xC0
+constexpr unsigned kWriteRingEntries = 4;
+constexpr uint64_t kWriteTag = 1;
+
+constexpr auto kReportDescriptor = G29ReportDescriptor();
+
+struct HidMetrics {
+    metrics::Counter& binds;
+    metrics::Counter& unbinds;
+    metrics::Counter& endpoint_opens;
+    metrics::Counter& endpoint_resets;
+    metrics::Counter& write_eagain;
+    metrics::Counter& write_errors;
+    metrics::Counter& udc_state_changes;
 };
 
+HidMetrics& Metrics() {
+    auto& registry = metrics::DefaultRegistry();
+    static HidMetrics instance{
+        registry.GetCounter("wheel_hid_udc_binds_total", "Successful gadget UDC binds"),
+        registry.GetCounter("wheel_hid_udc_unbinds_total", "Successful gadget UDC unbinds"),
+        registry.GetCounter("wheel_hid_endpoint_opens_total", "Opens of the hidg endpoint"),
+        registry.GetCounter("wheel_hid_endpoint_resets_total",
+                            "hidg endpoint closes after errors, hangups or explicit resets"),
+        registry.GetCounter("wheel_report_eagain_total", "Report writes that hit EAGAIN and had to wait"),
+        registry.GetCounter("wheel_report_write_errors_total", "Report writes that failed outright"),
+        registry.GetCounter("wheel_hid_udc_state_changes_total", "UDC link state transitions seen"),
+    };
+    return instance;
+}
+
 std::string HexValue(uint16_t value) {
     char buf[8];
     std::snprintf(buf, sizeof(buf), "%04x", value);
@@ -107,6 +119,23 @@ void RemoveGadgetTree(const std::string& gadget_name, const std::string& hid_fun
     RunCommand(cleanup);
 }
 
+UdcState ParseUdcState(const std::string& text) {
+    if (text == "configured") {
+        return UdcState::kConfigured;
+    }
+    if (text == "suspended") {
+        return UdcState::kSuspended;
+    }
+    if (text == "not attached") {
+        return UdcState::kNotAttached;
+    }
+    if (text == "attached" || text == "powered" || text == "reconnecting" || text == "unauthenticated" ||
+        text == "default" || text == "addressed") {
+        return UdcState::kDefault;
+    }
+    return UdcState::kUnknown;
+}
+
 void EnsureKernelModulesLoaded() {
     RunCommand("modprobe libcomposite 2>/dev/null");
     RunCommand("modprobe dummy_hcd 2>/dev/null");
@@ -122,15 +151,107 @@ void EnsureConfigfsMounted() {
 
 }  // namespace
 
+const char* UdcStateName(UdcState state) {
+    switch (state) {
+    case UdcState::kNotAttached:
+        return "not attached";
+    case UdcState::kDefault:
+        return "default";
+    case UdcState::kConfigured:
+        return "configured";
+    case UdcState::kSuspended:
+        return "suspended";
+    case UdcState::kUnknown:
+        break;
+    }
+    return "unknown";
+}
+
 HidDevice::HidDevice()
-        : fd_(-1), udc_bound_(false), non_blocking_mode_(true) {}
+        : fd_(-1), endpoint_event_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), endpoint_generation_(0),
+          udc_state_fd_(-1), udc_state_(UdcState::kUnknown), udc_bound_(false), udc_state_gauge_(nullptr),
+          non_blocking_mode_(true), gadget_created_(false) {
+    if (endpoint_event_fd_ < 0) {
+        LOG_ERROR("hid", "eventfd failed: " << std::strerror(errno));
+    }
+}
 
 HidDevice::~HidDevice() {
     Shutdown();
+    if (endpoint_event_fd_ >= 0) {
+        close(endpoint_event_fd_);
+        endpoint_event_fd_ = -1;
+    }
+    if (udc_state_fd_ >= 0) {
+        close(udc_state_fd_);
+        udc_state_fd_ = -1;
+    }
+}
+
+void HidDevice::Configure(const GadgetOptions& options) {
+    options_ = options;
+}
+
+void HidDevice::WakeEndpointWaiters() {
+    if (endpoint_event_fd_ < 0) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t rc = ::write(endpoint_event_fd_, &one, sizeof(one));
+    (void)rc;
+}
+
+UdcState HidDevice::RefreshUdcState() {
+    if (udc_state_fd_ < 0) {
+        return UdcState::kUnknown;
+    }
+    // pread from offset 0 re-reads the attribute and re-arms its POLLPRI notification.
+    char buf[32];
+    ssize_t len = pread(udc_state_fd_, buf, sizeof(buf) - 1, 0);
+    if (len < 0) {
+        LOG_ERROR("hid", "read UDC state failed: " << std::strerror(errno));
+        return udc_state_.load(std::memory_order_acquire);
+    }
+    std::string text(buf, static_cast<size_t>(len));
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.pop_back();
+    }
+    UdcState state = ParseUdcState(text);
+    UdcState previous = udc_state_.exchange(state, std::memory_order_acq_rel);
+    if (state != previous) {
+        Metrics().udc_state_changes.Increment();
+        if (udc_state_gauge_) {
+            udc_state_gauge_->Set(static_cast<int64_t>(state));
+        }
+        LOG_INFO("hid", "UDC state " << UdcStateName(previous) << " -> " << UdcStateName(state)
+                                     << " (" << text << ")");
+        WakeEndpointWaiters();
+    }
+    return state;
+}
+
+bool HidDevice::HostConfigured() const {
+    UdcState state = udc_state_.load(std::memory_order_acquire);
+    return state == UdcState::kConfigured || state == UdcState::kUnknown;
+}
+
+void HidDevice::CloseEndpointLocked() {
+    if (fd_ < 0) {
+        return;
+    }
+    close(fd_);
+    fd_ = -1;
+    endpoint_generation_.fetch_add(1, std::memory_order_acq_rel);
+    Metrics().endpoint_resets.Increment();
+    WakeEndpointWaiters();
 }
 
 bool HidDevice::Initialize() {
     LOG_INFO("hid", "Initializing USB HID gadget");
+    udc_state_gauge_ = &metrics::DefaultRegistry().GetGauge(
+            metrics::Labeled("wheel_hid_udc_state", metrics_labels_),
+            "UDC link state: 0 unknown, 1 not attached, 2 default, 3 configured, 4 suspended");
+    gadget_created_ = true;
     if (!CreateUSBGadget()) {
         LOG_ERROR("hid", "Failed to create USB gadget tree");
         return false;
@@ -147,12 +268,17 @@ bool HidDevice::Initialize() {
 }
 
 void HidDevice::Shutdown() {
+    if (!gadget_created_) {
+        return;
+    }
+    gadget_created_ = false;
     LOG_INFO("hid", "Shutting down HID gadget");
     {
         std::lock_guard<std::mutex> lock(fd_mutex_);
         if (fd_ >= 0) {
             close(fd_);
             fd_ = -1;
+            WakeEndpointWaiters();
         }
     }
     DestroyUSBGadget();
@@ -194,10 +320,7 @@ void HidDevice::SetNonBlockingMode(bool enabled) {
 
 void HidDevice::ResetEndpoint() {
     std::lock_guard<std::mutex> lock(fd_mutex_);
-    if (fd_ >= 0) {
-        close(fd_);
-        fd_ = -1;
-    }
+    CloseEndpointLocked();
 }
 
 bool HidDevice::CreateUSBGadget() {
@@ -213,22 +336,24 @@ bool HidDevice::CreateUSBGadget() {
         return false;
     }
 
-    const std::string gadget_path = std::string("/sys/kernel/config/usb_gadget/") + kGadgetName;
+    const std::string& gadget_name = options_.name;
+    const std::string& hid_function = options_.function;
+    const std::string gadget_path = kGadgetRoot + gadget_name;
     bool gadget_exists = (access(gadget_path.c_str(), F_OK) == 0);
     if (gadget_exists) {
-        bool hid_exists = (access((gadget_path + "/functions/" + kHidFunction).c_str(), F_OK) == 0);
+        bool hid_exists = (access((gadget_path + "/functions/" + hid_function).c_str(), F_OK) == 0);
         bool config_exists = (access((gadget_path + "/configs/c.1").c_str(), F_OK) == 0);
         if (!hid_exists || !config_exists) {
             LOG_INFO("hid", "Existing gadget incomplete, rebuilding");
-            RemoveGadgetTree(kGadgetName, kHidFunction);
+            RemoveGadgetTree(gadget_name, hid_function);
             gadget_exists = false;
         }
     }
 
     if (!gadget_exists) {
         std::string descriptor_hex;
-        descriptor_hex.reserve(sizeof(kG29HidDescriptor) * 4);
-        for (uint8_t byte : kG29HidDescriptor) {
+        descriptor_hex.reserve(kReportDescriptor.size() * 4);
+        for (uint8_t byte : kReportDescriptor.data) {
             char buf[8];
             std::snprintf(buf, sizeof(buf), "\\x%02x", byte);
             descriptor_hex += buf;
@@ -239,7 +364,7 @@ bool HidDevice::CreateUSBGadget() {
         const std::string version_hex = HexValue(kVersion);
 
         std::string cmd = "cd /sys/kernel/config/usb_gadget && ";
-        cmd += "mkdir -p " + std::string(kGadgetName) + " && cd " + kGadgetName + " && ";
+        cmd += "mkdir -p " + gadget_name + " && cd " + gadget_name + " && ";
         cmd += "echo 0x" + vendor_hex + " > idVendor && ";
         cmd += "echo 0x" + product_hex + " > idProduct && ";
         cmd += "echo 0x" + version_hex + " > bcdDevice && ";
@@ -247,80 +372,122 @@ bool HidDevice::CreateUSBGadget() {
         cmd += "mkdir -p strings/0x409 && ";
         cmd += "echo 'Logitech' > strings/0x409/manufacturer && ";
         cmd += "echo 'G29 Driving Force Racing Wheel' > strings/0x409/product && ";
-        cmd += "echo '000000000001' > strings/0x409/serialnumber && ";
-        cmd += "mkdir -p functions/" + std::string(kHidFunction) + " && cd functions/" + kHidFunction + " && ";
+        cmd += "echo '" + options_.serial + "' > strings/0x409/serialnumber && ";
+        cmd += "mkdir -p functions/" + hid_function + " && cd functions/" + hid_function + " && ";
         cmd += "echo 1 > protocol && echo 1 > subclass && ";
-        cmd += "echo " + std::to_string(kReportLength) + " > report_length && ";
+        cmd += "echo " + std::to_string(G29Report::kSize) + " > report_length && ";
         cmd += "printf '" + descriptor_hex + "' > report_desc && ";
-        cmd += "cd /sys/kernel/config/usb_gadget/" + std::string(kGadgetName) + " && ";
+        cmd += "cd " + gadget_path + " && ";
         cmd += "mkdir -p configs/c.1/strings/0x409 && ";
         cmd += "echo 'G29 Configuration' > configs/c.1/strings/0x409/configuration && ";
         cmd += "echo 500 > configs/c.1/MaxPower && ";
-        cmd += "ln -sf functions/" + std::string(kHidFunction) + " configs/c.1/";
+        cmd += "ln -sf functions/" + hid_function + " configs/c.1/";
 
         if (!RunCommand(cmd)) {
             LOG_ERROR("hid", "Failed to create USB gadget tree");
-            RemoveGadgetTree(kGadgetName, kHidFunction);
+            RemoveGadgetTree(gadget_name, hid_function);
             return false;
         }
-        LOG_INFO("hid", "Created USB gadget '" << kGadgetName << "'");
+        LOG_INFO("hid", "Created USB gadget '" << gadget_name << "'");
     } else {
-        LOG_INFO("hid", "Reusing USB gadget '" << kGadgetName << "'");
+        LOG_INFO("hid", "Reusing USB gadget '" << gadget_name << "'");
     }
+    device_path_ = options_.device_path.empty() ? ResolveDevicePath() : options_.device_path;
 
     {
         std::lock_guard<std::mutex> guard(udc_mutex_);
         udc_name_ = ReadTrimmedFile(GadgetUDCPath());
         if (udc_name_.empty()) {
-            udc_name_ = DetectFirstUDC();
+            udc_name_ = options_.udc.empty() ? DetectFreeUDC() : options_.udc;
         }
         if (udc_name_.empty()) {
             LOG_ERROR("hid", "No UDC available to bind");
             return false;
         }
+        if (udc_state_fd_ < 0) {
+            udc_state_fd_ = open(GadgetStatePath().c_str(), O_RDONLY | O_CLOEXEC);
+            if (udc_state_fd_ < 0) {
+                LOG_INFO("hid", "UDC state not readable (" << std::strerror(errno)
+                                                          << "); writes will not wait for the host");
+            }
+        }
     }
+    RefreshUdcState();
 
     return true;
 }
 
 void HidDevice::DestroyUSBGadget() {
     UnbindUDC();
-    RemoveGadgetTree(kGadgetName, kHidFunction);
+    RemoveGadgetTree(options_.name, options_.function);
 }
 
 std::string HidDevice::GadgetUDCPath() const {
-    return std::string("/sys/kernel/config/usb_gadget/") + kGadgetName + "/UDC";
+    return kGadgetRoot + options_.name + "/UDC";
 }
 
 std::string HidDevice::GadgetStatePath() const {
-    return std::string("/sys/kernel/config/usb_gadget/") + kGadgetName + "/state";
+    return "/sys/class/udc/" + udc_name_ + "/state";
 }
 
-std::string HidDevice::DetectFirstUDC() const {
+// The first controller that no other gadget is bound to, so several wheels started
+// in turn each take their own.
+std::string HidDevice::DetectFreeUDC() const {
+    std::vector<std::string> taken;
+    if (DIR* gadgets = opendir(kGadgetRoot)) {
+        struct dirent* entry;
+        while ((entry = readdir(gadgets)) != nullptr) {
+            if (entry->d_name[0] == '.' || options_.name == entry->d_name) {
+                continue;
+            }
+            std::string bound = ReadTrimmedFile(kGadgetRoot + std::string(entry->d_name) + "/UDC");
+            if (!bound.empty()) {
+                taken.push_back(bound);
+            }
+        }
+        closedir(gadgets);
+    }
+
     DIR* dir = opendir("/sys/class/udc");
     if (!dir) {
         return {};
     }
+    std::vector<std::string> candidates;
     struct dirent* entry;
     while ((entry = readdir(dir)) != nullptr) {
         if (entry->d_name[0] == '.') {
             continue;
         }
-        std::string candidate(entry->d_name);
-        closedir(dir);
-        return candidate;
+        candidates.emplace_back(entry->d_name);
     }
     closedir(dir);
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto& candidate : candidates) {
+        if (std::find(taken.begin(), taken.end(), candidate) == taken.end()) {
+            return candidate;
+        }
+    }
     return {};
 }
 
+// f_hid names its node hidg<minor>; the minor is in the function's dev attribute.
+std::string HidDevice::ResolveDevicePath() const {
+    const std::string dev = ReadTrimmedFile(kGadgetRoot + options_.name + "/functions/" + options_.function + "/dev");
+    const size_t colon = dev.find(':');
+    if (colon == std::string::npos || colon + 1 >= dev.size()) {
+        LOG_INFO("hid", "Cannot read the hidg minor of " << options_.name << "; assuming " << kFallbackDevicePath);
+        return kFallbackDevicePath;
+    }
+    return "/dev/hidg" + dev.substr(colon + 1);
+}
+
 bool HidDevice::BindUDC() {
     std::lock_guard<std::mutex> guard(udc_mutex_);
     if (udc_bound_.load(std::memory_order_acquire)) {
         return true;
     }
     if (udc_name_.empty()) {
-        udc_name_ = DetectFirstUDC();
+        udc_name_ = options_.udc.empty() ? DetectFreeUDC() : options_.udc;
         if (udc_name_.empty()) {
             LOG_ERROR("hid", "Cannot bind gadget: no UDC");
             return false;
@@ -331,6 +498,9 @@ bool HidDevice::BindUDC() {
         return false;
     }
     udc_bound_.store(true, std::memory_order_release);
+    Metrics().binds.Increment();
+    RefreshUdcState();
+    WakeEndpointWaiters();
     LOG_INFO("hid", "Bound gadget to UDC '" << udc_name_ << "'");
     return true;
 }
@@ -345,7 +515,10 @@ bool HidDevice::UnbindUDC() {
         return false;
     }
     udc_bound_.store(false, std::memory_order_release);
+    Metrics().unbinds.Increment();
+    RefreshUdcState();
     ResetEndpoint();
+    WakeEndpointWaiters();
     LOG_INFO("hid", "Unbound gadget from UDC");
     return true;
 }
@@ -359,15 +532,67 @@ bool HidDevice::EnsureEndpointOpen() {
     if (non_blocking_mode_.load()) {
         flags |= O_NONBLOCK;
     }
-    fd_ = open(kHidDevicePath, flags);
+    const std::string path = device_path_.empty() ? kFallbackDevicePath : device_path_;
+    fd_ = open(path.c_str(), flags);
     if (fd_ < 0) {
-        LOG_ERROR("hid", "Failed to open " << kHidDevicePath << ": " << std::strerror(errno));
+        LOG_ERROR("hid", "Failed to open " << path << ": " << std::strerror(errno));
         return false;
     }
-    LOG_INFO("hid", "Opened HID endpoint " << kHidDevicePath);
+    Metrics().endpoint_opens.Increment();
+    WakeEndpointWaiters();
+    LOG_INFO("hid", "Opened HID endpoint " << path);
     return true;
 }
 
+io::Backend HidDevice::SetIoBackend(io::Backend backend) {
+    std::lock_guard<std::mutex> lock(write_ring_mutex_);
+    if (backend != io::Backend::kIoUring) {
+        write_ring_.reset();
+        return io::Backend::kEpoll;
+    }
+    if (write_ring_) {
+        return io::Backend::kIoUring;
+    }
+    auto ring = std::make_unique<io::Uring>();
+    if (!ring->Init(kWriteRingEntries)) {
+        LOG_WARN("hid", "io_uring unavailable; writing reports with write()");
+        return io::Backend::kEpoll;
+    }
+    write_ring_ = std::move(ring);
+    return io::Backend::kIoUring;
+}
+
+// One write attempt with write() semantics: bytes written, or -1 with errno set.
+ssize_t HidDevice::WriteOnce(int fd, const uint8_t* data, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(write_ring_mutex_);
+        if (write_ring_) {
+            bool done = false;
+            int32_t res = 0;
+            write_ring_->PrepareWrite(fd, data, size, kWriteTag);
+            if (write_ring_->Submit(1)) {
+                write_ring_->Reap([&](const io::Uring::Completion& completion) {
+                    if (completion.user_data == kWriteTag) {
+                        res = completion.res;
+                        done = true;
+                    }
+                });
+            }
+            if (done) {
+                if (res < 0) {
+                    errno = -res;
+                    return -1;
+                }
+                return res;
+            }
+            // Never leave a queued write pointing at the caller's buffer behind.
+            LOG_ERROR("hid", "io_uring report write did not complete; falling back to write()");
+            write_ring_.reset();
+        }
+    }
+    return ::write(fd, data, size);
+}
+
 bool HidDevice::WaitForEndpointReady(int timeout_ms) {
     if (timeout_ms <= 0) {
         timeout_ms = kDefaultPollTimeoutMs;
@@ -403,8 +628,7 @@ bool HidDevice::WaitForEndpointReady(int timeout_ms) {
             }
             if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
                 std::lock_guard<std::mutex> lock(fd_mutex_);
-                close(fd_);
-                fd_ = -1;
+                CloseEndpointLocked();
                 continue;
             }
         } else if (rc == 0) {
@@ -437,7 +661,7 @@ bool HidDevice::WriteHIDBlocking(const uint8_t* data, size_t size) {
             continue;
         }
 
-        ssize_t written = ::write(fd_copy, data + total, size - total);
+        ssize_t written = WriteOnce(fd_copy, data + total, size - total);
         if (written > 0) {
             total += static_cast<size_t>(written);
             continue;
@@ -454,28 +678,38 @@ bool HidDevice::WriteHIDBlocking(const uint8_t* data, size_t size) {
             continue;
         }
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            if (!WaitForEndpointReady(kDefaultPollTimeoutMs)) {
+            Metrics().write_eagain.Increment();
+            // A suspended host will not drain the endpoint; the caller parks until it
+            // is configured again instead of stalling here.
+            RefreshUdcState();
+            if (!HostConfigured() || !WaitForEndpointReady(kDefaultPollTimeoutMs)) {
                 return false;
             }
             continue;
         }
         if (errno == EPIPE || errno == ENODEV || errno == ESHUTDOWN) {
-            std::lock_guard<std::mutex> lock(fd_mutex_);
-            if (fd_ >= 0) {
-                close(fd_);
-                fd_ = -1;
+            // The endpoint stays usable across a disconnect; only reopen it when the
+            // host still claims to be configured.
+            RefreshUdcState();
+            if (!HostConfigured()) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(fd_mutex_);
+                CloseEndpointLocked();
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
             continue;
         }
 
         LOG_ERROR("hid", "write failed: " << std::strerror(errno));
+        Metrics().write_errors.Increment();
         return false;
     }
     return true;
 }
 
-bool HidDevice::WriteReportBlocking(const std::array<uint8_t, 13>& report) {
+bool HidDevice::WriteReportBlocking(const WheelReport& report) {
     return WriteHIDBlocking(report.data(), report.size());
 }
 
@@ -3,11 +3,41 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <sys/types.h>
+
+#include "../io/uring.h"
+#include "../metrics/metrics.h"
+#include "g29_profile.h"
 
 namespace hid {
 
+// Link state of the bound UDC as reported by /sys/class/udc/<udc>/state, folded
+// into the states the writer cares about. kUnknown means the attribute could not
+// be read; nothing is gated on it then.
+enum class UdcState : uint8_t {
+    kUnknown,
+    kNotAttached,
+    kDefault,  // attached, powered, default or addressed: enumeration in progress
+    kConfigured,
+    kSuspended,
+};
+
+const char* UdcStateName(UdcState state);
+
+// Where one emulated wheel lives in configfs and /dev. Several HidDevices can run
+// side by side as long as each has its own gadget name and UDC.
+struct GadgetOptions {
+    std::string name = "g29wheel";       // directory under /sys/kernel/config/usb_gadget
+    std::string function = "hid.usb0";   // hid function instance inside the gadget
+    std::string udc;                     // controller to bind; empty = first one no gadget holds
+    std::string serial = "000000000001";
+    std::string device_path;             // hidg node; empty = resolved from the function's dev
+};
+
 class HidDevice {
 public:
     HidDevice();
@@ -18,6 +48,13 @@ public:
     HidDevice(HidDevice&&) noexcept = delete;
     HidDevice& operator=(HidDevice&&) noexcept = delete;
 
+    // Call before Initialize(); the defaults are the single-wheel gadget.
+    void Configure(const GadgetOptions& options);
+    const GadgetOptions& options() const { return options_; }
+    // Call before Initialize(). Prometheus labels (e.g. wheel="1") for this device's
+    // gauges, so gadgets of different wheels export separate series.
+    void SetMetricsLabels(const std::string& labels) { metrics_labels_ = labels; }
+
     bool Initialize();
     void Shutdown();
 
@@ -28,27 +65,69 @@ public:
     void ResetEndpoint();
 
     bool WaitForEndpointReady(int timeout_ms = 1500);
-    bool WriteReportBlocking(const std::array<uint8_t, 13>& report);
+    bool WriteReportBlocking(const WheelReport& report);
     bool WriteHIDBlocking(const uint8_t* data, size_t size);
 
+    // kIoUring submits report writes through a private ring (one io_uring_enter that
+    // also collects the result); errors take the same path as a failed write().
+    // Returns the backend in effect, kEpoll when no ring could be set up.
+    io::Backend SetIoBackend(io::Backend backend);
+
     bool BindUDC();
     bool UnbindUDC();
     bool IsUdcBound() const { return udc_bound_.load(std::memory_order_acquire); }
 
+    // Non-blocking eventfd that becomes readable whenever the endpoint is opened or
+    // closed, the UDC is bound/unbound, or WakeEndpointWaiters() is called. Readers
+    // drain it and re-query fd(); it stays valid for the object's lifetime.
+    int endpoint_event_fd() const { return endpoint_event_fd_; }
+    void WakeEndpointWaiters();
+    // Bumped each time the endpoint is closed, from any thread. A closed file leaves
+    // every epoll set and a reopened endpoint usually gets the same fd number, so
+    // readers re-register when this changes rather than comparing fds. Read it
+    // before fd() so a close in between is seen on the next refresh.
+    uint64_t endpoint_generation() const { return endpoint_generation_.load(std::memory_order_acquire); }
+
+    // The UDC state attribute, opened by Initialize() and pollable for EPOLLPRI;
+    // -1 if it is unavailable. RefreshUdcState() re-reads it (and must be called
+    // after each notification to re-arm it); a change is logged, counted and
+    // signalled on endpoint_event_fd().
+    int udc_state_fd() const { return udc_state_fd_; }
+    UdcState RefreshUdcState();
+    UdcState udc_state() const { return udc_state_.load(std::memory_order_acquire); }
+    // Reports can reach the host: configured, or the state cannot be monitored.
+    bool HostConfigured() const;
+
 private:
     bool CreateUSBGadget();
     void DestroyUSBGadget();
     std::string GadgetUDCPath() const;
     std::string GadgetStatePath() const;
-    std::string DetectFirstUDC() const;
+    std::string DetectFreeUDC() const;
+    std::string ResolveDevicePath() const;
     bool EnsureEndpointOpen();
+    void CloseEndpointLocked();
+    ssize_t WriteOnce(int fd, const uint8_t* data, size_t size);
 
     int fd_;
+    int endpoint_event_fd_;
+    std::atomic<uint64_t> endpoint_generation_;
+    int udc_state_fd_;
+    std::atomic<UdcState> udc_state_;
     std::atomic<bool> udc_bound_;
     std::string udc_name_;
+    GadgetOptions options_;
+    std::string metrics_labels_;
+    metrics::Gauge* udc_state_gauge_;  // set by Initialize()
+    std::string device_path_;  // options_.device_path, or resolved by CreateUSBGadget()
     std::atomic<bool> non_blocking_mode_;
+    // Set once Initialize() has touched configfs; a device that was never created
+    // (e.g. the simulation harness) must not tear down a running emulator's gadget.
+    bool gadget_created_;
     mutable std::mutex fd_mutex_;
     mutable std::mutex udc_mutex_;
+    std::unique_ptr<io::Uring> write_ring_;  // null = plain write()
+    std::mutex write_ring_mutex_;
 
 };
 
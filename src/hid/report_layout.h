@@ -0,0 +1,205 @@
+#ifndef HID_REPORT_LAYOUT_H
+#define HID_REPORT_LAYOUT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Compile-time description of a HID report. A profile lists its fields once; the
+// report descriptor bytes and the bit offsets the packer stores to are both derived
+// from that list, so the two cannot drift apart. Everything here is constexpr and
+// every offset is a template argument, so packing compiles to fixed byte stores.
+namespace hid {
+
+// A constexpr byte string, concatenated with +.
+template <size_t N>
+struct Bytes {
+    std::array<uint8_t, N> data{};
+
+    static constexpr size_t size() { return N; }
+};
+
+template <size_t A, size_t B>
+constexpr Bytes<A + B> operator+(const Bytes<A>& a, const Bytes<B>& b) {
+    Bytes<A + B> out{};
+    for (size_t i = 0; i < A; ++i) {
+        out.data[i] = a.data[i];
+    }
+    for (size_t i = 0; i < B; ++i) {
+        out.data[A + i] = b.data[i];
+    }
+    return out;
+}
+
+// Short item tags with the size bits clear (HID 1.11, 6.2.2.4-6.2.2.8).
+enum Tag : uint8_t {
+    kInput = 0x80,
+    kOutput = 0x90,
+    kCollection = 0xA0,
+    kEndCollection = 0xC0,
+    kUsagePage = 0x04,
+    kLogicalMinimum = 0x14,
+    kLogicalMaximum = 0x24,
+    kPhysicalMinimum = 0x34,
+    kPhysicalMaximum = 0x44,
+    kUnit = 0x64,
+    kReportSize = 0x74,
+    kReportCount = 0x94,
+    kUsage = 0x08,
+    kUsageMinimum = 0x18,
+    kUsageMaximum = 0x28,
+};
+
+// Main item data bits.
+enum MainFlags : uint8_t {
+    kData = 0x00,
+    kConstant = 0x01,
+    kVariable = 0x02,
+    kNullState = 0x40,
+};
+
+enum CollectionType : uint8_t {
+    kPhysical = 0x00,
+    kApplication = 0x01,
+    kLogical = 0x02,
+};
+
+// Extents are signed in the descriptor, so 255 needs two bytes and 65535 four.
+constexpr bool IsSignedTag(uint8_t tag) {
+    return tag == kLogicalMinimum || tag == kLogicalMaximum || tag == kPhysicalMinimum || tag == kPhysicalMaximum;
+}
+
+constexpr size_t ItemDataSize(uint8_t tag, int64_t value) {
+    if (tag == kEndCollection) {
+        return 0;
+    }
+    if (IsSignedTag(tag)) {
+        return value >= -128 && value <= 127 ? 1 : value >= -32768 && value <= 32767 ? 2 : 4;
+    }
+    return value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : 4;
+}
+
+template <uint8_t TagValue, int64_t Value = 0>
+constexpr auto Item() {
+    constexpr size_t kDataSize = ItemDataSize(TagValue, Value);
+    Bytes<1 + kDataSize> out{};
+    out.data[0] = static_cast<uint8_t>(TagValue | (kDataSize == 4 ? 3 : kDataSize));
+    const uint64_t bits = static_cast<uint64_t>(Value);
+    for (size_t i = 0; i < kDataSize; ++i) {
+        out.data[1 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    return out;
+}
+
+template <int64_t Min, int64_t Max>
+constexpr auto LogicalRange() {
+    return Item<kLogicalMinimum, Min>() + Item<kLogicalMaximum, Max>();
+}
+
+template <int64_t Min, int64_t Max>
+constexpr auto PhysicalRange() {
+    return Item<kPhysicalMinimum, Min>() + Item<kPhysicalMaximum, Max>();
+}
+
+template <uint8_t... Usages>
+constexpr auto UsageList() {
+    return (Item<kUsage, Usages>() + ...);
+}
+
+// `Count` values of `Bits` bits each, packed LSB first from the field's bit offset.
+// A profile derives from Field and supplies `static constexpr auto Descriptor()`
+// with the items that describe it, ending in InputItem<...>().
+template <size_t Bits, size_t Count>
+struct Field {
+    static_assert(Bits > 0 && Bits <= 32, "a field value must fit in 32 bits");
+    static constexpr size_t kBits = Bits;
+    static constexpr size_t kCount = Count;
+    static constexpr size_t kTotalBits = Bits * Count;
+};
+
+// Report Size, Report Count and the Input main item for field F.
+template <typename F, uint8_t Flags>
+constexpr auto InputItem() {
+    return Item<kReportSize, F::kBits>() + Item<kReportCount, F::kCount>() + Item<kInput, Flags>();
+}
+
+// Constant bits that pad the following field to a byte boundary.
+template <size_t Bits>
+struct Padding : Field<Bits, 1> {
+    static constexpr auto Descriptor() { return InputItem<Padding, kConstant | kVariable>(); }
+};
+
+// An input report made of Fields in order. Buffer is the wire format; Set/Get move
+// values in and out at offsets fixed by the field list.
+template <typename... Fields>
+struct InputReport {
+    static constexpr size_t kBits = (Fields::kTotalBits + ...);
+    static_assert(kBits % 8 == 0, "input report must end on a byte boundary");
+    static constexpr size_t kSize = kBits / 8;
+
+    using Buffer = std::array<uint8_t, kSize>;
+
+    // The input items of every field, in report order.
+    static constexpr auto Descriptor() { return (Fields::Descriptor() + ...); }
+
+    template <typename F>
+    static constexpr size_t BitOffset() {
+        static_assert((std::is_same_v<F, Fields> || ...), "field is not part of this report");
+        size_t offset = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<F, Fields>, offset += found ? 0 : Fields::kTotalBits), ...);
+        return offset;
+    }
+
+    // Value `Index` of field F.
+    template <typename F, size_t Index = 0>
+    static constexpr void Set(Buffer& report, uint32_t value) {
+        static_assert(Index < F::kCount, "field index out of range");
+        Store<BitOffset<F>() + Index * F::kBits, F::kBits>(report, value);
+    }
+
+    template <typename F, size_t Index = 0>
+    static constexpr uint32_t Get(const Buffer& report) {
+        static_assert(Index < F::kCount, "field index out of range");
+        return Load<BitOffset<F>() + Index * F::kBits, F::kBits>(report);
+    }
+
+    // All values of a field at once, value 0 in the low bits (e.g. a button bitmap).
+    template <typename F>
+    static constexpr void SetAll(Buffer& report, uint32_t bits) {
+        static_assert(F::kTotalBits <= 32, "field too wide for SetAll");
+        Store<BitOffset<F>(), F::kTotalBits>(report, bits);
+    }
+
+private:
+    template <size_t Bit, size_t Width>
+    static constexpr void Store(Buffer& report, uint32_t value) {
+        static_assert(Bit + Width <= kBits, "field past the end of the report");
+        constexpr size_t kFirst = Bit / 8;
+        constexpr size_t kLast = (Bit + Width - 1) / 8;
+        constexpr uint64_t kMask = ((uint64_t{1} << Width) - 1) << (Bit % 8);
+        const uint64_t shifted = (static_cast<uint64_t>(value) << (Bit % 8)) & kMask;
+        for (size_t i = kFirst; i <= kLast; ++i) {
+            const uint8_t mask = static_cast<uint8_t>(kMask >> (8 * (i - kFirst)));
+            const uint8_t bits = static_cast<uint8_t>(shifted >> (8 * (i - kFirst)));
+            report[i] = mask == 0xFF ? bits : static_cast<uint8_t>((report[i] & ~mask) | bits);
+        }
+    }
+
+    template <size_t Bit, size_t Width>
+    static constexpr uint32_t Load(const Buffer& report) {
+        static_assert(Bit + Width <= kBits, "field past the end of the report");
+        constexpr size_t kFirst = Bit / 8;
+        constexpr size_t kLast = (Bit + Width - 1) / 8;
+        uint64_t bits = 0;
+        for (size_t i = kFirst; i <= kLast; ++i) {
+            bits |= static_cast<uint64_t>(report[i]) << (8 * (i - kFirst));
+        }
+        return static_cast<uint32_t>((bits >> (Bit % 8)) & ((uint64_t{1} << Width) - 1));
+    }
+};
+
+}  // namespace hid
+
+#endif  // HID_REPORT_LAYOUT_H
@@ -1,20 +1,73 @@
 #include "device_enumerator.h"
 
+#include <algorithm>
 #include <chrono>
 #include <dirent.h>
+#include <cerrno>
 #include <cstring>
+#include <poll.h>
 #include <string>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 #include <utility>
 
+#include "../logging/logger.h"
+#include "../metrics/metrics.h"
+
 namespace {
-constexpr auto kScanInterval = std::chrono::milliseconds(400);
+constexpr const char* kTag = "device_enumerator";
+constexpr const char* kInputDir = "/dev/input";
+// Full rescans only run on this timer while /dev/input is not watched (inotify
+// unavailable, or the watch was lost); with a watch, hotplug deltas arrive immediately.
+constexpr int kFallbackScanMs = 2000;
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE_SELF;
+
+struct EnumeratorMetrics {
+    metrics::Counter& hotplug_events;
+    metrics::Counter& full_scans;
+};
+
+EnumeratorMetrics& Metrics() {
+    static EnumeratorMetrics m{
+        metrics::DefaultRegistry().GetCounter("wheel_enumerator_hotplug_events_total",
+                                              "Event node additions/removals reported from inotify"),
+        metrics::DefaultRegistry().GetCounter("wheel_enumerator_full_scans_total",
+                                              "Full /dev/input rescans (requests, fallback timer, lost events)"),
+    };
+    return m;
+}
+
+// A node both added and removed within one batch is reported by its final state.
+void MoveNode(std::vector<std::string>& to, std::vector<std::string>& from, std::string path) {
+    from.erase(std::remove(from.begin(), from.end(), path), from.end());
+    if (std::find(to.begin(), to.end(), path) == to.end()) {
+        to.push_back(std::move(path));
+    }
+}
 }
 
 DeviceEnumerator::DeviceEnumerator(ScanCallback callback)
-        : callback_(std::move(callback)), stop_(false), scan_requested_(false), force_requested_(false) {}
+        : callback_(std::move(callback)), stop_(false), scan_requested_(false), force_requested_(false),
+          inotify_fd_(-1), watch_(-1), wake_fd_(-1) {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ >= 0) {
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    }
+    if (!ArmWatch()) {
+        LOG_WARN(kTag, "inotify on " << kInputDir << " unavailable (" << std::strerror(errno)
+                                     << "); rescanning every " << kFallbackScanMs << " ms");
+    }
+}
 
 DeviceEnumerator::~DeviceEnumerator() {
     Stop();
+    if (inotify_fd_ >= 0) {
+        close(inotify_fd_);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
 }
 
 void DeviceEnumerator::Start() {
@@ -32,6 +85,7 @@ void DeviceEnumerator::Stop() {
         stop_ = true;
     }
     cv_.notify_all();
+    SignalWake();
     if (thread_.joinable()) {
         thread_.join();
     }
@@ -44,29 +98,122 @@ void DeviceEnumerator::RequestScan(bool force) {
         force_requested_ = force_requested_ || force;
     }
     cv_.notify_all();
+    SignalWake();
 }
 
 std::vector<std::string> DeviceEnumerator::EnumerateNow() const {
     return EnumerateEventNodes();
 }
 
+void DeviceEnumerator::SignalWake() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t rc = write(wake_fd_, &one, sizeof(one));
+        (void)rc;
+    }
+}
+
+void DeviceEnumerator::DrainWake() {
+    uint64_t value;
+    while (wake_fd_ >= 0 && read(wake_fd_, &value, sizeof(value)) > 0) {
+    }
+}
+
+bool DeviceEnumerator::ArmWatch() {
+    if (inotify_fd_ < 0) {
+        return false;
+    }
+    if (watch_ < 0) {
+        watch_ = inotify_add_watch(inotify_fd_, kInputDir, kWatchMask);
+    }
+    return watch_ >= 0;
+}
+
+bool DeviceEnumerator::ReadHotplugEvents(Update& update) {
+    alignas(struct inotify_event) char buffer[4096];
+    bool in_sync = true;
+    for (;;) {
+        ssize_t len = read(inotify_fd_, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < len;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+            if (event->mask & IN_Q_OVERFLOW) {
+                in_sync = false;
+                continue;
+            }
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_UNMOUNT)) {
+                // /dev/input itself went away; the fallback timer takes over until it is back.
+                watch_ = -1;
+                in_sync = false;
+                continue;
+            }
+            if (event->len == 0 || strncmp(event->name, "event", 5) != 0) {
+                continue;
+            }
+            std::string path = std::string(kInputDir) + "/" + event->name;
+            Metrics().hotplug_events.Increment();
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                MoveNode(update.removed, update.added, std::move(path));
+            } else {
+                // IN_ATTRIB matters: udev creates the node before it fixes permissions,
+                // so the first open attempt may fail and must be retried on the chmod.
+                MoveNode(update.added, update.removed, std::move(path));
+            }
+        }
+    }
+    return in_sync;
+}
+
 void DeviceEnumerator::ThreadMain() {
+    static metrics::Counter& wakeups = metrics::ThreadWakeups("enumerator");
     std::unique_lock<std::mutex> lock(mutex_);
     while (!stop_) {
-        cv_.wait_for(lock, kScanInterval, [this]() {
-            return stop_ || scan_requested_;
-        });
+        Update update;
+        bool timed_out = false;
+        if (wake_fd_ < 0) {
+            // No eventfd to poll alongside inotify: the old condition-variable rescan loop.
+            timed_out = !cv_.wait_for(lock, std::chrono::milliseconds(kFallbackScanMs),
+                                      [this]() { return stop_ || scan_requested_; });
+        } else if (!stop_ && !scan_requested_) {
+            bool watching = watch_ >= 0;
+            lock.unlock();
+            struct pollfd pfds[2] = {{wake_fd_, POLLIN, 0}, {watching ? inotify_fd_ : -1, POLLIN, 0}};
+            int rc = poll(pfds, 2, watching ? -1 : kFallbackScanMs);
+            timed_out = rc == 0;
+            if (rc > 0 && (pfds[0].revents & POLLIN)) {
+                DrainWake();
+            }
+            if (rc > 0 && (pfds[1].revents & POLLIN) && !ReadHotplugEvents(update)) {
+                update.full = true;
+            }
+            lock.lock();
+        }
         if (stop_) {
             break;
         }
-        bool requested = scan_requested_;
-        bool force = force_requested_;
+        wakeups.Increment();
+        if (scan_requested_ || timed_out) {
+            update.full = true;
+        }
+        update.force = force_requested_ || scan_requested_;
         scan_requested_ = false;
         force_requested_ = false;
+        if (!update.full && update.added.empty() && update.removed.empty()) {
+            continue;
+        }
         lock.unlock();
-        auto nodes = EnumerateEventNodes();
+        if (update.full) {
+            if (timed_out && ArmWatch()) {
+                LOG_INFO(kTag, "watching " << kInputDir << " again");
+            }
+            Metrics().full_scans.Increment();
+            update.nodes = EnumerateEventNodes();
+        }
         if (callback_) {
-            callback_(std::move(nodes), force || requested);
+            callback_(std::move(update));
         }
         lock.lock();
     }
@@ -74,7 +221,7 @@ void DeviceEnumerator::ThreadMain() {
 
 std::vector<std::string> DeviceEnumerator::EnumerateEventNodes() {
     std::vector<std::string> nodes;
-    DIR* dir = opendir("/dev/input");
+    DIR* dir = opendir(kInputDir);
     if (!dir) {
         return nodes;
     }
@@ -83,7 +230,7 @@ std::vector<std::string> DeviceEnumerator::EnumerateEventNodes() {
         if (strncmp(entry->d_name, "event", 5) != 0) {
             continue;
         }
-        nodes.emplace_back(std::string("/dev/input/") + entry->d_name);
+        nodes.emplace_back(std::string(kInputDir) + "/" + entry->d_name);
     }
     closedir(dir);
     return nodes;
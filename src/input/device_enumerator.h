@@ -11,7 +11,16 @@
 
 class DeviceEnumerator {
 public:
-    using ScanCallback = std::function<void(std::vector<std::string>&&, bool force)>;
+    // One report to the scanner. A full scan lists every event node; a hotplug delta
+    // only names nodes that appeared (or changed permissions) and nodes that vanished.
+    struct Update {
+        bool full = false;
+        bool force = false;
+        std::vector<std::string> nodes;    // full scans
+        std::vector<std::string> added;    // hotplug deltas
+        std::vector<std::string> removed;
+    };
+    using ScanCallback = std::function<void(Update&&)>;
 
     explicit DeviceEnumerator(ScanCallback callback);
     ~DeviceEnumerator();
@@ -26,6 +35,12 @@ public:
 
 private:
     void ThreadMain();
+    bool ArmWatch();
+    // Folds pending inotify events into `update`. Returns false when events were lost
+    // (queue overflow, watch removed) and only a full scan can resynchronize.
+    bool ReadHotplugEvents(Update& update);
+    void SignalWake();
+    void DrainWake();
     static std::vector<std::string> EnumerateEventNodes();
 
     ScanCallback callback_;
@@ -35,6 +50,9 @@ private:
     bool stop_;
     bool scan_requested_;
     bool force_requested_;
+    int inotify_fd_;
+    int watch_;    // -1 while /dev/input is not watched; full scans then run on a slow timer
+    int wake_fd_;  // eventfd kicked by RequestScan/Stop
 };
 
 #endif  // DEVICE_ENUMERATOR_H
@@ -7,6 +7,8 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/eventfd.h>
+#include <sys/time.h>
+#include <ctime>
 #include <unistd.h>
 #include <cstring>
 #include <vector>
@@ -14,13 +16,42 @@
 #include <cstdint>
 #include <linux/input-event-codes.h>
 #include <atomic>
-#include <poll.h>
+#include <sys/epoll.h>
 #include <thread>
 #include "../logging/logger.h"
+#include "../metrics/metrics.h"
 extern std::atomic<bool> running;
 
 namespace {
 constexpr const char* kTag = "device_scanner";
+// Reader poll period when no epoll instance could be created.
+constexpr int kDegradedWaitMs = 10;
+// io_uring backend: one buffer holds what a single evdev read() would return.
+constexpr unsigned kRingEntries = 64;
+constexpr unsigned kRingBuffers = 128;
+constexpr unsigned kRingBufferSize = 64 * sizeof(input_event);
+constexpr uint64_t kRingCancelTag = 0;  // completions of cancel requests themselves
+
+struct ScannerMetrics {
+    metrics::Counter& events_read;
+    metrics::Counter& drops;
+    metrics::Counter& drains;
+    metrics::Counter& ring_completions;
+};
+
+ScannerMetrics& Metrics() {
+    static ScannerMetrics instance{
+        metrics::DefaultRegistry().GetCounter("wheel_scanner_events_read_total",
+                                              "input_event records read from evdev nodes"),
+        metrics::DefaultRegistry().GetCounter("wheel_scanner_event_drops_total",
+                                              "SYN_DROPPED markers and short reads from evdev nodes"),
+        metrics::DefaultRegistry().GetCounter("wheel_scanner_device_drains_total",
+                                              "Per-device drain passes in Read (one per ready node)"),
+        metrics::DefaultRegistry().GetCounter("wheel_scanner_ring_completions_total",
+                                              "io_uring read completions reaped from evdev nodes"),
+    };
+    return instance;
+}
 }
 
 void DeviceScanner::Read() {
@@ -42,6 +73,18 @@ void DeviceScanner::NotifyInputChanged() {
 #define test_bit(bit, array)    ((array[LONG(bit)] >> OFF(bit)) & 1)
 
 namespace {
+// evdev stamps events with CLOCK_REALTIME unless asked otherwise; monotonic stamps
+// are comparable with steady_clock and immune to wall-clock steps.
+bool UseMonotonicTimestamps(int fd) {
+    int clock_id = CLOCK_MONOTONIC;
+    return ioctl(fd, EVIOCSCLOCKID, &clock_id) == 0;
+}
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 bool DeviceSupportsKeyboard(int fd) {
     unsigned long ev_bits[NBITS(EV_MAX)] = {0};
     if (ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0) {
@@ -68,12 +111,37 @@ bool DeviceSupportsMouse(int fd) {
 }
 
 DeviceScanner::DeviceScanner()
-                : enumerator_(std::bind(&DeviceScanner::HandleEnumeration, this, std::placeholders::_1, std::placeholders::_2)),
+                : enumerator_([this](DeviceEnumerator::Update&& update) { HandleEnumeration(std::move(update)); }),
                     resync_pending(true),
                     grab_desired(false),
                     prev_toggle(false),
-                    wake_event_fd_(-1) {
-        wake_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                    toggle_latched_(false),
+                    keys_released_(false),
+                    devices_gauge_(nullptr),
+                    wake_event_fd_(-1),
+                    epoll_fd_(-1),
+                    ready_events_{},
+                    ready_count_(0),
+                    ready_valid_(false),
+                    next_ring_tag_(kRingCancelTag + 1) {
+    wake_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ >= 0 && wake_event_fd_ >= 0) {
+        epoll_event wake{};
+        wake.events = EPOLLIN;
+        wake.data.fd = wake_event_fd_;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_event_fd_, &wake) < 0) {
+            close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+    } else if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+    if (epoll_fd_ < 0) {
+        LOG_WARN(kTag, "epoll unavailable (" << strerror(errno) << "); polling devices every "
+                                             << kDegradedWaitMs << " ms");
+    }
     memset(keys, 0, sizeof(keys));
     memset(key_counts, 0, sizeof(key_counts));
     last_keyboard_error = std::chrono::steady_clock::time_point::min();
@@ -90,6 +158,11 @@ DeviceScanner::~DeviceScanner() {
     for (auto& dev : devices) {
         CloseDevice(dev);
     }
+    uring_.reset();
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
     if (wake_event_fd_ >= 0) {
         close(wake_event_fd_);
         wake_event_fd_ = -1;
@@ -138,80 +211,127 @@ bool DeviceScanner::DiscoverMouse(const std::string& device_path) {
 }
 
 bool DeviceScanner::WaitForEvents(int timeout_ms) {
-    std::vector<pollfd> pfds;
-    if (wake_event_fd_ >= 0) {
-        pollfd wake{};
-        wake.fd = wake_event_fd_;
-        wake.events = POLLIN;
-        pfds.push_back(wake);
-    }
-    {
-        std::lock_guard<std::mutex> lock(devices_mutex);
-        pfds.reserve(pfds.size() + devices.size());
-        for (auto& dev : devices) {
-            if (dev.fd >= 0) {
-                pollfd p{};
-                p.fd = dev.fd;
-                p.events = POLLIN;
-                pfds.push_back(p);
-            }
-        }
-    }
-
-    bool has_wake_fd = wake_event_fd_ >= 0;
-    bool have_device_fds = pfds.size() > (has_wake_fd ? 1u : 0u);
-    if (!have_device_fds && !has_wake_fd) {
-        auto wait_pred = [this]() {
-            if (!running.load(std::memory_order_relaxed)) {
-                return true;
-            }
-            std::lock_guard<std::mutex> guard(devices_mutex);
-            return HasOpenDevicesLocked();
-        };
-        if (timeout_ms < 0) {
+    ready_count_ = 0;
+    if (epoll_fd_ < 0) {
+        ready_valid_ = false;
+        if (timeout_ms != 0) {
+            int wait_ms = timeout_ms < 0 ? kDegradedWaitMs : std::min(timeout_ms, kDegradedWaitMs);
             std::unique_lock<std::mutex> lock(input_mutex);
-            input_cv.wait(lock, wait_pred);
-        } else if (timeout_ms == 0) {
-            return false;
-        } else {
-            std::unique_lock<std::mutex> lock(input_mutex);
-            input_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), wait_pred);
+            input_cv.wait_for(lock, std::chrono::milliseconds(wait_ms));
         }
-        return false;
+        return true;
     }
 
-    int effective_timeout = timeout_ms;
-    int ret = poll(pfds.data(), pfds.size(), effective_timeout);
+    int ret = epoll_wait(epoll_fd_, ready_events_.data(), kMaxReadyEvents, timeout_ms);
     if (ret < 0) {
+        ready_valid_ = true;
         if (errno == EINTR) {
             return false;
         }
-        std::cerr << "[DeviceScanner::WaitForEvents] poll() error: " << strerror(errno) << std::endl;
+        std::cerr << "[DeviceScanner::WaitForEvents] epoll_wait() error: " << strerror(errno) << std::endl;
         return false;
     }
-    if (ret > 0 && has_wake_fd && (pfds[0].revents & POLLIN)) {
-        DrainWakeFd();
+    // Keep only device entries; the wake eventfd is consumed here.
+    for (int i = 0; i < ret; ++i) {
+        if (ready_events_[i].data.fd == wake_event_fd_) {
+            DrainWakeFd();
+            continue;
+        }
+        ready_events_[ready_count_++] = ready_events_[i];
     }
+    ready_valid_ = true;
     return ret > 0;
 }
 
 void DeviceScanner::Read(int& mouse_dx) {
+    mouse_dx = 0;
+    ReadPackets([&mouse_dx](const Packet& packet) { mouse_dx += packet.mouse_dx; }, false);
+}
+
+void DeviceScanner::Read(const PacketCallback& on_packet) {
+    ReadPackets(on_packet, true);
+}
+
+void DeviceScanner::ReadPackets(const PacketCallback& on_packet, bool consume_toggle) {
     if (!running) {
         return;
     }
     bool lost_device = false;
-    mouse_dx = 0;
 
     {
         std::lock_guard<std::mutex> lock(devices_mutex);
+        // Phase 1: pull whatever the kernel has queued for the ready devices. Ring-read
+        // devices were already filled by the kernel; their completions cost no syscall.
+        if (uring_) {
+            ReapRingLocked();
+        }
+        if (ready_valid_) {
+            // Entries may name devices closed since the wait (hotplug removal); those
+            // simply no longer match. Level triggering re-reports anything left unread.
+            for (int r = 0; r < ready_count_; ++r) {
+                const int fd = ready_events_[r].data.fd;
+                for (auto& dev : devices) {
+                    if (dev.fd == fd) {
+                        dev.lost = !FillDevice(dev);
+                        break;
+                    }
+                }
+            }
+            ready_count_ = 0;
+            ready_valid_ = false;
+        } else {
+            for (auto& dev : devices) {
+                if (dev.ring_tag == 0) {
+                    dev.lost = !FillDevice(dev);
+                }
+            }
+        }
+
+        // Phase 2: apply complete packets across devices, oldest SYN_REPORT first.
+        for (;;) {
+            DeviceHandle* next = nullptr;
+            for (auto& dev : devices) {
+                if (dev.packet_end == kNoPacket) {
+                    continue;
+                }
+                if (!next || PacketTimeNs(dev) < PacketTimeNs(*next)) {
+                    next = &dev;
+                }
+            }
+            if (!next) {
+                break;
+            }
+            Packet packet;
+            ApplyPacketLocked(*next, packet);
+            if (packet.toggle && !consume_toggle) {
+                toggle_latched_ = true;
+            }
+            on_packet(packet);
+        }
+
+        // Phase 3: keep only trailing partial packets, and drop failed devices.
         for (size_t i = 0; i < devices.size();) {
-            if (!DrainDevice(devices[i], mouse_dx)) {
-                CloseDevice(devices[i]);
-                devices.erase(devices.begin() + i);
+            DeviceHandle& dev = devices[i];
+            if (dev.lost) {
+                DropDeviceLocked(i);
                 lost_device = true;
-            } else {
-                ++i;
+                continue;
+            }
+            if (dev.cursor > 0) {
+                dev.pending.erase(dev.pending.begin(), dev.pending.begin() + static_cast<ptrdiff_t>(dev.cursor));
+                dev.cursor = 0;
             }
+            ++i;
+        }
+
+        // Keys released by a closed device (read failure, unplug, replacement) arrive in
+        // no packet; publish the state once so nothing stays held until the next event.
+        if (keys_released_) {
+            keys_released_ = false;
+            Packet packet;
+            packet.keys = keys;
+            packet.time_ns = SteadyNowNs();
+            on_packet(packet);
         }
     }
 
@@ -221,17 +341,28 @@ void DeviceScanner::Read(int& mouse_dx) {
     }
 }
 
-bool DeviceScanner::DrainDevice(DeviceHandle& dev, int& mouse_dx) {
+// Appends up to kMaxEventsPerDevice queued events to dev.pending, several per syscall.
+// Returns false when the device is gone.
+bool DeviceScanner::FillDevice(DeviceHandle& dev) {
     if (dev.fd < 0) {
         return false;
     }
-    constexpr int kMaxEventsPerDevice = 256;
-    int processed = 0;
-    struct input_event ev;
+    constexpr size_t kMaxEventsPerDevice = 256;
+    constexpr size_t kEventsPerRead = 64;
+    Metrics().drains.Increment();
+    dev.fill_ns = SteadyNowNs();
+    if (dev.pending.capacity() == 0) {
+        dev.pending.reserve(2 * kMaxEventsPerDevice);
+    }
+    size_t processed = 0;
     bool keep = true;
 
     while (processed < kMaxEventsPerDevice) {
-        ssize_t n = read(dev.fd, &ev, sizeof(ev));
+        const size_t base = dev.pending.size();
+        dev.pending.resize(base + kEventsPerRead);
+        ssize_t n = read(dev.fd, &dev.pending[base], kEventsPerRead * sizeof(input_event));
+        size_t count = n > 0 ? static_cast<size_t>(n) / sizeof(input_event) : 0;
+        dev.pending.resize(base + count);
         if (n == -1) {
             if (errno == EINTR) {
                 continue;
@@ -251,40 +382,191 @@ bool DeviceScanner::DrainDevice(DeviceHandle& dev, int& mouse_dx) {
             keep = false;
             break;
         }
-        if (n != sizeof(ev)) {
+        if (static_cast<size_t>(n) % sizeof(input_event) != 0) {
             std::cerr << "[DeviceScanner::Read] (" << dev.path << ") short read" << std::endl;
-            continue;
+            Metrics().drops.Increment();
+        }
+        processed += count;
+        if (count < kEventsPerRead) {
+            break;
         }
+    }
+
+    if (processed > 0) {
+        Metrics().events_read.Increment(static_cast<uint64_t>(processed));
+    }
+    FindPacketEndLocked(dev);
+    return keep;
+}
 
-        processed++;
-        if (dev.keyboard_capable && ev.type == EV_KEY && ev.code < KEY_MAX) {
-            if (dev.key_shadow.empty()) {
-                dev.key_shadow.assign(KEY_MAX, 0);
+void DeviceScanner::ReapRingLocked() {
+    const int64_t now_ns = SteadyNowNs();
+    uint64_t events = 0;
+    size_t reaped = uring_->Reap([&](const io::Uring::Completion& completion) {
+        DeviceHandle* dev = nullptr;
+        for (auto& candidate : devices) {
+            if (candidate.ring_tag != 0 && candidate.ring_tag == completion.user_data) {
+                dev = &candidate;
+                break;
             }
-            uint8_t prev = dev.key_shadow[ev.code];
-            uint8_t next = ev.value ? 1 : 0;
-            if (prev != next) {
-                dev.key_shadow[ev.code] = next;
-                if (next) {
-                    key_counts[ev.code]++;
-                } else if (key_counts[ev.code] > 0) {
-                    key_counts[ev.code]--;
-                }
-                keys[ev.code] = key_counts[ev.code] > 0;
+        }
+        if (!dev) {
+            return;  // a cancel, or the last completion of a closed device
+        }
+        if (completion.res > 0 && completion.data) {
+            const size_t bytes = static_cast<size_t>(completion.res);
+            const size_t count = bytes / sizeof(input_event);
+            if (bytes % sizeof(input_event) != 0) {
+                std::cerr << "[DeviceScanner::Read] (" << dev->path << ") short read" << std::endl;
+                Metrics().drops.Increment();
             }
-            dev.last_active = std::chrono::steady_clock::now();
+            const size_t base = dev->pending.size();
+            dev->pending.resize(base + count);
+            memcpy(&dev->pending[base], completion.data, count * sizeof(input_event));
+            dev->fill_ns = now_ns;
+            events += count;
+        } else if (completion.res == 0 || completion.res == -ENODEV || completion.res == -EIO) {
+            dev->lost = true;
+            return;
+        } else if (completion.res < 0 && completion.res != -ENOBUFS) {
+            // Not something the ring can read; serve this node through epoll instead.
+            LOG_WARN(kTag, "io_uring read on " << dev->path << " failed (" << strerror(-completion.res)
+                                                << "); using epoll for it");
+            dev->ring_tag = 0;
+            dev->ring_refused = true;
+            WatchDeviceLocked(*dev);
+            return;
         }
-        if (dev.mouse_capable && ev.type == EV_REL && ev.code == REL_X) {
-            mouse_dx += ev.value;
-            dev.last_active = std::chrono::steady_clock::now();
+        if (!completion.more) {
+            // Buffer exhaustion (ENOBUFS) or the kernel ending the multishot; re-post.
+            ArmRingReadLocked(*dev);
         }
+    });
+    if (reaped == 0) {
+        return;
     }
+    Metrics().ring_completions.Increment(reaped);
+    if (events > 0) {
+        Metrics().events_read.Increment(events);
+    }
+    uring_->Submit();
+    for (auto& dev : devices) {
+        if (dev.ring_tag != 0) {
+            FindPacketEndLocked(dev);
+        }
+    }
+}
 
-    return keep;
+void DeviceScanner::FindPacketEndLocked(DeviceHandle& dev) {
+    dev.packet_end = kNoPacket;
+    for (size_t i = dev.cursor; i < dev.pending.size(); ++i) {
+        const input_event& ev = dev.pending[i];
+        if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+            dev.packet_end = i;
+            return;
+        }
+    }
+}
+
+int64_t DeviceScanner::PacketTimeNs(const DeviceHandle& dev) {
+    if (!dev.monotonic_time) {
+        return dev.fill_ns;
+    }
+    const struct timeval& time = dev.pending[dev.packet_end].time;
+    return static_cast<int64_t>(time.tv_sec) * 1000000000LL + static_cast<int64_t>(time.tv_usec) * 1000LL;
+}
+
+void DeviceScanner::ApplyPacketLocked(DeviceHandle& dev, Packet& packet) {
+    const size_t end = dev.packet_end;
+    packet.time_ns = PacketTimeNs(dev);
+    bool dropped = false;
+    for (size_t i = dev.cursor; i < end; ++i) {
+        if (dev.pending[i].type == EV_SYN && dev.pending[i].code == SYN_DROPPED) {
+            dropped = true;
+            break;
+        }
+    }
+
+    if (dropped) {
+        // The kernel buffer overflowed: everything up to this SYN_REPORT is partial.
+        // Discard it and take the device's key state from EVIOCGKEY instead.
+        Metrics().drops.Increment();
+        ResyncDeviceKeysLocked(dev);
+    } else {
+        for (size_t i = dev.cursor; i < end; ++i) {
+            const input_event& ev = dev.pending[i];
+            if (dev.keyboard_capable && ev.type == EV_KEY && ev.code < KEY_MAX) {
+                // Autorepeat (value 2) keeps the key down.
+                SetKeyLocked(dev, ev.code, ev.value != 0);
+                dev.last_active = std::chrono::steady_clock::now();
+            } else if (dev.mouse_capable && ev.type == EV_REL && ev.code == REL_X) {
+                packet.mouse_dx += ev.value;
+                dev.last_active = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    dev.cursor = end + 1;
+    FindPacketEndLocked(dev);
+    packet.keys = keys;
+    packet.toggle = UpdateToggleLocked();
+}
+
+void DeviceScanner::SetKeyLocked(DeviceHandle& dev, int code, bool pressed) {
+    if (dev.key_shadow.empty()) {
+        dev.key_shadow.assign(KEY_MAX, 0);
+    }
+    uint8_t next = pressed ? 1 : 0;
+    if (dev.key_shadow[code] == next) {
+        return;
+    }
+    dev.key_shadow[code] = next;
+    if (next) {
+        key_counts[code]++;
+    } else if (key_counts[code] > 0) {
+        key_counts[code]--;
+    }
+    keys[code] = key_counts[code] > 0;
+}
+
+void DeviceScanner::ResyncDeviceKeysLocked(DeviceHandle& dev) {
+    if (!dev.keyboard_capable) {
+        return;
+    }
+    unsigned long key_bits[NBITS(KEY_MAX)] = {0};
+    if (ioctl(dev.fd, EVIOCGKEY(sizeof(key_bits)), key_bits) < 0) {
+        return;
+    }
+    for (int code = 0; code < KEY_MAX; ++code) {
+        SetKeyLocked(dev, code, test_bit(code, key_bits));
+    }
 }
 
-void DeviceScanner::HandleEnumeration(std::vector<std::string>&& nodes, bool force) {
-    RefreshDevices(force, std::move(nodes));
+void DeviceScanner::HandleEnumeration(DeviceEnumerator::Update&& update) {
+    if (update.full) {
+        RefreshDevices(update.force, std::move(update.nodes));
+        return;
+    }
+    if (!update.removed.empty()) {
+        // Drop unplugged nodes right away instead of waiting for Read() to hit ENODEV,
+        // so their held keys are released before the next report goes out.
+        std::lock_guard<std::mutex> lock(devices_mutex);
+        size_t before = devices.size();
+        for (const auto& path : update.removed) {
+            for (size_t i = 0; i < devices.size(); ++i) {
+                if (devices[i].path == path) {
+                    DropDeviceLocked(i);
+                    break;
+                }
+            }
+        }
+        if (devices.size() != before) {
+            LOG_DEBUG(kTag, "hotplug removed " << (before - devices.size()) << " device(s)");
+        }
+    }
+    if (!update.added.empty()) {
+        RefreshDevices(false, std::move(update.added));
+    }
 }
 
 void DeviceScanner::RefreshDevices(bool force, std::vector<std::string>&& nodes) {
@@ -336,8 +618,10 @@ void DeviceScanner::RefreshDevices(bool force, std::vector<std::string>&& nodes)
             continue;
         }
         devices.push_back(std::move(handle));
-        NotifyInputChanged();
+        PublishDeviceCountLocked();
         DeviceHandle& new_dev = devices.back();
+        WatchDeviceLocked(new_dev);
+        NotifyInputChanged();
         if (new_dev.keyboard_capable) {
             resync_pending = true;
         }
@@ -365,6 +649,8 @@ void DeviceScanner::EnsureManualDevice(const std::string& path, bool want_keyboa
         DeviceHandle* existing = FindDeviceLocked(path);
         if (existing) {
             existing->manual = true;
+            bool widened = (want_keyboard && !existing->keyboard_capable) ||
+                           (want_mouse && !existing->mouse_capable);
             if (want_keyboard && !existing->keyboard_capable) {
                 existing->keyboard_capable = true;
                 resync_pending = true;
@@ -372,6 +658,9 @@ void DeviceScanner::EnsureManualDevice(const std::string& path, bool want_keyboa
             if (want_mouse) {
                 existing->mouse_capable = true;
             }
+            if (widened) {
+                InstallEventMaskLocked(*existing);
+            }
             return;
         }
     }
@@ -392,13 +681,17 @@ void DeviceScanner::EnsureManualDevice(const std::string& path, bool want_keyboa
     handle.keyboard_capable = want_keyboard;
     handle.mouse_capable = want_mouse;
     handle.last_active = std::chrono::steady_clock::now();
+    handle.monotonic_time = UseMonotonicTimestamps(fd);
 
     std::lock_guard<std::mutex> lock(devices_mutex);
     if (FindDeviceLocked(path)) {
         close(handle.fd);
         return;
     }
+    InstallEventMaskLocked(handle);
     devices.push_back(std::move(handle));
+    PublishDeviceCountLocked();
+    WatchDeviceLocked(devices.back());
     NotifyInputChanged();
     if (want_keyboard) {
         resync_pending = true;
@@ -414,10 +707,97 @@ DeviceScanner::DeviceHandle* DeviceScanner::FindDeviceLocked(const std::string&
     return nullptr;
 }
 
+void DeviceScanner::WatchDeviceLocked(DeviceHandle& dev) {
+    if (uring_ && dev.fd >= 0 && dev.ring_tag == 0 && !dev.ring_refused) {
+        ArmRingReadLocked(dev);
+        uring_->Submit();
+        return;
+    }
+    if (epoll_fd_ < 0 || dev.fd < 0) {
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = dev.fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, dev.fd, &ev) < 0) {
+        LOG_WARN(kTag, "epoll_ctl add " << dev.path << " failed: " << strerror(errno));
+    }
+}
+
+void DeviceScanner::ArmRingReadLocked(DeviceHandle& dev) {
+    if (dev.ring_tag == 0) {
+        dev.ring_tag = next_ring_tag_++;
+    }
+    uring_->PrepareReadMultishot(dev.fd, dev.ring_tag);
+}
+
+io::Backend DeviceScanner::SetIoBackend(io::Backend backend) {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    if (backend != io::Backend::kIoUring || uring_) {
+        return uring_ ? io::Backend::kIoUring : io::Backend::kEpoll;
+    }
+    auto ring = std::make_unique<io::Uring>();
+    if (!ring->Init(kRingEntries, kRingBuffers, kRingBufferSize)) {
+        LOG_WARN(kTag, "io_uring unavailable; reading input devices through epoll");
+        return io::Backend::kEpoll;
+    }
+    if (epoll_fd_ >= 0) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = ring->fd();
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, ring->fd(), &ev) < 0) {
+            LOG_WARN(kTag, "epoll_ctl add io_uring failed (" << strerror(errno) << "); staying on epoll");
+            return io::Backend::kEpoll;
+        }
+    }
+    uring_ = std::move(ring);
+    for (auto& dev : devices) {
+        if (dev.fd < 0) {
+            continue;
+        }
+        if (epoll_fd_ >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, dev.fd, nullptr);
+        }
+        ArmRingReadLocked(dev);
+    }
+    uring_->Submit();
+    LOG_INFO(kTag, "Reading input devices through io_uring multishot reads");
+    return io::Backend::kIoUring;
+}
+
+void DeviceScanner::SetMetricsLabels(const std::string& labels) {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    metrics_labels_ = labels;
+    devices_gauge_ = nullptr;
+}
+
+void DeviceScanner::PublishDeviceCountLocked() {
+    // Registered on first use so a labelled scanner never leaves an unlabelled series.
+    if (!devices_gauge_) {
+        devices_gauge_ = &metrics::DefaultRegistry().GetGauge(
+                metrics::Labeled("wheel_scanner_devices", metrics_labels_), "Open keyboard/mouse event nodes");
+    }
+    devices_gauge_->Set(static_cast<int64_t>(devices.size()));
+}
+
+void DeviceScanner::DropDeviceLocked(size_t index) {
+    CloseDevice(devices[index]);
+    devices.erase(devices.begin() + index);
+    PublishDeviceCountLocked();
+}
+
 void DeviceScanner::CloseDevice(DeviceHandle& dev) {
     ReleaseDeviceKeys(dev);
     dev.grabbed = false;
     if (dev.fd >= 0) {
+        if (dev.ring_tag != 0 && uring_) {
+            // The ring holds its own file reference; cancel so close() releases the node.
+            uring_->PrepareCancel(dev.ring_tag, kRingCancelTag);
+            uring_->Submit();
+            dev.ring_tag = 0;
+        } else if (epoll_fd_ >= 0) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, dev.fd, nullptr);
+        }
         close(dev.fd);
         dev.fd = -1;
         NotifyInputChanged();
@@ -436,6 +816,7 @@ void DeviceScanner::ReleaseDeviceKeys(DeviceHandle& dev) {
         if (code < KEY_MAX && key_counts[code] > 0) {
             key_counts[code]--;
             keys[code] = key_counts[code] > 0;
+            keys_released_ = true;
         }
     }
 }
@@ -465,6 +846,7 @@ bool DeviceScanner::BuildAutoDeviceHandle(const std::string& path,
     candidate.path = path;
     candidate.manual = false;
     candidate.last_active = std::chrono::steady_clock::now();
+    candidate.monotonic_time = UseMonotonicTimestamps(fd);
 
     if (want_keyboard) {
         candidate.keyboard_capable = DeviceSupportsKeyboard(fd);
@@ -478,10 +860,70 @@ bool DeviceScanner::BuildAutoDeviceHandle(const std::string& path,
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(devices_mutex);
+        InstallEventMaskLocked(candidate);
+    }
     out_handle = std::move(candidate);
     return true;
 }
 
+void DeviceScanner::SetKeyFilter(const std::vector<int>& keys) {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    filter_keys_.clear();
+    for (int code : keys) {
+        if (code > 0 && code < KEY_MAX) {
+            filter_keys_.push_back(code);
+        }
+    }
+    if (!filter_keys_.empty()) {
+        // CheckToggle() watches these regardless of the binding table.
+        filter_keys_.insert(filter_keys_.end(), {KEY_LEFTCTRL, KEY_RIGHTCTRL, KEY_M});
+    }
+    for (const auto& dev : devices) {
+        InstallEventMaskLocked(dev);
+    }
+}
+
+// Masks are per open file, so other readers of the node (the desktop, when the
+// device is not grabbed) still see everything. Masking EV_SYN selects event types;
+// the kernel also drops a SYN_REPORT whose packet was filtered empty, so e.g. a
+// pure REL_Y mouse packet causes no wakeup at all.
+void DeviceScanner::InstallEventMaskLocked(const DeviceHandle& dev) {
+    if (dev.fd < 0 || filter_keys_.empty()) {
+        return;
+    }
+    unsigned long type_bits[NBITS(EV_CNT)] = {0};
+    unsigned long key_bits[NBITS(KEY_CNT)] = {0};
+    unsigned long rel_bits[NBITS(REL_CNT)] = {0};
+    type_bits[LONG(EV_SYN)] |= BIT(EV_SYN);
+    if (dev.keyboard_capable) {
+        type_bits[LONG(EV_KEY)] |= BIT(EV_KEY);
+        for (int code : filter_keys_) {
+            key_bits[LONG(code)] |= BIT(code);
+        }
+    }
+    if (dev.mouse_capable) {
+        type_bits[LONG(EV_REL)] |= BIT(EV_REL);
+        rel_bits[LONG(REL_X)] |= BIT(REL_X);
+    }
+
+    auto set_mask = [&](unsigned type, const unsigned long* bits, size_t size) {
+        struct input_mask mask {};
+        mask.type = type;
+        mask.codes_size = static_cast<uint32_t>(size);
+        mask.codes_ptr = reinterpret_cast<uintptr_t>(bits);
+        return ioctl(dev.fd, EVIOCSMASK, &mask) == 0;
+    };
+    // Code masks first, so the type mask never opens a window with unfiltered codes.
+    bool ok = set_mask(EV_KEY, key_bits, sizeof(key_bits)) && set_mask(EV_REL, rel_bits, sizeof(rel_bits)) &&
+              set_mask(EV_SYN, type_bits, sizeof(type_bits));
+    if (!ok) {
+        LOG_DEBUG(kTag, "EVIOCSMASK on " << dev.path << " failed (" << strerror(errno)
+                                         << "); reading unfiltered");
+    }
+}
+
 void DeviceScanner::RemoveAutoDevicesLocked() {
     for (size_t i = 0; i < devices.size();) {
         if (!devices[i].manual) {
@@ -491,6 +933,7 @@ void DeviceScanner::RemoveAutoDevicesLocked() {
             ++i;
         }
     }
+    PublishDeviceCountLocked();
 }
 
 void DeviceScanner::SignalWakeFd() const {
@@ -545,6 +988,12 @@ bool DeviceScanner::WantsMouseAuto() const {
 
 bool DeviceScanner::CheckToggle() {
     std::lock_guard<std::mutex> lock(devices_mutex);
+    bool toggled = toggle_latched_;
+    toggle_latched_ = false;
+    return toggled;
+}
+
+bool DeviceScanner::UpdateToggleLocked() {
     bool ctrl = keys[KEY_LEFTCTRL] || keys[KEY_RIGHTCTRL];
     bool m = keys[KEY_M];
     bool combo_active = ctrl && m;
@@ -712,6 +1161,16 @@ bool DeviceScanner::HasRequiredDevices() const {
     return HasRequiredDevicesLocked();
 }
 
+bool DeviceScanner::HasDevice(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(devices_mutex);
+    for (const auto& dev : devices) {
+        if (dev.fd >= 0 && dev.path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool DeviceScanner::NeedsKeyboard() const {
     return true;
 }
@@ -720,15 +1179,6 @@ bool DeviceScanner::NeedsMouse() const {
     return true;
 }
 
-bool DeviceScanner::HasOpenDevicesLocked() const {
-    for (const auto& dev : devices) {
-        if (dev.fd >= 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
 bool DeviceScanner::HasGrabbedKeyboardLocked() const {
     for (const auto& dev : devices) {
         if (dev.keyboard_capable && dev.grabbed) {
@@ -3,14 +3,20 @@
 #define DEVICE_SCANNER_H
 
 #include <linux/input.h>
+#include <sys/epoll.h>
+#include <array>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 #include "device_enumerator.h"
+#include "../io/uring.h"
+#include "../metrics/metrics.h"
 
 class DeviceScanner {
     // Event-driven additions
@@ -19,6 +25,9 @@ public:
     std::mutex input_mutex;
     void NotifyInputChanged();
     void Read();
+    // Blocks until an open device or the wake eventfd is readable. The ready set is
+    // kept for the following Read(), which drains only those devices; both must be
+    // called from the same (reader) thread.
     bool WaitForEvents(int timeout_ms);
 public:
     DeviceScanner();
@@ -29,10 +38,26 @@ public:
     bool DiscoverKeyboard(const std::string& device_path = "");
     bool DiscoverMouse(const std::string& device_path = "");
     
-    // Read events from keyboard and mouse
+    // One SYN_REPORT packet as applied by Read(). Handed to the callback with the
+    // scanner lock held: read key state through `keys`, never call back into the scanner.
+    struct Packet {
+        const bool* keys = nullptr;  // aggregated key state after this packet, KEY_MAX entries
+        int mouse_dx = 0;            // REL_X carried by this packet
+        bool toggle = false;         // this packet completed a Ctrl+M toggle
+        // CLOCK_MONOTONIC (= steady_clock) ns of the SYN_REPORT as stamped by the kernel,
+        // or the time it was read for devices that refused EVIOCSCLOCKID.
+        int64_t time_ns = 0;
+    };
+    using PacketCallback = std::function<void(const Packet&)>;
+
+    // Read events from keyboard and mouse. Packets from all ready devices are applied
+    // one SYN_REPORT at a time in kernel timestamp order; the callback form sees the
+    // state after each one, so a press and release read in the same batch stay visible.
     void Read(int& mouse_dx);
+    void Read(const PacketCallback& on_packet);
     
-    // Check for Ctrl+M toggle (edge detection)
+    // Check for Ctrl+M toggle (edge detection). Reports a toggle completed by any
+    // packet applied through Read(int&) since the last call.
     bool CheckToggle();
     
     // Grab/ungrab devices for exclusive access. Returns true if all required devices are grabbed.
@@ -41,12 +66,29 @@ public:
     // Rebuild aggregated key state by querying each keyboard device directly
     void ResyncKeyStates();
 
+    // Restrict what the kernel delivers to EV_KEY for `keys` (plus the Ctrl+M toggle)
+    // and EV_REL/REL_X, via EVIOCSMASK on every open and future device. Everything
+    // else is discarded before it reaches this process. An empty list leaves devices
+    // opened afterwards unfiltered.
+    void SetKeyFilter(const std::vector<int>& keys);
+
+    // kIoUring keeps a multishot read posted on every open device, so a Read() after
+    // a wakeup copies events out of ring buffers without a read() per device; the
+    // wait is one epoll_wait on the ring fd. Returns the backend in effect, which is
+    // kEpoll when io_uring cannot be set up. Switching back to kEpoll is not supported.
+    io::Backend SetIoBackend(io::Backend backend);
+
+    // Prometheus labels (e.g. wheel="1") for this scanner's gauges, so scanners of
+    // different wheels export separate series. Call before any device is opened.
+    void SetMetricsLabels(const std::string& labels);
+
     // Check if a key is currently pressed
     bool IsKeyPressed(int keycode) const;
     bool HasGrabbedKeyboard() const;
     bool HasGrabbedMouse() const;
     bool AllRequiredGrabbed() const;
     bool HasRequiredDevices() const;
+    bool HasDevice(const std::string& path) const;
 
 private:
     struct DeviceHandle {
@@ -58,7 +100,18 @@ private:
         bool grabbed = false;
         std::chrono::steady_clock::time_point last_active;
         std::vector<uint8_t> key_shadow;
+        // Events read but not applied yet. Complete packets are consumed from `cursor`;
+        // a trailing partial packet waits here for its SYN_REPORT.
+        std::vector<input_event> pending;
+        size_t cursor = 0;
+        size_t packet_end = kNoPacket;  // index of the SYN_REPORT closing the next packet, if any
+        bool lost = false;      // read failed; dropped once its complete packets are applied
+        bool monotonic_time = false;  // EVIOCSCLOCKID(CLOCK_MONOTONIC) accepted
+        int64_t fill_ns = 0;          // when `pending` was last filled (fallback timestamp)
+        uint64_t ring_tag = 0;        // user_data of its multishot read; 0 = read through epoll
+        bool ring_refused = false;    // the ring could not read this node; stay on epoll
     };
+    static constexpr size_t kNoPacket = static_cast<size_t>(-1);
 
     std::vector<DeviceHandle> devices;
     mutable std::mutex devices_mutex;
@@ -73,15 +126,43 @@ private:
     bool keys[KEY_MAX];
     int key_counts[KEY_MAX];
     bool prev_toggle;
+    bool toggle_latched_;
+    // A closed device released held keys; the next Read() publishes the new state.
+    bool keys_released_;
+    std::string metrics_labels_;     // guarded by devices_mutex
+    metrics::Gauge* devices_gauge_;  // guarded by devices_mutex; null until first published
     int wake_event_fd_;
+    std::vector<int> filter_keys_;  // guarded by devices_mutex; empty = unfiltered
+    // Persistent interest set: devices are added/removed as they are opened/closed,
+    // so a wait costs one epoll_wait and no allocation.
+    static constexpr int kMaxReadyEvents = 64;
+    int epoll_fd_;
+    std::array<epoll_event, kMaxReadyEvents> ready_events_;
+    int ready_count_;
+    bool ready_valid_;  // false: Read() has no ready set and drains every device
+    std::unique_ptr<io::Uring> uring_;  // guarded by devices_mutex; null = epoll backend
+    uint64_t next_ring_tag_;
     
     void RequestScan(bool force);
-    void HandleEnumeration(std::vector<std::string>&& nodes, bool force);
+    void HandleEnumeration(DeviceEnumerator::Update&& update);
     void RefreshDevices(bool force, std::vector<std::string>&& nodes);
     void EnsureManualDevice(const std::string& path, bool want_keyboard, bool want_mouse);
     void CloseDevice(DeviceHandle& dev);
+    void WatchDeviceLocked(DeviceHandle& dev);
+    void ArmRingReadLocked(DeviceHandle& dev);
+    void ReapRingLocked();
+    void InstallEventMaskLocked(const DeviceHandle& dev);
+    void DropDeviceLocked(size_t index);
+    void PublishDeviceCountLocked();
     DeviceHandle* FindDeviceLocked(const std::string& path);
-    bool DrainDevice(DeviceHandle& dev, int& mouse_dx);
+    void ReadPackets(const PacketCallback& on_packet, bool consume_toggle);
+    bool FillDevice(DeviceHandle& dev);
+    void FindPacketEndLocked(DeviceHandle& dev);
+    static int64_t PacketTimeNs(const DeviceHandle& dev);
+    void ApplyPacketLocked(DeviceHandle& dev, Packet& packet);
+    void SetKeyLocked(DeviceHandle& dev, int code, bool pressed);
+    void ResyncDeviceKeysLocked(DeviceHandle& dev);
+    bool UpdateToggleLocked();
     void ReleaseDeviceKeys(DeviceHandle& dev);
     bool ShouldLogAgain(std::chrono::steady_clock::time_point& last_log);
     bool WantsKeyboardAuto() const;
@@ -91,7 +172,6 @@ private:
     bool HasGrabbedKeyboardLocked() const;
     bool HasGrabbedMouseLocked() const;
     bool AllRequiredGrabbedLocked() const;
-    bool HasOpenDevicesLocked() const;
     bool HasRequiredDevicesLocked() const;
     bool BuildAutoDeviceHandle(const std::string& path,
                                bool want_keyboard,
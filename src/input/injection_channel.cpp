@@ -0,0 +1,328 @@
+#include "injection_channel.h"
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../logging/logger.h"
+#include "../metrics/metrics.h"
+
+namespace inject {
+namespace {
+constexpr const char* kTag = "inject";
+constexpr size_t kRingBytes = sizeof(LaneRing);
+
+long Futex(std::atomic<uint32_t>* word, int op, uint32_t value, const struct timespec* timeout) {
+    // Shared (not FUTEX_PRIVATE_FLAG): the producer lives in another process.
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+std::string Trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+bool ProcessAlive(uint32_t pid) {
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+}
+
+metrics::Counter& CorruptLaneResets() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_inject_lane_resets_total", "Injection lanes skipped to head after an impossible head counter");
+    return counter;
+}
+}  // namespace
+
+bool FiniteFloats(const Message& message) {
+    return std::isfinite(message.steering) && std::isfinite(message.steering_delta);
+}
+
+bool ParseLaneConfigs(const std::string& text, std::vector<LaneConfig>& lanes, std::string& error) {
+    std::vector<LaneConfig> parsed;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        std::string item = Trim(text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos));
+        pos = comma == std::string::npos ? text.size() + 1 : comma + 1;
+        if (item.empty()) {
+            continue;
+        }
+        LaneConfig lane;
+        lane.priority = 1;
+        size_t colon = item.find(':');
+        lane.name = Trim(item.substr(0, colon));
+        if (colon != std::string::npos) {
+            try {
+                lane.priority = std::stoi(item.substr(colon + 1));
+            } catch (...) {
+                error = "bad priority in '" + item + "'";
+                return false;
+            }
+        }
+        if (lane.name.empty() || lane.name.size() >= kLaneNameSize) {
+            error = "lane name must be 1-" + std::to_string(kLaneNameSize - 1) + " characters";
+            return false;
+        }
+        for (const auto& existing : parsed) {
+            if (existing.name == lane.name) {
+                error = "duplicate lane '" + lane.name + "'";
+                return false;
+            }
+        }
+        parsed.push_back(lane);
+    }
+    if (parsed.size() > kMaxLanes) {
+        error = "at most " + std::to_string(kMaxLanes) + " lanes";
+        return false;
+    }
+    lanes = std::move(parsed);
+    return true;
+}
+
+Channel::Channel() : header_(nullptr), map_size_(0) {}
+
+Channel::~Channel() {
+    Close();
+}
+
+bool Channel::Create(const std::string& name, const std::vector<LaneConfig>& lanes) {
+    Close();
+    if (lanes.empty() || lanes.size() > kMaxLanes) {
+        LOG_ERROR(kTag, "Injection segment needs 1-" << kMaxLanes << " lanes");
+        return false;
+    }
+    const size_t lane_bytes = kRingBytes + kLaneCapacity * sizeof(Message);
+    const size_t size = sizeof(Header) + lanes.size() * lane_bytes;
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0660);
+    if (fd < 0) {
+        LOG_ERROR(kTag, "shm_open(" << name << ") failed: " << std::strerror(errno));
+        return false;
+    }
+    fchmod(fd, 0660);
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        LOG_ERROR(kTag, "Cannot size " << name << ": " << std::strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOG_ERROR(kTag, "Cannot map " << name << ": " << std::strerror(errno));
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    header_ = static_cast<Header*>(map);
+    header_->version = kVersion;
+    header_->message_size = sizeof(Message);
+    header_->lane_count = static_cast<uint32_t>(lanes.size());
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        LaneInfo& info = header_->lanes[i];
+        std::strncpy(info.name, lanes[i].name.c_str(), kLaneNameSize - 1);
+        info.priority = lanes[i].priority;
+        info.offset = static_cast<uint32_t>(sizeof(Header) + i * lane_bytes);
+        info.capacity = kLaneCapacity;
+
+        uint8_t* ring = static_cast<uint8_t*>(map) + info.offset;
+        lanes_.push_back({reinterpret_cast<LaneRing*>(ring), reinterpret_cast<Message*>(ring + kRingBytes),
+                          lanes[i].priority, lanes[i].name});
+    }
+    // Producers check the magic last, so they never see a half-built lane table.
+    std::atomic_thread_fence(std::memory_order_release);
+    reinterpret_cast<std::atomic<uint32_t>*>(&header_->magic)->store(kMagic, std::memory_order_release);
+
+    name_ = name;
+    map_size_ = size;
+    LOG_INFO(kTag, "Accepting injected input on /dev/shm" << name_ << " (" << lanes.size() << " lanes)");
+    return true;
+}
+
+void Channel::Close() {
+    if (!header_) {
+        return;
+    }
+    munmap(header_, map_size_);
+    shm_unlink(name_.c_str());
+    header_ = nullptr;
+    map_size_ = 0;
+    lanes_.clear();
+}
+
+bool Channel::Pop(size_t lane, Message& out) {
+    LaneRing* ring = lanes_[lane].ring;
+    const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    if (head - tail > kLaneCapacity) {
+        LOG_WARN(kTag, "Lane '" << lanes_[lane].name << "' has an impossible head; dropping its backlog");
+        CorruptLaneResets().Increment();
+        ring->tail.store(head, std::memory_order_release);
+        return false;
+    }
+    out = lanes_[lane].slots[tail & (kLaneCapacity - 1)];
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool Channel::AnyPending() const {
+    for (const Lane& lane : lanes_) {
+        if (lane.ring->head.load(std::memory_order_seq_cst) != lane.ring->tail.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Channel::Wait(int timeout_ms) {
+    if (!header_) {
+        return;
+    }
+    // Announce the sleep before the final check; a producer that pushes after the
+    // check either sees consumer_waiting and wakes us or changes the doorbell first.
+    const uint32_t doorbell = header_->doorbell.load(std::memory_order_seq_cst);
+    header_->consumer_waiting.store(1, std::memory_order_seq_cst);
+    if (!AnyPending()) {
+        struct timespec timeout;
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+        Futex(&header_->doorbell, FUTEX_WAIT, doorbell, timeout_ms >= 0 ? &timeout : nullptr);
+    }
+    header_->consumer_waiting.store(0, std::memory_order_relaxed);
+}
+
+void Channel::Wake() {
+    if (!header_) {
+        return;
+    }
+    header_->doorbell.fetch_add(1, std::memory_order_seq_cst);
+    Futex(&header_->doorbell, FUTEX_WAKE, INT_MAX, nullptr);
+}
+
+Producer::Producer()
+        : header_(nullptr), ring_(nullptr), slots_(nullptr), mask_(0), lane_(0), map_size_(0), head_(0) {}
+
+Producer::~Producer() {
+    Close();
+}
+
+bool Producer::Open(const std::string& name, const std::string& lane, std::string& error) {
+    Close();
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        error = "shm_open(" + name + "): " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        error = name + " is too small for an injection header";
+        close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        error = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    Header* header = static_cast<Header*>(map);
+    const uint32_t magic =
+        reinterpret_cast<std::atomic<uint32_t>*>(&header->magic)->load(std::memory_order_acquire);
+    if (magic != kMagic || header->version != kVersion || header->message_size != sizeof(Message) ||
+        header->lane_count > kMaxLanes) {
+        error = name + " is not a version " + std::to_string(kVersion) + " injection segment";
+        munmap(map, size);
+        return false;
+    }
+    size_t index = header->lane_count;
+    for (size_t i = 0; i < header->lane_count; ++i) {
+        if (lane == header->lanes[i].name) {
+            index = i;
+            break;
+        }
+    }
+    if (index == header->lane_count) {
+        error = "no lane '" + lane + "' in " + name;
+        munmap(map, size);
+        return false;
+    }
+    LaneInfo& info = header->lanes[index];
+    const uint32_t capacity = info.capacity;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        info.offset + kRingBytes + static_cast<size_t>(capacity) * sizeof(Message) > size) {
+        error = "lane '" + lane + "' is malformed";
+        munmap(map, size);
+        return false;
+    }
+
+    // One producer per lane; a claim left behind by a dead process is taken over.
+    const uint32_t self = static_cast<uint32_t>(getpid());
+    uint32_t owner = 0;
+    if (!info.producer_pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel) &&
+        (owner != self && (ProcessAlive(owner) ||
+                           !info.producer_pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)))) {
+        error = "lane '" + lane + "' is in use by pid " + std::to_string(owner);
+        munmap(map, size);
+        return false;
+    }
+
+    header_ = header;
+    ring_ = reinterpret_cast<LaneRing*>(static_cast<uint8_t*>(map) + info.offset);
+    slots_ = reinterpret_cast<Message*>(reinterpret_cast<uint8_t*>(ring_) + kRingBytes);
+    mask_ = capacity - 1;
+    lane_ = index;
+    map_size_ = size;
+    head_ = ring_->head.load(std::memory_order_acquire);
+    return true;
+}
+
+void Producer::Close() {
+    if (!header_) {
+        return;
+    }
+    uint32_t self = static_cast<uint32_t>(getpid());
+    header_->lanes[lane_].producer_pid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+    munmap(header_, map_size_);
+    header_ = nullptr;
+    ring_ = nullptr;
+    slots_ = nullptr;
+    map_size_ = 0;
+}
+
+bool Producer::Push(const Message& message) {
+    if (!header_) {
+        return false;
+    }
+    if (head_ - ring_->tail.load(std::memory_order_acquire) > mask_) {
+        return false;
+    }
+    slots_[head_ & mask_] = message;
+    ++head_;
+    ring_->head.store(head_, std::memory_order_seq_cst);
+    header_->doorbell.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->consumer_waiting.load(std::memory_order_seq_cst) != 0) {
+        Futex(&header_->doorbell, FUTEX_WAKE, 1, nullptr);
+    }
+    return true;
+}
+
+}  // namespace inject
@@ -0,0 +1,180 @@
+#ifndef INJECTION_CHANNEL_H
+#define INJECTION_CHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inject {
+
+// Input injected by external processes through a POSIX shared-memory segment
+// (/dev/shm/<name>) that the emulator creates. The segment holds one single-producer /
+// single-consumer ring ("lane") per configured source; each lane has a priority that
+// InputManager uses when several sources drive the same control.
+//
+// Layout (little-endian, offsets in bytes):
+//   [0, 320)                     Header, including kMaxLanes LaneInfo entries
+//   [LaneInfo.offset, +128)      LaneRing counters for that lane
+//   [LaneInfo.offset + 128, ...) LaneInfo.capacity Messages
+//
+// A push checks head - tail < capacity, writes slot head & (capacity - 1), stores
+// head + 1 (release), bumps Header.doorbell and FUTEX_WAKEs it only if
+// Header.consumer_waiting is set, so pushes cost no syscall while the emulator is
+// busy draining. Producer implements this.
+constexpr uint32_t kMagic = 0x4a4e4957;  // "WINJ"
+constexpr uint16_t kVersion = 1;
+constexpr size_t kMaxLanes = 8;
+constexpr size_t kLaneNameSize = 16;
+
+// Message::set / Message::release bits.
+enum Field : uint16_t {
+    kSteering = 1 << 0,       // absolute position in `steering`
+    kSteeringDelta = 1 << 1,  // relative move in `steering_delta`; never held
+    kThrottle = 1 << 2,
+    kBrake = 1 << 3,
+    kClutch = 1 << 4,
+    kDpad = 1 << 5,
+    kButtons = 1 << 6,        // buttons listed in `button_mask`
+};
+
+// A source holds every field it sets until it releases it (or, with [inject] hold_ms,
+// until it goes quiet that long). While held, the field follows the source's latest
+// value unless a higher-priority source holds it too.
+struct Message {
+    int64_t time_ns;          // sender CLOCK_MONOTONIC, 0 if unknown; feeds the latency histogram
+    uint16_t set;             // Field bits carried by this message
+    uint16_t release;         // Field bits handed back (kButtons: those in button_release)
+    float steering;           // -32768..32767 counts
+    float steering_delta;     // counts, added after any absolute position
+    uint32_t buttons;         // bit i = WheelButton i pressed, for bits in button_mask
+    uint32_t button_mask;
+    uint32_t button_release;
+    uint8_t throttle;         // 0-100
+    uint8_t brake;            // 0-100
+    uint8_t clutch;           // 0-100
+    int8_t dpad_x;            // -1, 0, 1
+    int8_t dpad_y;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(Message) == 40, "injection message layout is part of the shared format");
+
+// False if `steering` or `steering_delta` is NaN or infinite, whether or not the message
+// sets it. Such a message is dropped whole: one NaN would poison the steering model.
+bool FiniteFloats(const Message& message);
+
+struct LaneInfo {
+    char name[kLaneNameSize];  // NUL-terminated
+    int32_t priority;
+    uint32_t offset;           // of the lane's LaneRing from the segment start
+    uint32_t capacity;         // messages, power of two
+    std::atomic<uint32_t> producer_pid;  // claimed by Producer::Open, 0 when free
+};
+static_assert(sizeof(LaneInfo) == 32, "lane descriptor layout is part of the shared format");
+
+struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t message_size;     // sizeof(Message)
+    uint32_t lane_count;
+    std::atomic<uint32_t> doorbell;          // futex word, bumped after every push
+    std::atomic<uint32_t> consumer_waiting;  // nonzero while the emulator sleeps on it
+    uint8_t reserved[44];
+    LaneInfo lanes[kMaxLanes];
+};
+static_assert(sizeof(Header) == 320, "header layout is part of the shared format");
+static_assert(offsetof(Header, lanes) == 64, "lane table starts on the second cache line");
+
+struct LaneRing {
+    alignas(64) std::atomic<uint64_t> head;  // messages pushed (producer)
+    alignas(64) std::atomic<uint64_t> tail;  // messages popped (emulator)
+};
+static_assert(sizeof(LaneRing) == 128, "head and tail sit on separate cache lines");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+struct LaneConfig {
+    std::string name;
+    int priority = 0;
+};
+
+// Parses "name:priority, name:priority" ([inject] sources). Keyboard/mouse input has
+// priority 0; a lane without ":priority" gets 1 so it overrides them.
+bool ParseLaneConfigs(const std::string& text, std::vector<LaneConfig>& lanes, std::string& error);
+
+// Emulator side: creates the segment and drains the lanes. Pop/Wait must be called
+// from one thread; Wake may be called from any. Producers map the segment read-write,
+// so the lane table is copied out at Create() and never read back; only the ring
+// counters and messages are taken from shared memory.
+class Channel {
+public:
+    static constexpr uint32_t kLaneCapacity = 1024;
+
+    Channel();
+    ~Channel();
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // Any existing segment with that name is replaced.
+    bool Create(const std::string& name, const std::vector<LaneConfig>& lanes);
+    void Close();  // unlinks the segment
+    bool is_open() const { return header_ != nullptr; }
+
+    size_t lane_count() const { return lanes_.size(); }
+    int lane_priority(size_t lane) const { return lanes_[lane].priority; }
+    const char* lane_name(size_t lane) const { return lanes_[lane].name.c_str(); }
+
+    // A head more than kLaneCapacity ahead of the tail (or behind it) means the producer
+    // corrupted its counter; the lane is skipped to head and counted, not drained.
+    bool Pop(size_t lane, Message& out);
+    // Sleeps on the doorbell until a producer pushes, Wake() is called or `timeout_ms`
+    // passes (-1 waits forever). Returns at once if any lane already has messages.
+    void Wait(int timeout_ms);
+    void Wake();
+
+private:
+    struct Lane {
+        LaneRing* ring;
+        Message* slots;
+        int priority;
+        std::string name;
+    };
+
+    bool AnyPending() const;
+
+    std::string name_;
+    Header* header_;
+    size_t map_size_;
+    std::vector<Lane> lanes_;
+};
+
+// External-process side of one lane. Not thread-safe; one Producer per lane.
+class Producer {
+public:
+    Producer();
+    ~Producer();
+
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
+
+    // Claims `lane` in segment `name`. Fails if another live process holds it.
+    bool Open(const std::string& name, const std::string& lane, std::string& error);
+    void Close();
+
+    // False when the lane is full (the emulator is not draining it).
+    bool Push(const Message& message);
+
+private:
+    Header* header_;
+    LaneRing* ring_;
+    Message* slots_;
+    uint32_t mask_;
+    size_t lane_;
+    size_t map_size_;
+    uint64_t head_;
+};
+
+}  // namespace inject
+
+#endif  // INJECTION_CHANNEL_H
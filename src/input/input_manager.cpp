@@ -1,27 +1,109 @@
 #include "input_manager.h"
 
-#include <linux/input-event-codes.h>
-
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <climits>
+#include <vector>
 
 #include "../logging/logger.h"
+#include "../metrics/metrics.h"
 
 extern std::atomic<bool> running;
 
 namespace {
 constexpr const char* kTag = "input_manager";
+
+template <typename Pressed>
+WheelInputState StateFromKeys(const KeyBindings& bindings, Pressed pressed) {
+    auto held = [&pressed](int key) { return key > 0 && pressed(key); };
+    WheelInputState snapshot;
+    snapshot.throttle = held(bindings.throttle) ? 100 : 0;
+    snapshot.brake = held(bindings.brake) ? 100 : 0;
+    snapshot.clutch = held(bindings.clutch) ? 100 : 0;
+
+    int right = held(bindings.dpad_right) ? 1 : 0;
+    int left = held(bindings.dpad_left) ? 1 : 0;
+    int down = held(bindings.dpad_down) ? 1 : 0;
+    int up = held(bindings.dpad_up) ? 1 : 0;
+    snapshot.dpad_x = static_cast<int8_t>(right - left);
+    snapshot.dpad_y = static_cast<int8_t>(down - up);
+
+    for (size_t i = 0; i < bindings.buttons.size(); ++i) {
+        snapshot.buttons[i] = held(bindings.buttons[i]) ? 1 : 0;
+    }
+    return snapshot;
+}
+
+bool SameState(const WheelInputState& a, const WheelInputState& b) {
+    return a.buttons == b.buttons && a.throttle == b.throttle && a.brake == b.brake && a.clutch == b.clutch &&
+           a.dpad_x == b.dpad_x && a.dpad_y == b.dpad_y;
+}
+
+metrics::Counter& FramesPublished() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_input_frames_published_total", "InputFrames published by the reader thread");
+    return counter;
+}
+
+metrics::Histogram& QueueDelay() {
+    static metrics::Histogram& histogram = metrics::DefaultRegistry().GetHistogram(
+        "wheel_input_queue_delay_us", "Kernel event timestamp to reader processing, per SYN_REPORT packet",
+        "microseconds");
+    return histogram;
+}
+
+metrics::Counter& FramesCoalesced() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_input_frames_coalesced_total", "State edges merged into an older frame because the queue was full");
+    return counter;
+}
+
+metrics::Counter& InjectedMessages() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_inject_messages_total", "Injected messages applied, from shm lanes and UDP");
+    return counter;
+}
+
+metrics::Counter& InjectedRejected() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_inject_rejected_total", "Injected messages dropped for NaN/infinite steering fields");
+    return counter;
+}
+
+metrics::Histogram& InjectLatency() {
+    static metrics::Histogram& histogram = metrics::DefaultRegistry().GetHistogram(
+        "wheel_inject_latency_us", "Injected message sender timestamp to injector thread", "microseconds");
+    return histogram;
 }
 
-InputManager::InputManager() : reader_running_(false), frame_sequence_(0), consumed_sequence_(0) {
-    pending_frame_.timestamp = std::chrono::steady_clock::now();
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
+metrics::Counter& FramesConsumed() {
+    static metrics::Counter& counter = metrics::DefaultRegistry().GetCounter(
+        "wheel_input_frames_consumed_total", "InputFrames taken by WaitForFrame/TryGetFrame");
+    return counter;
+}
+}
+
+InputManager::InputManager()
+        : reader_running_(false),
+          frame_head_(0),
+          frame_count_(0),
+          bindings_(DefaultKeyBindings()),
+          remote_source_(-1),
+          steering_owner_(-1) {}
+
 InputManager::~InputManager() {
     Shutdown();
 }
 
 bool InputManager::Initialize(const std::string& keyboard_override, const std::string& mouse_override) {
+    device_scanner_.SetKeyFilter(BoundKeys(bindings_));
     if (!device_scanner_.DiscoverKeyboard(keyboard_override)) {
         LOG_ERROR(kTag, "Failed to discover keyboard " << keyboard_override);
         return false;
@@ -31,52 +113,118 @@ bool InputManager::Initialize(const std::string& keyboard_override, const std::s
         return false;
     }
 
-    current_state_ = BuildLogicalState();
-    pending_frame_.logical = current_state_;
-    pending_frame_.timestamp = std::chrono::steady_clock::now();
+    evdev_state_ = BuildLogicalState();
+    current_state_ = MergeSourcesLocked();
 
     reader_running_.store(true, std::memory_order_relaxed);
     reader_thread_ = std::thread(&InputManager::ReaderLoop, this);
+    if (injection_.is_open()) {
+        injector_thread_ = std::thread(&InputManager::InjectorLoop, this);
+    }
+    if (remote_.is_open()) {
+        remote_thread_ = std::thread(&InputManager::RemoteLoop, this);
+    }
     LOG_INFO(kTag, "Input manager initialized");
     return true;
 }
 
+io::Backend InputManager::SetIoBackend(io::Backend backend) {
+    return device_scanner_.SetIoBackend(backend);
+}
+
+void InputManager::SetKeyBindings(const KeyBindings& bindings) {
+    bindings_ = bindings;
+}
+
+void InputManager::SetMetricsLabels(const std::string& labels) {
+    device_scanner_.SetMetricsLabels(labels);
+}
+
+bool InputManager::EnableInjection(const std::string& shm_name, const std::vector<inject::LaneConfig>& lanes,
+                                   int hold_ms) {
+    if (!injection_.Create(shm_name, lanes)) {
+        return false;
+    }
+    // Lanes take the first indices so lane numbers and source numbers agree.
+    std::vector<InjectedSource> lanes_sources(injection_.lane_count());
+    for (size_t lane = 0; lane < lanes_sources.size(); ++lane) {
+        lanes_sources[lane].priority = injection_.lane_priority(lane);
+        lanes_sources[lane].hold_ns = static_cast<int64_t>(hold_ms) * 1000000;
+    }
+    injected_.insert(injected_.begin(), lanes_sources.begin(), lanes_sources.end());
+    if (remote_source_ >= 0) {
+        remote_source_ += static_cast<int>(lanes_sources.size());
+    }
+    return true;
+}
+
+bool InputManager::EnableRemote(const std::string& address, int priority, int hold_ms) {
+    std::string error;
+    if (!remote_.Open(address, error)) {
+        LOG_ERROR(kTag, "Remote input disabled: " << error);
+        return false;
+    }
+    InjectedSource source;
+    source.priority = priority;
+    source.hold_ns = static_cast<int64_t>(hold_ms) * 1000000;
+    injected_.push_back(source);
+    remote_source_ = static_cast<int>(injected_.size()) - 1;
+    LOG_INFO(kTag, "Accepting remote input on UDP " << address << " (port " << remote_.port() << ")");
+    return true;
+}
+
 void InputManager::Shutdown() {
     bool was_running = reader_running_.exchange(false);
     if (was_running) {
         device_scanner_.NotifyInputChanged();
+        injection_.Wake();
+        remote_.Wake();
     }
-    frame_cv_.notify_all();
+    NotifyFrameWaiters();
     if (reader_thread_.joinable()) {
         reader_thread_.join();
     }
+    if (injector_thread_.joinable()) {
+        injector_thread_.join();
+    }
+    if (remote_thread_.joinable()) {
+        remote_thread_.join();
+    }
+}
+
+void InputManager::SetFrameListener(std::function<void()> listener) {
+    frame_listener_ = std::move(listener);
+}
+
+void InputManager::NotifyFrameWaiters() {
+    frame_cv_.notify_all();
+    if (frame_listener_) {
+        frame_listener_();
+    }
 }
 
 bool InputManager::WaitForFrame(InputFrame& frame) {
     std::unique_lock<std::mutex> lock(frame_mutex_);
     frame_cv_.wait(lock, [this]() {
-        return consumed_sequence_ != frame_sequence_ || !reader_running_.load(std::memory_order_relaxed) ||
+        return frame_count_ > 0 || !reader_running_.load(std::memory_order_relaxed) ||
                !running.load(std::memory_order_relaxed);
     });
-    if (consumed_sequence_ == frame_sequence_) {
-        return false;
-    }
-    frame = pending_frame_;
-    pending_frame_.mouse_dx = 0;
-    pending_frame_.toggle_pressed = false;
-    consumed_sequence_ = frame_sequence_;
-    return true;
+    return PopFrameLocked(frame);
 }
 
 bool InputManager::TryGetFrame(InputFrame& frame) {
     std::lock_guard<std::mutex> lock(frame_mutex_);
-    if (consumed_sequence_ == frame_sequence_) {
+    return PopFrameLocked(frame);
+}
+
+bool InputManager::PopFrameLocked(InputFrame& frame) {
+    if (frame_count_ == 0) {
         return false;
     }
-    frame = pending_frame_;
-    pending_frame_.mouse_dx = 0;
-    pending_frame_.toggle_pressed = false;
-    consumed_sequence_ = frame_sequence_;
+    frame = frames_[frame_head_];
+    frame_head_ = (frame_head_ + 1) % kFrameQueueSize;
+    --frame_count_;
+    FramesConsumed().Increment();
     return true;
 }
 
@@ -91,7 +239,8 @@ bool InputManager::AllRequiredGrabbed() const {
 void InputManager::ResyncKeyStates() {
     device_scanner_.ResyncKeyStates();
     std::lock_guard<std::mutex> lock(frame_mutex_);
-    current_state_ = BuildLogicalState();
+    evdev_state_ = BuildLogicalState();
+    current_state_ = MergeSourcesLocked();
 }
 
 bool InputManager::DevicesReady() const {
@@ -104,95 +253,319 @@ WheelInputState InputManager::LatestLogicalState() const {
 }
 
 void InputManager::ReaderLoop() {
+    static metrics::Counter& wakeups = metrics::ThreadWakeups("input_reader");
     LOG_DEBUG(kTag, "Reader loop started");
+    const DeviceScanner::PacketCallback on_packet = [this](const DeviceScanner::Packet& packet) {
+        PublishPacketLocked(packet);
+    };
     while (reader_running_.load(std::memory_order_relaxed) && running.load(std::memory_order_relaxed)) {
         device_scanner_.WaitForEvents(-1);
-        int mouse_dx = 0;
-        device_scanner_.Read(mouse_dx);
-        bool toggle = device_scanner_.CheckToggle();
-        WheelInputState next_state = BuildLogicalState();
-        bool emit_frame = false;
+        wakeups.Increment();
+        size_t queued_before;
+        size_t queued_after;
         {
+            // Lock order: frame_mutex_, then the scanner's devices_mutex inside Read().
             std::lock_guard<std::mutex> lock(frame_mutex_);
-            emit_frame = ShouldEmitFrameLocked(mouse_dx, toggle, next_state);
-            if (emit_frame) {
-                current_state_ = next_state;
-                pending_frame_.logical = next_state;
-                pending_frame_.mouse_dx += mouse_dx;
-                pending_frame_.toggle_pressed = pending_frame_.toggle_pressed || toggle;
-                pending_frame_.timestamp = std::chrono::steady_clock::now();
-                ++frame_sequence_;
-            }
+            queued_before = frame_count_;
+            device_scanner_.Read(on_packet);
+            queued_after = frame_count_;
         }
-        if (!emit_frame) {
-            continue;
+        if (queued_after > queued_before) {
+            FramesPublished().Increment(queued_after - queued_before);
+        }
+        if (queued_after > 0) {
+            NotifyFrameWaiters();
         }
-        frame_cv_.notify_all();
     }
-    frame_cv_.notify_all();
+    NotifyFrameWaiters();
     LOG_DEBUG(kTag, "Reader loop stopped");
 }
 
-WheelInputState InputManager::BuildLogicalState() {
-    WheelInputState snapshot;
-    snapshot.throttle = device_scanner_.IsKeyPressed(KEY_W);
-    snapshot.brake = device_scanner_.IsKeyPressed(KEY_S);
-    snapshot.clutch = device_scanner_.IsKeyPressed(KEY_A);
-
-    int right = device_scanner_.IsKeyPressed(KEY_RIGHT) ? 1 : 0;
-    int left = device_scanner_.IsKeyPressed(KEY_LEFT) ? 1 : 0;
-    int down = device_scanner_.IsKeyPressed(KEY_DOWN) ? 1 : 0;
-    int up = device_scanner_.IsKeyPressed(KEY_UP) ? 1 : 0;
-    snapshot.dpad_x = static_cast<int8_t>(right - left);
-    snapshot.dpad_y = static_cast<int8_t>(down - up);
+void InputManager::InjectorLoop() {
+    static metrics::Counter& wakeups = metrics::ThreadWakeups("input_injector");
+    LOG_DEBUG(kTag, "Injector loop started");
+    inject::Message message;
+    while (reader_running_.load(std::memory_order_relaxed) && running.load(std::memory_order_relaxed)) {
+        int timeout_ms;
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            timeout_ms = HoldTimeoutMsLocked(SteadyNowNs());
+        }
+        injection_.Wait(timeout_ms);
+        wakeups.Increment();
+        size_t queued_before;
+        size_t queued_after;
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            queued_before = frame_count_;
+            const int64_t now_ns = SteadyNowNs();
+            for (size_t lane = 0; lane < injection_.lane_count(); ++lane) {
+                while (injection_.Pop(lane, message)) {
+                    if (message.time_ns > 0) {
+                        InjectLatency().Observe(
+                            static_cast<uint64_t>(std::max<int64_t>(now_ns - message.time_ns, 0) / 1000));
+                    }
+                    ApplyInjectedLocked(lane, message, now_ns);
+                }
+            }
+            ExpireInjectedLocked(now_ns);
+            queued_after = frame_count_;
+        }
+        if (queued_after > queued_before) {
+            FramesPublished().Increment(queued_after - queued_before);
+        }
+        if (queued_after > 0) {
+            NotifyFrameWaiters();
+        }
+    }
+    NotifyFrameWaiters();
+    LOG_DEBUG(kTag, "Injector loop stopped");
+}
+
+void InputManager::RemoteLoop() {
+    static metrics::Counter& wakeups = metrics::ThreadWakeups("input_remote");
+    LOG_DEBUG(kTag, "Remote loop started");
+    const size_t source = static_cast<size_t>(remote_source_);
+    while (reader_running_.load(std::memory_order_relaxed) && running.load(std::memory_order_relaxed)) {
+        int timeout_ms;
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            timeout_ms = HoldTimeoutMsLocked(SteadyNowNs());
+        }
+        remote_.Wait(timeout_ms);
+        wakeups.Increment();
+        size_t queued_before;
+        size_t queued_after;
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            queued_before = frame_count_;
+            const int64_t now_ns = SteadyNowNs();
+            remote_.Drain([&](const inject::Message& message) { ApplyInjectedLocked(source, message, now_ns); });
+            ExpireInjectedLocked(now_ns);
+            queued_after = frame_count_;
+        }
+        if (queued_after > queued_before) {
+            FramesPublished().Increment(queued_after - queued_before);
+        }
+        if (queued_after > 0) {
+            NotifyFrameWaiters();
+        }
+    }
+    NotifyFrameWaiters();
+    LOG_DEBUG(kTag, "Remote loop stopped");
+}
+
+int InputManager::HoldTimeoutMsLocked(int64_t now_ns) const {
+    int64_t earliest = INT64_MAX;
+    for (const auto& source : injected_) {
+        if (source.hold_ns > 0 && (source.held != 0 || source.buttons_held != 0)) {
+            earliest = std::min(earliest, source.last_message_ns + source.hold_ns);
+        }
+    }
+    if (earliest == INT64_MAX) {
+        return -1;
+    }
+    // Round up so the wake lands after the deadline rather than just before it.
+    return static_cast<int>(std::max<int64_t>(earliest - now_ns + 999999, 0) / 1000000);
+}
+
+void InputManager::ApplyInjectedLocked(size_t index, const inject::Message& message, int64_t now_ns) {
+    if (!inject::FiniteFloats(message)) {
+        InjectedRejected().Increment();
+        return;
+    }
+    InjectedMessages().Increment();
+    InjectedSource& source = injected_[index];
+    source.last_message_ns = now_ns;
+    source.held &= static_cast<uint16_t>(~message.release);
+    if (message.release & inject::kButtons) {
+        source.buttons_held &= ~message.button_release;
+    }
+    if (message.set & inject::kSteering) {
+        source.steering = std::clamp(message.steering, -32768.0f, 32767.0f);
+    }
+    if (message.set & inject::kThrottle) {
+        source.throttle = std::min<uint8_t>(message.throttle, 100);
+    }
+    if (message.set & inject::kBrake) {
+        source.brake = std::min<uint8_t>(message.brake, 100);
+    }
+    if (message.set & inject::kClutch) {
+        source.clutch = std::min<uint8_t>(message.clutch, 100);
+    }
+    if (message.set & inject::kDpad) {
+        source.dpad_x = static_cast<int8_t>(std::clamp<int>(message.dpad_x, -1, 1));
+        source.dpad_y = static_cast<int8_t>(std::clamp<int>(message.dpad_y, -1, 1));
+    }
+    if (message.set & inject::kButtons) {
+        source.buttons = (source.buttons & ~message.button_mask) | (message.buttons & message.button_mask);
+        source.buttons_held |= message.button_mask;
+    }
+    source.held |= message.set & (inject::kSteering | inject::kThrottle | inject::kBrake | inject::kClutch | inject::kDpad);
+
+    FrameUpdate update;
+    update.time_ns = message.time_ns > 0 ? message.time_ns : now_ns;
+    const int owner = SteeringOwnerLocked();
+    if ((message.set & inject::kSteering) && owner == static_cast<int>(index)) {
+        update.steering_set = true;
+        update.steering = source.steering;
+    }
+    // A delta from a lane below the absolute-steering holder would fight it; drop it.
+    if ((message.set & inject::kSteeringDelta) && (owner < 0 || source.priority >= injected_[owner].priority)) {
+        update.steering_delta = std::clamp(message.steering_delta, -65535.0f, 65535.0f);
+    }
+    PublishLocked(update);
+}
+
+void InputManager::ExpireInjectedLocked(int64_t now_ns) {
+    bool expired = false;
+    for (auto& source : injected_) {
+        if (source.hold_ns > 0 && (source.held != 0 || source.buttons_held != 0) &&
+            now_ns - source.last_message_ns >= source.hold_ns) {
+            source.held = 0;
+            source.buttons_held = 0;
+            expired = true;
+        }
+    }
+    if (expired) {
+        FrameUpdate update;
+        update.time_ns = now_ns;
+        PublishLocked(update);
+    }
+}
+
+// Highest-priority source holding absolute steering; the earlier source wins a tie.
+int InputManager::SteeringOwnerLocked() const {
+    int owner = -1;
+    for (size_t index = 0; index < injected_.size(); ++index) {
+        if ((injected_[index].held & inject::kSteering) &&
+            (owner < 0 || injected_[index].priority > injected_[owner].priority)) {
+            owner = static_cast<int>(index);
+        }
+    }
+    return owner;
+}
 
-    auto set_button = [&](WheelButton button, bool pressed) {
-        snapshot.buttons[static_cast<size_t>(button)] = pressed ? 1 : 0;
+// Each control follows its highest-priority holder. Keyboard bindings hold a control
+// at priority 0 while pressed and lose ties to injected sources; nothing held means released.
+WheelInputState InputManager::MergeSourcesLocked() const {
+    if (injected_.empty()) {
+        return evdev_state_;
+    }
+    auto pick = [this](uint16_t field, bool evdev_holds) -> const InjectedSource* {
+        const InjectedSource* best = nullptr;
+        for (const auto& source : injected_) {
+            if ((source.held & field) && (!best || source.priority > best->priority)) {
+                best = &source;
+            }
+        }
+        if (best && evdev_holds && best->priority < 0) {
+            return nullptr;
+        }
+        return best;
     };
 
-    set_button(WheelButton::South, device_scanner_.IsKeyPressed(KEY_Q));
-    set_button(WheelButton::East, device_scanner_.IsKeyPressed(KEY_E));
-    set_button(WheelButton::West, device_scanner_.IsKeyPressed(KEY_F));
-    set_button(WheelButton::North, device_scanner_.IsKeyPressed(KEY_G));
-    set_button(WheelButton::TL, device_scanner_.IsKeyPressed(KEY_H));
-    set_button(WheelButton::TR, device_scanner_.IsKeyPressed(KEY_R));
-    set_button(WheelButton::TL2, device_scanner_.IsKeyPressed(KEY_T));
-    set_button(WheelButton::TR2, device_scanner_.IsKeyPressed(KEY_Y));
-    set_button(WheelButton::Select, device_scanner_.IsKeyPressed(KEY_U));
-    set_button(WheelButton::Start, device_scanner_.IsKeyPressed(KEY_I));
-    set_button(WheelButton::ThumbL, device_scanner_.IsKeyPressed(KEY_O));
-    set_button(WheelButton::ThumbR, device_scanner_.IsKeyPressed(KEY_P));
-    set_button(WheelButton::Mode, device_scanner_.IsKeyPressed(KEY_1));
-    set_button(WheelButton::Dead, device_scanner_.IsKeyPressed(KEY_2));
-    set_button(WheelButton::TriggerHappy1, device_scanner_.IsKeyPressed(KEY_3));
-    set_button(WheelButton::TriggerHappy2, device_scanner_.IsKeyPressed(KEY_4));
-    set_button(WheelButton::TriggerHappy3, device_scanner_.IsKeyPressed(KEY_5));
-    set_button(WheelButton::TriggerHappy4, device_scanner_.IsKeyPressed(KEY_6));
-    set_button(WheelButton::TriggerHappy5, device_scanner_.IsKeyPressed(KEY_7));
-    set_button(WheelButton::TriggerHappy6, device_scanner_.IsKeyPressed(KEY_8));
-    set_button(WheelButton::TriggerHappy7, device_scanner_.IsKeyPressed(KEY_9));
-    set_button(WheelButton::TriggerHappy8, device_scanner_.IsKeyPressed(KEY_0));
-    set_button(WheelButton::TriggerHappy9, device_scanner_.IsKeyPressed(KEY_LEFTSHIFT));
-    set_button(WheelButton::TriggerHappy10, device_scanner_.IsKeyPressed(KEY_SPACE));
-    set_button(WheelButton::TriggerHappy11, device_scanner_.IsKeyPressed(KEY_TAB));
-    set_button(WheelButton::TriggerHappy12, device_scanner_.IsKeyPressed(KEY_ENTER));
-    return snapshot;
+    WheelInputState merged = evdev_state_;
+    if (const InjectedSource* source = pick(inject::kThrottle, evdev_state_.throttle != 0)) {
+        merged.throttle = source->throttle;
+    }
+    if (const InjectedSource* source = pick(inject::kBrake, evdev_state_.brake != 0)) {
+        merged.brake = source->brake;
+    }
+    if (const InjectedSource* source = pick(inject::kClutch, evdev_state_.clutch != 0)) {
+        merged.clutch = source->clutch;
+    }
+    if (const InjectedSource* source = pick(inject::kDpad, evdev_state_.dpad_x != 0 || evdev_state_.dpad_y != 0)) {
+        merged.dpad_x = source->dpad_x;
+        merged.dpad_y = source->dpad_y;
+    }
+    for (size_t i = 0; i < merged.buttons.size(); ++i) {
+        const uint32_t bit = 1u << i;
+        const InjectedSource* best = nullptr;
+        for (const auto& source : injected_) {
+            if ((source.buttons_held & bit) && (!best || source.priority > best->priority)) {
+                best = &source;
+            }
+        }
+        if (best && !(evdev_state_.buttons[i] && best->priority < 0)) {
+            merged.buttons[i] = (best->buttons & bit) ? 1 : 0;
+        }
+    }
+    return merged;
 }
 
-bool InputManager::ShouldEmitFrameLocked(int mouse_dx, bool toggle, const WheelInputState& next_state) const {
-    if (mouse_dx != 0 || toggle) {
-        return true;
+// Runs once per SYN_REPORT packet, in kernel timestamp order across devices.
+void InputManager::PublishPacketLocked(const DeviceScanner::Packet& packet) {
+    const int64_t now_ns = SteadyNowNs();
+    QueueDelay().Observe(static_cast<uint64_t>(std::max<int64_t>(now_ns - packet.time_ns, 0) / 1000));
+
+    evdev_state_ = StateFromKeys(bindings_, [&packet](int key) { return packet.keys[key]; });
+    FrameUpdate update;
+    update.toggle = packet.toggle;
+    update.time_ns = packet.time_ns;
+    // The mouse steers at priority 0 and, like the keys, loses ties to a source holding
+    // absolute steering.
+    if (steering_owner_ < 0 || injected_[steering_owner_].priority < 0) {
+        update.mouse_dx = packet.mouse_dx;
     }
-    if (next_state.buttons != current_state_.buttons) {
-        return true;
+    PublishLocked(update);
+}
+
+void InputManager::PublishLocked(FrameUpdate update) {
+    const int owner = SteeringOwnerLocked();
+    if (owner != steering_owner_) {
+        // Absolute steering changed hands: jump to the new holder's position. When the
+        // last holder lets go the wheel stays put and the mouse continues from there.
+        steering_owner_ = owner;
+        if (owner >= 0 && !update.steering_set) {
+            update.steering_set = true;
+            update.steering = injected_[owner].steering;
+        }
     }
-    if (next_state.throttle != current_state_.throttle ||
-        next_state.brake != current_state_.brake ||
-        next_state.clutch != current_state_.clutch) {
-        return true;
+
+    WheelInputState next_state = MergeSourcesLocked();
+    const bool edge = !SameState(next_state, current_state_) || update.toggle;
+    const bool motion = update.mouse_dx != 0 || update.steering_set || update.steering_delta != 0.0f;
+    if (!edge && !motion) {
+        return;
     }
-    if (next_state.dpad_x != current_state_.dpad_x || next_state.dpad_y != current_state_.dpad_y) {
-        return true;
+    current_state_ = next_state;
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool can_merge = frame_count_ > 0 && (!edge || frame_count_ == kFrameQueueSize);
+    if (can_merge) {
+        InputFrame& tail = frames_[(frame_head_ + frame_count_ - 1) % kFrameQueueSize];
+        if (edge) {
+            FramesCoalesced().Increment();
+        }
+        tail.logical = next_state;
+        if (update.steering_set) {
+            // An absolute position supersedes every relative move queued before it.
+            tail.mouse_dx = 0;
+            tail.steering_delta = 0.0f;
+            tail.steering_set = true;
+            tail.steering = update.steering;
+        }
+        tail.mouse_dx += update.mouse_dx;
+        tail.steering_delta += update.steering_delta;
+        tail.toggle_pressed = tail.toggle_pressed || update.toggle;
+        tail.timestamp = now;
+        tail.newest_event_ns = std::max(tail.newest_event_ns, update.time_ns);
+        return;
     }
-    return false;
+    InputFrame& frame = frames_[(frame_head_ + frame_count_) % kFrameQueueSize];
+    frame.logical = next_state;
+    frame.mouse_dx = update.mouse_dx;
+    frame.steering_set = update.steering_set;
+    frame.steering = update.steering;
+    frame.steering_delta = update.steering_delta;
+    frame.toggle_pressed = update.toggle;
+    frame.timestamp = now;
+    frame.oldest_event_ns = update.time_ns;
+    frame.newest_event_ns = update.time_ns;
+    ++frame_count_;
+}
+
+WheelInputState InputManager::BuildLogicalState() {
+    return StateFromKeys(bindings_, [this](int key) { return device_scanner_.IsKeyPressed(key); });
 }
@@ -1,14 +1,20 @@
 #ifndef INPUT_MANAGER_H
 #define INPUT_MANAGER_H
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "device_scanner.h"
+#include "injection_channel.h"
+#include "key_bindings.h"
+#include "remote_input.h"
 #include "wheel_input.h"
 
 class InputManager {
@@ -17,6 +23,24 @@ public:
     ~InputManager();
 
     bool Initialize(const std::string& keyboard_override, const std::string& mouse_override);
+    // See DeviceScanner::SetIoBackend; returns the backend in effect.
+    io::Backend SetIoBackend(io::Backend backend);
+    // Call before Initialize(). Replaces DefaultKeyBindings() for this manager's keyboard.
+    void SetKeyBindings(const KeyBindings& bindings);
+    // Call before Initialize(). See DeviceScanner::SetMetricsLabels.
+    void SetMetricsLabels(const std::string& labels);
+    // Call before Initialize(). Creates the injection segment `shm_name` with one lane
+    // per source and merges what external processes write there with keyboard/mouse
+    // input by priority. A source that sends nothing for `hold_ms` loses the controls
+    // it holds; 0 keeps them until released.
+    bool EnableInjection(const std::string& shm_name, const std::vector<inject::LaneConfig>& lanes, int hold_ms);
+    // Call before Initialize(). Accepts inject::RemotePacket datagrams on `address`
+    // (host:port) as one more source with `priority`, ranked after the shm lanes on ties.
+    bool EnableRemote(const std::string& address, int priority, int hold_ms);
+    // Call before Initialize(). Runs on the producing thread after frames are queued
+    // and when the reader stops, so one thread can wait on several managers and drain
+    // them with TryGetFrame().
+    void SetFrameListener(std::function<void()> listener);
     void Shutdown();
 
     bool WaitForFrame(InputFrame& frame);
@@ -30,19 +54,72 @@ public:
     WheelInputState LatestLogicalState() const;
 
 private:
+    // Frames waiting for WaitForFrame/TryGetFrame. Every state edge gets its own entry
+    // so a tap shorter than one consumer iteration is still seen; motion-only packets
+    // merge into the newest entry.
+    static constexpr size_t kFrameQueueSize = 64;
+
+    // What one evdev packet or injected message adds to the frame stream.
+    struct FrameUpdate {
+        int mouse_dx = 0;
+        bool toggle = false;
+        bool steering_set = false;
+        float steering = 0.0f;
+        float steering_delta = 0.0f;
+        int64_t time_ns = 0;
+    };
+
+    // Controls an injected source (shm lane or UDP) holds, as inject::Field bits, and
+    // their latest values. Guarded by frame_mutex_.
+    struct InjectedSource {
+        int priority = 0;
+        int64_t hold_ns = 0;  // release after this long without a message; 0 never
+        uint16_t held = 0;
+        uint32_t buttons_held = 0;
+        float steering = 0.0f;
+        uint8_t throttle = 0;
+        uint8_t brake = 0;
+        uint8_t clutch = 0;
+        int8_t dpad_x = 0;
+        int8_t dpad_y = 0;
+        uint32_t buttons = 0;
+        int64_t last_message_ns = 0;
+    };
+
     void ReaderLoop();
+    void InjectorLoop();
+    void RemoteLoop();
     WheelInputState BuildLogicalState();
-    bool ShouldEmitFrameLocked(int mouse_dx, bool toggle, const WheelInputState& next_state) const;
+    void PublishPacketLocked(const DeviceScanner::Packet& packet);
+    void ApplyInjectedLocked(size_t index, const inject::Message& message, int64_t now_ns);
+    void ExpireInjectedLocked(int64_t now_ns);
+    int HoldTimeoutMsLocked(int64_t now_ns) const;
+    int SteeringOwnerLocked() const;
+    WheelInputState MergeSourcesLocked() const;
+    void PublishLocked(FrameUpdate update);
+    bool PopFrameLocked(InputFrame& frame);
+    void NotifyFrameWaiters();
 
     DeviceScanner device_scanner_;
     std::thread reader_thread_;
     std::atomic<bool> reader_running_;
     mutable std::mutex frame_mutex_;
     std::condition_variable frame_cv_;
-    InputFrame pending_frame_;
-    WheelInputState current_state_;
-    uint64_t frame_sequence_;
-    uint64_t consumed_sequence_;
+    std::function<void()> frame_listener_;
+    std::array<InputFrame, kFrameQueueSize> frames_;
+    size_t frame_head_;   // oldest unconsumed frame
+    size_t frame_count_;
+    WheelInputState current_state_;  // merged state of every source, as last published
+    KeyBindings bindings_;
+    WheelInputState evdev_state_;    // keyboard bindings alone (priority 0)
+
+    inject::Channel injection_;
+    std::thread injector_thread_;
+    inject::RemoteReceiver remote_;
+    std::thread remote_thread_;
+    std::vector<InjectedSource> injected_;  // shm lanes by lane index, then the UDP source
+    int remote_source_;   // index of the UDP source in injected_, -1 without one
+    int steering_owner_;  // source holding absolute steering, -1 for the mouse
 };
 
 #endif  // INPUT_MANAGER_H
@@ -0,0 +1,123 @@
+#include "key_bindings.h"
+
+#include <linux/input-event-codes.h>
+
+namespace {
+
+struct KeyName {
+    const char* name;
+    int code;
+};
+
+#define KEY_NAME(code) {#code, code}
+// Keys a binding may name: the main block, modifiers, navigation, F-keys and keypad.
+constexpr KeyName kKeyNames[] = {
+    KEY_NAME(KEY_A), KEY_NAME(KEY_B), KEY_NAME(KEY_C), KEY_NAME(KEY_D), KEY_NAME(KEY_E),
+    KEY_NAME(KEY_F), KEY_NAME(KEY_G), KEY_NAME(KEY_H), KEY_NAME(KEY_I), KEY_NAME(KEY_J),
+    KEY_NAME(KEY_K), KEY_NAME(KEY_L), KEY_NAME(KEY_M), KEY_NAME(KEY_N), KEY_NAME(KEY_O),
+    KEY_NAME(KEY_P), KEY_NAME(KEY_Q), KEY_NAME(KEY_R), KEY_NAME(KEY_S), KEY_NAME(KEY_T),
+    KEY_NAME(KEY_U), KEY_NAME(KEY_V), KEY_NAME(KEY_W), KEY_NAME(KEY_X), KEY_NAME(KEY_Y),
+    KEY_NAME(KEY_Z),
+    KEY_NAME(KEY_1), KEY_NAME(KEY_2), KEY_NAME(KEY_3), KEY_NAME(KEY_4), KEY_NAME(KEY_5),
+    KEY_NAME(KEY_6), KEY_NAME(KEY_7), KEY_NAME(KEY_8), KEY_NAME(KEY_9), KEY_NAME(KEY_0),
+    KEY_NAME(KEY_MINUS), KEY_NAME(KEY_EQUAL), KEY_NAME(KEY_LEFTBRACE), KEY_NAME(KEY_RIGHTBRACE),
+    KEY_NAME(KEY_SEMICOLON), KEY_NAME(KEY_APOSTROPHE), KEY_NAME(KEY_GRAVE), KEY_NAME(KEY_BACKSLASH),
+    KEY_NAME(KEY_COMMA), KEY_NAME(KEY_DOT), KEY_NAME(KEY_SLASH),
+    KEY_NAME(KEY_ESC), KEY_NAME(KEY_BACKSPACE), KEY_NAME(KEY_TAB), KEY_NAME(KEY_ENTER),
+    KEY_NAME(KEY_SPACE), KEY_NAME(KEY_CAPSLOCK),
+    KEY_NAME(KEY_LEFTSHIFT), KEY_NAME(KEY_RIGHTSHIFT), KEY_NAME(KEY_LEFTCTRL), KEY_NAME(KEY_RIGHTCTRL),
+    KEY_NAME(KEY_LEFTALT), KEY_NAME(KEY_RIGHTALT),
+    KEY_NAME(KEY_UP), KEY_NAME(KEY_DOWN), KEY_NAME(KEY_LEFT), KEY_NAME(KEY_RIGHT),
+    KEY_NAME(KEY_INSERT), KEY_NAME(KEY_DELETE), KEY_NAME(KEY_HOME), KEY_NAME(KEY_END),
+    KEY_NAME(KEY_PAGEUP), KEY_NAME(KEY_PAGEDOWN),
+    KEY_NAME(KEY_F1), KEY_NAME(KEY_F2), KEY_NAME(KEY_F3), KEY_NAME(KEY_F4), KEY_NAME(KEY_F5),
+    KEY_NAME(KEY_F6), KEY_NAME(KEY_F7), KEY_NAME(KEY_F8), KEY_NAME(KEY_F9), KEY_NAME(KEY_F10),
+    KEY_NAME(KEY_F11), KEY_NAME(KEY_F12),
+    KEY_NAME(KEY_KP0), KEY_NAME(KEY_KP1), KEY_NAME(KEY_KP2), KEY_NAME(KEY_KP3), KEY_NAME(KEY_KP4),
+    KEY_NAME(KEY_KP5), KEY_NAME(KEY_KP6), KEY_NAME(KEY_KP7), KEY_NAME(KEY_KP8), KEY_NAME(KEY_KP9),
+    KEY_NAME(KEY_KPMINUS), KEY_NAME(KEY_KPPLUS), KEY_NAME(KEY_KPASTERISK), KEY_NAME(KEY_KPSLASH),
+    KEY_NAME(KEY_KPDOT), KEY_NAME(KEY_KPENTER),
+};
+#undef KEY_NAME
+
+bool ParseKeyName(const std::string& name, int& code) {
+    if (name == "none") {
+        code = 0;
+        return true;
+    }
+    for (const auto& entry : kKeyNames) {
+        if (name == entry.name) {
+            code = entry.code;
+            return true;
+        }
+    }
+    return false;
+}
+
+int* FindControl(KeyBindings& bindings, const std::string& control) {
+    if (control == "throttle") return &bindings.throttle;
+    if (control == "brake") return &bindings.brake;
+    if (control == "clutch") return &bindings.clutch;
+    if (control == "dpad_right") return &bindings.dpad_right;
+    if (control == "dpad_left") return &bindings.dpad_left;
+    if (control == "dpad_down") return &bindings.dpad_down;
+    if (control == "dpad_up") return &bindings.dpad_up;
+    if (control.rfind("button", 0) == 0 && control.size() > 6 && control.size() <= 8 &&
+        control.find_first_not_of("0123456789", 6) == std::string::npos) {
+        const size_t number = std::stoul(control.substr(6));
+        if (number >= 1 && number <= bindings.buttons.size()) {
+            return &bindings.buttons[number - 1];
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+KeyBindings DefaultKeyBindings() {
+    KeyBindings bindings;
+    bindings.throttle = KEY_W;
+    bindings.brake = KEY_S;
+    bindings.clutch = KEY_A;
+    bindings.dpad_right = KEY_RIGHT;
+    bindings.dpad_left = KEY_LEFT;
+    bindings.dpad_down = KEY_DOWN;
+    bindings.dpad_up = KEY_UP;
+    bindings.buttons = {
+        KEY_Q, KEY_E, KEY_F, KEY_G, KEY_H, KEY_R, KEY_T, KEY_Y, KEY_U,
+        KEY_I, KEY_O, KEY_P, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6,
+        KEY_7, KEY_8, KEY_9, KEY_0, KEY_LEFTSHIFT, KEY_SPACE, KEY_TAB, KEY_ENTER,
+    };
+    return bindings;
+}
+
+bool SetKeyBinding(KeyBindings& bindings, const std::string& control, const std::string& key, std::string& error) {
+    int* slot = FindControl(bindings, control);
+    if (!slot) {
+        error = "unknown control '" + control + "'";
+        return false;
+    }
+    int code = 0;
+    if (!ParseKeyName(key, code)) {
+        error = "unknown key '" + key + "' for " + control;
+        return false;
+    }
+    *slot = code;
+    return true;
+}
+
+std::vector<int> BoundKeys(const KeyBindings& bindings) {
+    std::vector<int> keys;
+    for (int key : {bindings.throttle, bindings.brake, bindings.clutch, bindings.dpad_right, bindings.dpad_left,
+                    bindings.dpad_down, bindings.dpad_up}) {
+        if (key > 0) {
+            keys.push_back(key);
+        }
+    }
+    for (int key : bindings.buttons) {
+        if (key > 0) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
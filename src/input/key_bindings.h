@@ -0,0 +1,35 @@
+#ifndef KEY_BINDINGS_H
+#define KEY_BINDINGS_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../wheel_types.h"
+
+// Keyboard keys driving one wheel's pedals, D-pad and buttons (Linux KEY_* codes,
+// 0 = unbound). InputManager builds its logical state and the scanner's kernel-side
+// event filter from the same table, so the two cannot drift apart.
+struct KeyBindings {
+    int throttle;
+    int brake;
+    int clutch;
+    int dpad_right;
+    int dpad_left;
+    int dpad_down;
+    int dpad_up;
+    std::array<int, static_cast<size_t>(WheelButton::Count)> buttons;  // by WheelButton
+};
+
+// W/S/A pedals, arrow-key D-pad, buttons 1-26 on Q E F G H R T Y U I O P 1-0
+// LEFTSHIFT SPACE TAB ENTER (the layout documented in the generated config).
+KeyBindings DefaultKeyBindings();
+
+// Rebinds one control from a [wheel.N] line: `control` is throttle, brake, clutch,
+// dpad_up/down/left/right or button1-button26, `key` a KEY_* name or "none".
+bool SetKeyBinding(KeyBindings& bindings, const std::string& control, const std::string& key, std::string& error);
+
+// Every bound key, for DeviceScanner::SetKeyFilter.
+std::vector<int> BoundKeys(const KeyBindings& bindings);
+
+#endif  // KEY_BINDINGS_H
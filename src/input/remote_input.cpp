@@ -0,0 +1,350 @@
+#include "remote_input.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <random>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../metrics/metrics.h"
+
+namespace inject {
+namespace {
+constexpr size_t kBatch = 32;
+constexpr int kWindowBits = 64;
+
+struct RemoteMetrics {
+    metrics::Counter& accepted;
+    metrics::Counter& late;
+    metrics::Counter& duplicates;
+    metrics::Counter& stale;
+    metrics::Counter& malformed;
+    metrics::Counter& gaps;
+    metrics::Histogram& latency;
+};
+
+RemoteMetrics& Metrics() {
+    static RemoteMetrics m{
+        metrics::DefaultRegistry().GetCounter("wheel_remote_packets_total{result=\"accepted\"}",
+                                              "UDP input datagrams by outcome"),
+        metrics::DefaultRegistry().GetCounter("wheel_remote_packets_total{result=\"late\"}",
+                                              "UDP input datagrams by outcome"),
+        metrics::DefaultRegistry().GetCounter("wheel_remote_packets_total{result=\"duplicate\"}",
+                                              "UDP input datagrams by outcome"),
+        metrics::DefaultRegistry().GetCounter("wheel_remote_packets_total{result=\"stale\"}",
+                                              "UDP input datagrams by outcome"),
+        metrics::DefaultRegistry().GetCounter("wheel_remote_packets_total{result=\"malformed\"}",
+                                              "UDP input datagrams by outcome"),
+        metrics::DefaultRegistry().GetCounter("wheel_remote_sequence_gaps_total",
+                                              "Sequence numbers skipped by UDP input senders"),
+        metrics::DefaultRegistry().GetHistogram("wheel_remote_latency_us",
+                                                "UDP input sender timestamp to receipt (CLOCK_REALTIME)",
+                                                "microseconds"),
+    };
+    return m;
+}
+
+int64_t ClockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool SameAddress(const struct sockaddr_storage& a, socklen_t a_len, const struct sockaddr_storage& b,
+                 socklen_t b_len) {
+    return a_len == b_len && std::memcmp(&a, &b, a_len) == 0;
+}
+}  // namespace
+
+bool ResolveUdpAddress(const std::string& address, bool passive, struct sockaddr_storage& out,
+                       socklen_t& out_len, std::string& error) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = "expected host:port, got '" + address + "'";
+        return false;
+    }
+    std::string host = address.substr(0, colon);
+    std::string port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = (passive ? AI_PASSIVE : 0) | AI_NUMERICSERV;
+    struct addrinfo* result = nullptr;
+    int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0 || !result) {
+        error = "cannot resolve '" + address + "': " + gai_strerror(rc);
+        return false;
+    }
+    std::memcpy(&out, result->ai_addr, result->ai_addrlen);
+    out_len = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
+
+RemoteReceiver::RemoteReceiver() : fd_(-1), wake_fd_(-1) {}
+
+RemoteReceiver::~RemoteReceiver() {
+    Close();
+}
+
+bool RemoteReceiver::Open(const std::string& address, std::string& error) {
+    Close();
+    struct sockaddr_storage addr;
+    socklen_t addr_len = 0;
+    if (!ResolveUdpAddress(address, true, addr, addr_len, error)) {
+        return false;
+    }
+    fd_ = socket(addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len) < 0) {
+        error = "bind " + address + ": " + std::strerror(errno);
+        Close();
+        return false;
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        error = std::string("eventfd: ") + std::strerror(errno);
+        Close();
+        return false;
+    }
+    senders_.clear();
+    stats_ = RemoteStats{};
+    return true;
+}
+
+void RemoteReceiver::Close() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+}
+
+uint16_t RemoteReceiver::port() const {
+    struct sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    if (fd_ < 0 || getsockname(fd_, reinterpret_cast<struct sockaddr*>(&addr), &len) < 0) {
+        return 0;
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<struct sockaddr_in6*>(&addr)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<struct sockaddr_in*>(&addr)->sin_port);
+}
+
+void RemoteReceiver::Wait(int timeout_ms) {
+    struct pollfd fds[2];
+    fds[0].fd = fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wake_fd_;
+    fds[1].events = POLLIN;
+    if (poll(fds, 2, timeout_ms) > 0 && (fds[1].revents & POLLIN)) {
+        uint64_t drained;
+        ssize_t ignored = read(wake_fd_, &drained, sizeof(drained));
+        (void)ignored;
+    }
+}
+
+void RemoteReceiver::Wake() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+size_t RemoteReceiver::Drain(const MessageCallback& on_message) {
+    RemotePacket packets[kBatch];
+    struct sockaddr_storage addresses[kBatch];
+    struct iovec iov[kBatch];
+    struct mmsghdr msgs[kBatch];
+    size_t delivered = 0;
+    while (fd_ >= 0) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            iov[i].iov_base = &packets[i];
+            iov[i].iov_len = sizeof(RemotePacket);
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addresses[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+        }
+        int count = recvmmsg(fd_, msgs, kBatch, MSG_DONTWAIT, nullptr);
+        if (count <= 0) {
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const RemotePacket& packet = packets[i];
+            if (msgs[i].msg_len != sizeof(RemotePacket) || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ||
+                packet.magic != kRemoteMagic || packet.version != kRemoteVersion || !FiniteFloats(packet.message)) {
+                ++stats_.malformed;
+                Metrics().malformed.Increment();
+                continue;
+            }
+            Message message;
+            if (Admit(addresses[i], msgs[i].msg_hdr.msg_namelen, packet, message)) {
+                on_message(message);
+                ++delivered;
+            }
+        }
+        if (static_cast<size_t>(count) < kBatch) {
+            break;
+        }
+    }
+    return delivered;
+}
+
+bool RemoteReceiver::Admit(const struct sockaddr_storage& address, socklen_t address_len, const RemotePacket& packet,
+                           Message& out) {
+    const int64_t steady_ns = ClockNs(CLOCK_MONOTONIC);
+    Sender* sender = nullptr;
+    for (auto& candidate : senders_) {
+        if (SameAddress(candidate.address, candidate.address_len, address, address_len)) {
+            sender = &candidate;
+            break;
+        }
+    }
+    bool fresh = false;
+    if (!sender) {
+        if (senders_.size() < kMaxSenders) {
+            senders_.emplace_back();
+            sender = &senders_.back();
+        } else {
+            sender = &senders_.front();
+            for (auto& candidate : senders_) {
+                if (candidate.last_seen_ns < sender->last_seen_ns) {
+                    sender = &candidate;
+                }
+            }
+        }
+        std::memcpy(&sender->address, &address, address_len);
+        sender->address_len = address_len;
+        fresh = true;
+    }
+    if (fresh || sender->session != packet.session) {
+        sender->session = packet.session;
+        sender->newest = packet.seq - 1;
+        sender->window = 0;
+    }
+    sender->last_seen_ns = steady_ns;
+
+    out = packet.message;
+    const int32_t ahead = static_cast<int32_t>(packet.seq - sender->newest);
+    if (ahead > 0) {
+        if (ahead > 1) {
+            stats_.gaps += static_cast<uint64_t>(ahead - 1);
+            Metrics().gaps.Increment(static_cast<uint64_t>(ahead - 1));
+        }
+        sender->window = ahead >= kWindowBits ? 1 : (sender->window << ahead) | 1;
+        sender->newest = packet.seq;
+        ++stats_.accepted;
+        Metrics().accepted.Increment();
+    } else {
+        const int age = -ahead;
+        if (age >= kWindowBits) {
+            ++stats_.stale;
+            Metrics().stale.Increment();
+            return false;
+        }
+        const uint64_t bit = uint64_t{1} << age;
+        if (sender->window & bit) {
+            ++stats_.duplicates;
+            Metrics().duplicates.Increment();
+            return false;
+        }
+        sender->window |= bit;
+        ++stats_.late;
+        Metrics().late.Increment();
+        // Relative moves commute, so a late delta still counts; held values do not.
+        out.set &= kSteeringDelta;
+        out.release = 0;
+        if (out.set == 0) {
+            return false;
+        }
+    }
+
+    int64_t latency_ns = 0;
+    if (packet.sent_ns > 0) {
+        latency_ns = std::max<int64_t>(ClockNs(CLOCK_REALTIME) - packet.sent_ns, 0);
+        Metrics().latency.Observe(static_cast<uint64_t>(latency_ns / 1000));
+    }
+    out.time_ns = steady_ns - latency_ns;
+    return true;
+}
+
+RemoteSender::RemoteSender() : fd_(-1), session_(0), next_seq_(0) {
+    std::random_device seed;
+    session_ = seed();
+}
+
+RemoteSender::~RemoteSender() {
+    Close();
+}
+
+bool RemoteSender::Open(const std::string& address, std::string& error) {
+    Close();
+    struct sockaddr_storage addr;
+    socklen_t addr_len = 0;
+    if (!ResolveUdpAddress(address, false, addr, addr_len, error)) {
+        return false;
+    }
+    fd_ = socket(addr.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len) < 0) {
+        error = "connect " + address + ": " + std::strerror(errno);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void RemoteSender::Close() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void RemoteSender::Stamp(const Message& message, RemotePacket& packet) {
+    std::memset(&packet, 0, sizeof(packet));
+    packet.magic = kRemoteMagic;
+    packet.version = kRemoteVersion;
+    packet.session = session_;
+    packet.seq = next_seq_++;
+    packet.sent_ns = ClockNs(CLOCK_REALTIME);
+    packet.message = message;
+    packet.message.time_ns = 0;
+}
+
+bool RemoteSender::Send(const Message& message) {
+    RemotePacket packet;
+    Stamp(message, packet);
+    return SendRaw(packet);
+}
+
+bool RemoteSender::SendRaw(const RemotePacket& packet) {
+    return fd_ >= 0 && send(fd_, &packet, sizeof(packet), 0) == static_cast<ssize_t>(sizeof(packet));
+}
+
+}  // namespace inject
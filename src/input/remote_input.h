@@ -0,0 +1,123 @@
+#ifndef REMOTE_INPUT_H
+#define REMOTE_INPUT_H
+
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "injection_channel.h"
+
+namespace inject {
+
+// One UDP datagram of remote input: a fixed header plus the same Message the
+// shared-memory lanes carry (its time_ns is ignored on the wire). Little-endian.
+//
+// Sequence numbers count per (sender address, session). A datagram newer than the
+// newest seen is applied whole. A late one inside the 64-packet window is applied for
+// its steering delta only; its absolute values and releases are already out of date.
+// Repeats and anything older than the window are dropped. A new session (the
+// sender restarted) starts counting afresh.
+constexpr uint32_t kRemoteMagic = 0x4e495257;  // "WRIN"
+constexpr uint16_t kRemoteVersion = 1;
+
+struct RemotePacket {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t session;   // random per sender run
+    uint32_t seq;       // +1 per datagram, wraps
+    int64_t sent_ns;    // sender CLOCK_REALTIME; one-way latency needs synced clocks off-host
+    Message message;
+};
+static_assert(sizeof(RemotePacket) == 64, "remote packet layout is part of the wire format");
+
+// What Drain() did with each datagram, for tests and the metrics socket.
+struct RemoteStats {
+    uint64_t accepted = 0;
+    uint64_t late = 0;        // arrived after a newer one; delta applied
+    uint64_t duplicates = 0;  // seen before, dropped
+    uint64_t stale = 0;       // older than the window, dropped
+    uint64_t malformed = 0;
+    uint64_t gaps = 0;        // sequence numbers skipped when a newer packet arrived
+};
+
+// Splits "host:port" ("[v6]:port" for IPv6); host may be empty for any address.
+bool ResolveUdpAddress(const std::string& address, bool passive, struct sockaddr_storage& out,
+                       socklen_t& out_len, std::string& error);
+
+class RemoteReceiver {
+public:
+    static constexpr size_t kMaxSenders = 8;
+
+    RemoteReceiver();
+    ~RemoteReceiver();
+
+    RemoteReceiver(const RemoteReceiver&) = delete;
+    RemoteReceiver& operator=(const RemoteReceiver&) = delete;
+
+    bool Open(const std::string& address, std::string& error);
+    void Close();
+    bool is_open() const { return fd_ >= 0; }
+    uint16_t port() const;  // bound port, useful after binding port 0
+
+    // Blocks until a datagram is queued, Wake() is called or `timeout_ms` passes.
+    void Wait(int timeout_ms);
+    void Wake();
+
+    // Reads every queued datagram. `on_message` gets each accepted message with
+    // time_ns rebased to this host's steady clock (arrival minus one-way latency).
+    // Returns the number of messages delivered.
+    using MessageCallback = std::function<void(const Message&)>;
+    size_t Drain(const MessageCallback& on_message);
+
+    const RemoteStats& stats() const { return stats_; }
+
+private:
+    struct Sender {
+        struct sockaddr_storage address;
+        socklen_t address_len = 0;
+        uint32_t session = 0;
+        uint32_t newest = 0;
+        uint64_t window = 0;  // bit i: newest - i has been seen
+        int64_t last_seen_ns = 0;
+    };
+
+    bool Admit(const struct sockaddr_storage& address, socklen_t address_len, const RemotePacket& packet,
+               Message& out);
+
+    int fd_;
+    int wake_fd_;
+    std::vector<Sender> senders_;
+    RemoteStats stats_;
+};
+
+// Sends Messages to a RemoteReceiver, numbering and timestamping them.
+class RemoteSender {
+public:
+    RemoteSender();
+    ~RemoteSender();
+
+    RemoteSender(const RemoteSender&) = delete;
+    RemoteSender& operator=(const RemoteSender&) = delete;
+
+    bool Open(const std::string& address, std::string& error);
+    void Close();
+
+    // Stamps the next sequence number and CLOCK_REALTIME into `packet`. Send() both
+    // stamps and sends; SendRaw() lets tests replay or reorder stamped packets.
+    void Stamp(const Message& message, RemotePacket& packet);
+    bool Send(const Message& message);
+    bool SendRaw(const RemotePacket& packet);
+
+private:
+    int fd_;
+    uint32_t session_;
+    uint32_t next_seq_;
+};
+
+}  // namespace inject
+
+#endif  // REMOTE_INPUT_H
@@ -8,9 +8,9 @@
 #include "../wheel_types.h"
 
 struct WheelInputState {
-    bool throttle = false;
-    bool brake = false;
-    bool clutch = false;
+    uint8_t throttle = 0;  // 0-100
+    uint8_t brake = 0;
+    uint8_t clutch = 0;
     int8_t dpad_x = 0;
     int8_t dpad_y = 0;
     std::array<uint8_t, static_cast<size_t>(WheelButton::Count)> buttons{};
@@ -19,7 +19,16 @@ struct WheelInputState {
 struct InputFrame {
     WheelInputState logical;
     int mouse_dx = 0;
-    std::chrono::steady_clock::time_point timestamp;
+    // Steering from injected sources, in steering counts. With steering_set the user
+    // steering jumps to `steering` first; mouse_dx and steering_delta are added after.
+    bool steering_set = false;
+    float steering = 0.0f;
+    float steering_delta = 0.0f;
+    std::chrono::steady_clock::time_point timestamp;  // when the reader last updated the frame
+    // Kernel timestamps (steady_clock ns) of the oldest and newest SYN_REPORT packets
+    // folded into this frame; `timestamp - oldest` is time spent queued before the reader.
+    int64_t oldest_event_ns = 0;
+    int64_t newest_event_ns = 0;
     bool toggle_pressed = false;
 };
 
@@ -0,0 +1,333 @@
+#include "uring.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include "../logging/logger.h"
+
+namespace io {
+namespace {
+constexpr const char* kTag = "uring";
+// IORING_OP_READ_MULTISHOT (Linux 6.7) postdates the uapi headers we build against.
+constexpr uint8_t kOpReadMultishot = 49;
+constexpr uint16_t kBufferGroup = 0;
+
+int SysSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int SysRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+unsigned LoadAcquire(const unsigned* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned* p, unsigned value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+bool OpSupported(int ring_fd, uint8_t op) {
+    constexpr unsigned kProbeOps = 256;
+    std::vector<uint8_t> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (SysRegister(ring_fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        return false;
+    }
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+}  // namespace
+
+bool ParseBackend(const std::string& text, Backend& out) {
+    if (text == "epoll") {
+        out = Backend::kEpoll;
+        return true;
+    }
+    if (text == "io_uring" || text == "uring") {
+        out = Backend::kIoUring;
+        return true;
+    }
+    return false;
+}
+
+const char* BackendName(Backend backend) {
+    return backend == Backend::kIoUring ? "io_uring" : "epoll";
+}
+
+Uring::Uring()
+        : ring_fd_(-1), sq_entries_(0), sq_pending_(0), sq_ring_(nullptr), cq_ring_(nullptr),
+          sq_ring_size_(0), cq_ring_size_(0), sqes_(nullptr), sqes_size_(0), sq_head_(nullptr), sq_tail_(nullptr),
+          sq_mask_(nullptr), sq_array_(nullptr), cq_head_(nullptr), cq_tail_(nullptr),
+          cq_mask_(nullptr), cqes_(nullptr), buf_ring_(nullptr), buf_ring_size_(0), buf_tail_(0),
+          buffer_count_(0), buffer_size_(0) {}
+
+Uring::~Uring() {
+    Teardown();
+}
+
+bool Uring::Init(unsigned entries, unsigned buffer_count, unsigned buffer_size) {
+    Teardown();
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = SysSetup(entries, &params);
+    if (fd < 0) {
+        LOG_WARN(kTag, "io_uring_setup failed: " << std::strerror(errno));
+        return false;
+    }
+    ring_fd_ = fd;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        LOG_WARN(kTag, "kernel io_uring too old (no single mmap)");
+        Teardown();
+        return false;
+    }
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    cq_ring_size_ = sq_ring_size_;
+    void* ring = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        LOG_WARN(kTag, "mmap of io_uring rings failed: " << std::strerror(errno));
+        Teardown();
+        return false;
+    }
+    sq_ring_ = ring;
+    cq_ring_ = ring;
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        LOG_WARN(kTag, "mmap of io_uring SQEs failed: " << std::strerror(errno));
+        Teardown();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<uint8_t*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<uint8_t*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    if (buffer_count == 0) {
+        return true;
+    }
+    if ((buffer_count & (buffer_count - 1)) != 0 || buffer_count > 32768 || buffer_size == 0) {
+        LOG_ERROR(kTag, "invalid provided-buffer ring " << buffer_count << " x " << buffer_size);
+        Teardown();
+        return false;
+    }
+    if (!OpSupported(ring_fd_, kOpReadMultishot)) {
+        LOG_WARN(kTag, "kernel lacks multishot reads (Linux 6.7+)");
+        Teardown();
+        return false;
+    }
+
+    buf_ring_size_ = buffer_count * sizeof(io_uring_buf);
+    void* bufs = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufs == MAP_FAILED) {
+        buf_ring_size_ = 0;
+        LOG_WARN(kTag, "mmap of buffer ring failed: " << std::strerror(errno));
+        Teardown();
+        return false;
+    }
+    buf_ring_ = static_cast<io_uring_buf*>(bufs);
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = buffer_count;
+    reg.bgid = kBufferGroup;
+    if (SysRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LOG_WARN(kTag, "registering provided buffers failed: " << std::strerror(errno));
+        Teardown();
+        return false;
+    }
+    buffer_count_ = buffer_count;
+    buffer_size_ = buffer_size;
+    buffers_.assign(static_cast<size_t>(buffer_count) * buffer_size, 0);
+    buf_tail_ = 0;
+    for (unsigned i = 0; i < buffer_count; ++i) {
+        RecycleBuffer(static_cast<uint16_t>(i));
+    }
+    return true;
+}
+
+void Uring::Teardown() {
+    if (buf_ring_) {
+        if (ring_fd_ >= 0 && buffer_count_ > 0) {
+            io_uring_buf_reg reg;
+            std::memset(&reg, 0, sizeof(reg));
+            reg.bgid = kBufferGroup;
+            SysRegister(ring_fd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        }
+        munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+        buf_ring_size_ = 0;
+    }
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (sq_ring_) {
+        munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = nullptr;
+        cq_ring_ = nullptr;
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+        ring_fd_ = -1;
+    }
+    buffers_.clear();
+    buffer_count_ = 0;
+    buffer_size_ = 0;
+    sq_pending_ = 0;
+}
+
+io_uring_sqe* Uring::NextSqe() {
+    unsigned tail = *sq_tail_;
+    if (tail - LoadAcquire(sq_head_) >= sq_entries_) {
+        Submit();
+        if (tail - LoadAcquire(sq_head_) >= sq_entries_) {
+            return nullptr;
+        }
+    }
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    return sqe;
+}
+
+void Uring::PublishSqe() {
+    StoreRelease(sq_tail_, *sq_tail_ + 1);
+    ++sq_pending_;
+}
+
+void Uring::PrepareReadMultishot(int fd, uint64_t user_data) {
+    io_uring_sqe* sqe = ready() ? NextSqe() : nullptr;
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = kOpReadMultishot;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = user_data;
+    PublishSqe();
+}
+
+void Uring::PrepareWrite(int fd, const void* data, size_t size, uint64_t user_data) {
+    io_uring_sqe* sqe = ready() ? NextSqe() : nullptr;
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = static_cast<uint32_t>(size);
+    sqe->user_data = user_data;
+    PublishSqe();
+}
+
+void Uring::PrepareCancel(uint64_t target_user_data, uint64_t user_data) {
+    io_uring_sqe* sqe = ready() ? NextSqe() : nullptr;
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target_user_data;
+    sqe->user_data = user_data;
+    PublishSqe();
+}
+
+bool Uring::Submit(unsigned wait_for) {
+    if (!ready()) {
+        return false;
+    }
+    if (sq_pending_ == 0 && wait_for == 0) {
+        return true;
+    }
+    unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+    for (;;) {
+        int rc = SysEnter(ring_fd_, sq_pending_, wait_for, flags);
+        if (rc >= 0) {
+            sq_pending_ -= std::min<unsigned>(sq_pending_, static_cast<unsigned>(rc));
+            return true;
+        }
+        if (errno == EINTR && wait_for > 0) {
+            continue;
+        }
+        if (errno == EINTR || errno == EBUSY || errno == EAGAIN) {
+            return true;
+        }
+        LOG_ERROR(kTag, "io_uring_enter failed: " << std::strerror(errno));
+        return false;
+    }
+}
+
+size_t Uring::Reap(const CompletionCallback& on_completion) {
+    if (!ready()) {
+        return 0;
+    }
+    unsigned head = *cq_head_;
+    size_t seen = 0;
+    for (;;) {
+        unsigned tail = LoadAcquire(cq_tail_);
+        if (head == tail) {
+            break;
+        }
+        const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+        Completion completion;
+        completion.user_data = cqe.user_data;
+        completion.res = cqe.res;
+        completion.more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (has_buffer && buffer_id < buffer_count_) {
+            completion.data = buffers_.data() + static_cast<size_t>(buffer_id) * buffer_size_;
+        } else {
+            has_buffer = false;
+        }
+        ++head;
+        StoreRelease(cq_head_, head);
+        on_completion(completion);
+        if (has_buffer) {
+            RecycleBuffer(buffer_id);
+        }
+        ++seen;
+    }
+    return seen;
+}
+
+void Uring::RecycleBuffer(uint16_t id) {
+    io_uring_buf& slot = buf_ring_[buf_tail_ & (buffer_count_ - 1)];
+    slot.addr = reinterpret_cast<uint64_t>(buffers_.data() + static_cast<size_t>(id) * buffer_size_);
+    slot.len = buffer_size_;
+    slot.bid = id;
+    ++buf_tail_;
+    // The tail overlays the resv field of the first entry.
+    auto* tail = reinterpret_cast<uint16_t*>(reinterpret_cast<uint8_t*>(buf_ring_) + offsetof(io_uring_buf, resv));
+    __atomic_store_n(tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+}  // namespace io
@@ -0,0 +1,101 @@
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf;
+
+namespace io {
+
+// Which syscall path moves evdev events, OUTPUT packets and IN reports.
+enum class Backend {
+    kEpoll,    // epoll_wait + read/write per fd (default)
+    kIoUring,  // multishot reads and ring-submitted writes; falls back to kEpoll
+};
+
+bool ParseBackend(const std::string& text, Backend& out);
+const char* BackendName(Backend backend);
+
+// Minimal io_uring over the raw syscalls, sized for a handful of long-lived
+// multishot reads plus occasional writes. One provided-buffer group feeds every
+// multishot read. Not thread-safe: each owner serialises all calls itself.
+class Uring {
+public:
+    struct Completion {
+        uint64_t user_data = 0;
+        int32_t res = 0;
+        bool more = false;              // the request stays armed (IORING_CQE_F_MORE)
+        const uint8_t* data = nullptr;  // provided buffer holding `res` bytes, if any
+    };
+    using CompletionCallback = std::function<void(const Completion&)>;
+
+    Uring();
+    ~Uring();
+
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    // Sets up `entries` submission slots and, when buffer_count > 0 (a power of two),
+    // a buffer ring of buffer_count x buffer_size bytes. Fails, leaving the object
+    // unusable, when io_uring is unavailable or the kernel lacks multishot reads.
+    bool Init(unsigned entries, unsigned buffer_count = 0, unsigned buffer_size = 0);
+    bool ready() const { return ring_fd_ >= 0; }
+    // Readable (EPOLLIN) while completions are waiting, so it can sit in an epoll set.
+    int fd() const { return ring_fd_; }
+
+    // Queue a request; Submit() hands queued requests to the kernel. A full
+    // submission queue is flushed first.
+    void PrepareReadMultishot(int fd, uint64_t user_data);
+    void PrepareWrite(int fd, const void* data, size_t size, uint64_t user_data);
+    void PrepareCancel(uint64_t target_user_data, uint64_t user_data);
+    // Returns false on a submit error other than EINTR/EBUSY. wait_for > 0 blocks
+    // until that many completions are queued.
+    bool Submit(unsigned wait_for = 0);
+    bool HasPending() const { return sq_pending_ > 0; }
+
+    // Runs `on_completion` for every queued completion and recycles provided
+    // buffers once it returns. Returns the number of completions seen.
+    size_t Reap(const CompletionCallback& on_completion);
+
+private:
+    io_uring_sqe* NextSqe();  // nullptr when the queue stays full after a flush
+    void PublishSqe();
+    void RecycleBuffer(uint16_t id);
+    void Teardown();
+
+    int ring_fd_;
+    unsigned sq_entries_;
+    unsigned sq_pending_;  // prepared but not yet submitted
+    void* sq_ring_;
+    void* cq_ring_;
+    size_t sq_ring_size_;
+    size_t cq_ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_array_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    io_uring_cqe* cqes_;
+
+    // Provided-buffer ring; its tail overlays the `resv` field of entry 0.
+    io_uring_buf* buf_ring_;
+    size_t buf_ring_size_;
+    uint16_t buf_tail_;
+    unsigned buffer_count_;
+    unsigned buffer_size_;
+    std::vector<uint8_t> buffers_;
+};
+
+}  // namespace io
+
+#endif  // IO_URING_H
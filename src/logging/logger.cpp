@@ -1,17 +1,79 @@
 #include "logger.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
-#include <ctime>
-#include <iomanip>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace logging {
 namespace {
+
+constexpr size_t kRingSlots = 128;
+constexpr size_t kMaxMessageBytes = 480;
+
+struct Record {
+    uint64_t sequence;
+    int64_t since_start_ms;
+    LogLevel level;
+    const char* tag;
+    uint32_t suppressed;
+    uint32_t length;
+    char text[kMaxMessageBytes];
+};
+
+// Single-producer (owning thread) / single-consumer (writer thread) queue.
+struct ThreadRing {
+    std::array<Record, kRingSlots> slots;
+    std::atomic<size_t> head{0};  // next slot the producer fills
+    std::atomic<size_t> tail{0};  // next slot the writer reads
+    std::atomic<uint64_t> dropped{0};
+};
+
 std::atomic<int> g_log_level{0};
-std::mutex g_log_mutex;
 auto g_start_time = std::chrono::steady_clock::now();
+std::atomic<uint64_t> g_sequence{0};
+
+std::mutex g_rings_mutex;
+std::vector<std::shared_ptr<ThreadRing>> g_rings;
+
+std::mutex g_writer_mutex;
+std::condition_variable g_writer_cv;
+std::atomic<bool> g_wake_pending{false};
+std::atomic<bool> g_writer_running{false};
+bool g_writer_stop = false;
+std::thread g_writer_thread;
+
+thread_local ThreadRing* t_ring = nullptr;
+
+// Fixed-capacity streambuf so formatting a message never allocates; output past the
+// end is dropped and the stream goes bad, which CommitThreadStream reports as truncation.
+class ScratchBuffer : public std::streambuf {
+public:
+    ScratchBuffer() { Reset(); }
+    void Reset() { setp(storage_, storage_ + sizeof(storage_)); }
+    char* data() { return storage_; }
+    size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+
+private:
+    char storage_[kMaxMessageBytes];
+};
+
+struct ThreadScratch {
+    ScratchBuffer buffer;
+    std::ostream stream{&buffer};
+};
+
+ThreadScratch& LocalScratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
 
 const char* LevelName(LogLevel level) {
     switch (level) {
@@ -26,11 +88,195 @@ const char* LevelName(LogLevel level) {
     }
     return "UNKNOWN";
 }
+
+ThreadRing& LocalRing() {
+    if (!t_ring) {
+        auto ring = std::make_shared<ThreadRing>();
+        t_ring = ring.get();
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        g_rings.push_back(std::move(ring));
+    }
+    return *t_ring;
+}
+
+void AppendRecord(std::string& out, const Record& record) {
+    out += '[';
+    out += std::to_string(record.since_start_ms);
+    out += "ms] ";
+    out += LevelName(record.level);
+    out += ' ';
+    out += record.tag ? record.tag : "?";
+    out += ": ";
+    out.append(record.text, record.length);
+    if (record.suppressed > 0) {
+        out += " (";
+        out += std::to_string(record.suppressed);
+        out += " similar suppressed)";
+    }
+    out += '\n';
+}
+
+void WriteDirect(LogLevel level, const char* tag, const char* text, size_t length, uint32_t suppressed) {
+    static std::mutex direct_mutex;
+    Record record;
+    record.sequence = 0;
+    record.since_start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - g_start_time)
+                                .count();
+    record.level = level;
+    record.tag = tag;
+    record.suppressed = suppressed;
+    record.length = static_cast<uint32_t>(std::min(length, kMaxMessageBytes));
+    std::memcpy(record.text, text, record.length);
+    std::string line;
+    AppendRecord(line, record);
+    std::lock_guard<std::mutex> lock(direct_mutex);
+    std::ostream& out = (level == LogLevel::Error) ? std::cerr : std::cout;
+    out << line << std::flush;
+}
+
+void WakeWriter() {
+    if (!g_wake_pending.exchange(true, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> lock(g_writer_mutex);
+        g_writer_cv.notify_one();
+    }
+}
+
+void Enqueue(LogLevel level, const char* tag, const char* text, size_t length, uint32_t suppressed) {
+    if (!g_writer_running.load(std::memory_order_acquire)) {
+        WriteDirect(level, tag, text, length, suppressed);
+        return;
+    }
+    ThreadRing& ring = LocalRing();
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    size_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= kRingSlots) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        WakeWriter();
+        return;
+    }
+    Record& record = ring.slots[head % kRingSlots];
+    record.sequence = g_sequence.fetch_add(1, std::memory_order_relaxed);
+    record.since_start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - g_start_time)
+                                .count();
+    record.level = level;
+    record.tag = tag;
+    record.suppressed = suppressed;
+    size_t copied = std::min(length, kMaxMessageBytes);
+    std::memcpy(record.text, text, copied);
+    record.length = static_cast<uint32_t>(copied);
+    ring.head.store(head + 1, std::memory_order_release);
+    WakeWriter();
 }
 
+// Collects every queued record across threads and writes them in sequence order,
+// flushing each stream once per batch.
+void DrainRings(std::vector<Record*>& batch, std::vector<size_t>& consumed) {
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        rings = g_rings;
+    }
+
+    batch.clear();
+    consumed.assign(rings.size(), 0);
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < rings.size(); ++i) {
+        ThreadRing& ring = *rings[i];
+        size_t tail = ring.tail.load(std::memory_order_relaxed);
+        size_t head = ring.head.load(std::memory_order_acquire);
+        for (size_t pos = tail; pos != head; ++pos) {
+            batch.push_back(&ring.slots[pos % kRingSlots]);
+        }
+        consumed[i] = head;
+        dropped += ring.dropped.exchange(0, std::memory_order_relaxed);
+    }
+    if (batch.empty() && dropped == 0) {
+        return;
+    }
+
+    std::sort(batch.begin(), batch.end(), [](const Record* a, const Record* b) {
+        return a->sequence < b->sequence;
+    });
+
+    std::string out_text;
+    std::string err_text;
+    for (const Record* record : batch) {
+        AppendRecord(record->level == LogLevel::Error ? err_text : out_text, *record);
+    }
+    for (size_t i = 0; i < rings.size(); ++i) {
+        rings[i]->tail.store(consumed[i], std::memory_order_release);
+    }
+    if (dropped > 0) {
+        err_text += "[logger] dropped " + std::to_string(dropped) + " message(s): queue full\n";
+    }
+    if (!out_text.empty()) {
+        std::cout << out_text << std::flush;
+    }
+    if (!err_text.empty()) {
+        std::cerr << err_text << std::flush;
+    }
+}
+
+void WriterMain() {
+    std::vector<Record*> batch;
+    std::vector<size_t> consumed;
+    batch.reserve(kRingSlots);
+    std::unique_lock<std::mutex> lock(g_writer_mutex);
+    while (true) {
+        g_writer_cv.wait(lock, []() {
+            return g_writer_stop || g_wake_pending.load(std::memory_order_acquire);
+        });
+        bool stopping = g_writer_stop;
+        g_wake_pending.store(false, std::memory_order_release);
+        lock.unlock();
+        DrainRings(batch, consumed);
+        lock.lock();
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+}  // namespace
+
 void InitLogger(int level) {
     g_start_time = std::chrono::steady_clock::now();
     SetLogLevel(level);
+    if (level > WHEEL_LOG_COMPILED_LEVEL) {
+        std::cerr << "Log level " << level << " requested but this build only includes levels up to "
+                  << WHEEL_LOG_COMPILED_LEVEL << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(g_writer_mutex);
+    if (g_writer_thread.joinable()) {
+        return;
+    }
+    g_writer_stop = false;
+    g_writer_thread = std::thread(WriterMain);
+    g_writer_running.store(true, std::memory_order_release);
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        std::atexit(ShutdownLogger);
+    }
+}
+
+void ShutdownLogger() {
+    {
+        std::lock_guard<std::mutex> lock(g_writer_mutex);
+        if (!g_writer_thread.joinable()) {
+            return;
+        }
+        g_writer_stop = true;
+        g_writer_cv.notify_one();
+    }
+    g_writer_thread.join();
+    g_writer_running.store(false, std::memory_order_release);
+    // Anything queued between the final drain and the flag flip goes out here.
+    std::vector<Record*> batch;
+    std::vector<size_t> consumed;
+    DrainRings(batch, consumed);
 }
 
 void SetLogLevel(int level) {
@@ -50,12 +296,40 @@ void LogMessage(LogLevel level, const char* tag, const std::string& message) {
     if (!ShouldLog(level)) {
         return;
     }
-    auto now = std::chrono::steady_clock::now();
-    auto since_start = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_start_time).count();
+    Enqueue(level, tag, message.data(), message.size(), 0);
+}
 
-    std::lock_guard<std::mutex> lock(g_log_mutex);
-    std::ostream& out = (level == LogLevel::Error) ? std::cerr : std::cout;
-    out << '[' << since_start << "ms] " << LevelName(level) << ' ' << tag << ": " << message << std::endl;
+std::ostream& ThreadStream() {
+    ThreadScratch& scratch = LocalScratch();
+    scratch.buffer.Reset();
+    scratch.stream.clear();
+    return scratch.stream;
+}
+
+void CommitThreadStream(LogLevel level, const char* tag, uint32_t suppressed) {
+    ThreadScratch& scratch = LocalScratch();
+    size_t length = scratch.buffer.size();
+    if (scratch.stream.bad() && length >= 3) {
+        // Message hit kMaxMessageBytes; mark the cut instead of failing silently.
+        std::memcpy(scratch.buffer.data() + length - 3, "...", 3);
+    }
+    Enqueue(level, tag, scratch.buffer.data(), length, suppressed);
+}
+
+bool CallSiteLimiter::Allow(uint32_t& suppressed_out) {
+    int64_t window = std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    int64_t current = window_.load(std::memory_order_relaxed);
+    if (current != window && window_.compare_exchange_strong(current, window, std::memory_order_relaxed)) {
+        count_.store(0, std::memory_order_relaxed);
+    }
+    if (count_.fetch_add(1, std::memory_order_relaxed) < kMessagesPerSecond) {
+        suppressed_out = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
 ScopedLogTimer::ScopedLogTimer(const char* tag, const char* label, LogLevel level)
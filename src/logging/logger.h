@@ -1,10 +1,20 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <ostream>
 #include <sstream>
 #include <string>
 
+// Most verbose level compiled into the binary (0=error .. 3=debug). Call sites above
+// it expand to dead code. Release builds use 2, so LOG_DEBUG costs nothing on hot
+// paths; `make LOG_COMPILED_LEVEL=3` compiles it in.
+#ifndef WHEEL_LOG_COMPILED_LEVEL
+#define WHEEL_LOG_COMPILED_LEVEL 2
+#endif
+
 namespace logging {
 
 enum class LogLevel : int {
@@ -14,12 +24,36 @@ enum class LogLevel : int {
     Debug = 3
 };
 
+// Starts the background writer. Messages are queued per thread without locks and
+// written in batches, so logging never blocks a caller on terminal I/O.
 void InitLogger(int level);
+// Drains everything queued and stops the writer; safe to call more than once.
+void ShutdownLogger();
 void SetLogLevel(int level);
 int GetLogLevel();
 bool ShouldLog(LogLevel level);
+// `tag` must outlive the process (string literal or static constant).
 void LogMessage(LogLevel level, const char* tag, const std::string& message);
 
+// Per-thread scratch stream used by the LOG_* macros; returned empty.
+std::ostream& ThreadStream();
+void CommitThreadStream(LogLevel level, const char* tag, uint32_t suppressed);
+
+// Budget of messages per second for one LOG_* call site; excess messages are
+// counted and reported with the next message that gets through.
+class CallSiteLimiter {
+public:
+    static constexpr uint32_t kMessagesPerSecond = 20;
+
+    constexpr CallSiteLimiter() : window_(-1), count_(0), suppressed_(0) {}
+    bool Allow(uint32_t& suppressed_out);
+
+private:
+    std::atomic<int64_t> window_;
+    std::atomic<uint32_t> count_;
+    std::atomic<uint32_t> suppressed_;
+};
+
 class ScopedLogTimer {
 public:
     ScopedLogTimer(const char* tag, const char* label, LogLevel level = LogLevel::Debug);
@@ -38,15 +72,43 @@ private:
 #define LOG_STREAM(level, tag, stream_expr)                                      \
     do {                                                                         \
         if (::logging::ShouldLog(level)) {                                       \
+            static ::logging::CallSiteLimiter log_site__;                        \
+            uint32_t log_suppressed__ = 0;                                       \
+            if (log_site__.Allow(log_suppressed__)) {                            \
+                std::ostream& log_stream__ = ::logging::ThreadStream();          \
+                log_stream__ << stream_expr;                                     \
+                ::logging::CommitThreadStream(level, tag, log_suppressed__);     \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+// Keeps the expression type-checked (and its operands "used") without emitting code.
+#define LOG_STRIPPED(tag, stream_expr)                                           \
+    do {                                                                         \
+        if (false) {                                                             \
             std::ostringstream log_stream__;                                     \
-            log_stream__ << stream_expr;                                         \
-            ::logging::LogMessage(level, tag, log_stream__.str());               \
+            log_stream__ << tag << stream_expr;                                  \
         }                                                                        \
     } while (0)
 
 #define LOG_ERROR(tag, stream_expr) LOG_STREAM(::logging::LogLevel::Error, tag, stream_expr)
+
+#if WHEEL_LOG_COMPILED_LEVEL >= 1
 #define LOG_WARN(tag, stream_expr)  LOG_STREAM(::logging::LogLevel::Warn,  tag, stream_expr)
+#else
+#define LOG_WARN(tag, stream_expr)  LOG_STRIPPED(tag, stream_expr)
+#endif
+
+#if WHEEL_LOG_COMPILED_LEVEL >= 2
 #define LOG_INFO(tag, stream_expr)  LOG_STREAM(::logging::LogLevel::Info,  tag, stream_expr)
+#else
+#define LOG_INFO(tag, stream_expr)  LOG_STRIPPED(tag, stream_expr)
+#endif
+
+#if WHEEL_LOG_COMPILED_LEVEL >= 3
 #define LOG_DEBUG(tag, stream_expr) LOG_STREAM(::logging::LogLevel::Debug, tag, stream_expr)
+#else
+#define LOG_DEBUG(tag, stream_expr) LOG_STRIPPED(tag, stream_expr)
+#endif
 
 #endif  // LOGGER_H
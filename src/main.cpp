@@ -7,9 +7,11 @@
 #include <unistd.h>
 
 #include "config.h"
-#include "wheel_device.h"
-#include "input/input_manager.h"
+#include "wheel_server.h"
 #include "logging/logger.h"
+#include "metrics/metrics.h"
+#include "metrics/metrics_server.h"
+#include "tools/tools.h"
 
 int ParseLogLevelFromArgs(int argc, char* argv[]);
 
@@ -37,9 +39,17 @@ bool check_root() {
 int main(int argc, char* argv[]) {
     int log_level = ParseLogLevelFromArgs(argc, argv);
     logging::InitLogger(log_level);
+
+    if (argc > 1 && std::string(argv[1]) == "--help") {
+        std::cout << "Usage: wheel-emulator [--log-level N] [diagnostic mode]" << std::endl;
+        tools::PrintToolUsage();
+        return 0;
+    }
+
+    const tools::ToolMode* tool = tools::FindRequestedTool(argc, argv);
     LOG_INFO("main", "Starting wheel emulator (log level=" << log_level << ")");
 
-    if (!check_root()) {
+    if ((!tool || tool->needs_root) && !check_root()) {
         return 1;
     }
 
@@ -50,59 +60,30 @@ int main(int argc, char* argv[]) {
     sigemptyset(&sa.sa_mask);
     sigaction(SIGINT, &sa, nullptr);
 
+    if (tool) {
+        return tool->run(argc, argv);
+    }
+
     // Load configuration
     Config config;
     config.Load();
 
-    WheelDevice wheel_device;
-    wheel_device.SetFFBGain(config.ffb_gain);
-    if (!wheel_device.Create()) {
-        std::cerr << "Failed to create virtual wheel device" << std::endl;
-        return 1;
+    metrics::MetricsServer metrics_server(metrics::DefaultRegistry());
+    if (!config.metrics_socket.empty()) {
+        metrics_server.Start(config.metrics_socket);
     }
 
-    InputManager input_manager;
-    if (!input_manager.Initialize(config.keyboard_device, config.mouse_device)) {
-        std::cerr << "Failed to initialize input manager" << std::endl;
+    WheelServer server;
+    if (!server.Start(config)) {
         return 1;
     }
 
     std::cout << "All systems ready. Toggle to enable." << std::endl;
 
-    InputFrame frame;
-    while (running) {
-        if (!input_manager.WaitForFrame(frame)) {
-            if (!running) {
-                break;
-            }
-            continue;
-        }
-
-        if (wheel_device.IsEnabled() && !input_manager.AllRequiredGrabbed()) {
-            std::cerr << "Required input device lost; disabling emulator" << std::endl;
-            wheel_device.SetEnabled(false, input_manager);
-            continue;
-        }
-
-        if (frame.toggle_pressed) {
-            if (!input_manager.DevicesReady()) {
-                LOG_WARN("main", "Toggle pressed before devices ready; ignoring request");
-            } else {
-                wheel_device.ToggleEnabled(input_manager);
-            }
-        }
-
-        if (wheel_device.IsEnabled()) {
-            wheel_device.ProcessInputFrame(frame, config.sensitivity);
-        }
-
-    }
-    // On shutdown, notify all threads to wake up and exit
-    wheel_device.SetEnabled(false, input_manager);
-    wheel_device.NotifyAllShutdownCVs();
-    input_manager.Shutdown();
-    // Signal threads to exit before destruction
-    wheel_device.ShutdownThreads();
+    server.Run();
+    server.Shutdown();
+    metrics_server.Stop();
+    logging::ShutdownLogger();
     return 0;
 
 }
@@ -0,0 +1,179 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace metrics {
+namespace {
+
+std::string BaseName(const std::string& name) {
+    size_t brace = name.find('{');
+    return brace == std::string::npos ? name : name.substr(0, brace);
+}
+
+// Inserts an extra label into a possibly-labelled metric name.
+std::string WithLabel(const std::string& name, const std::string& suffix, const std::string& label) {
+    size_t brace = name.find('{');
+    if (brace == std::string::npos) {
+        return name + suffix + "{" + label + "}";
+    }
+    std::string base = name.substr(0, brace);
+    std::string labels = name.substr(brace + 1, name.size() - brace - 2);
+    return base + suffix + "{" + labels + "," + label + "}";
+}
+
+std::string WithSuffix(const std::string& name, const std::string& suffix) {
+    size_t brace = name.find('{');
+    if (brace == std::string::npos) {
+        return name + suffix;
+    }
+    return name.substr(0, brace) + suffix + name.substr(brace);
+}
+
+}  // namespace
+
+void Histogram::Observe(uint64_t value) {
+    size_t index = 0;
+    while (index < kBuckets && value > (1ULL << index)) {
+        ++index;
+    }
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+Registry::Entry* Registry::FindLocked(const std::string& name, Kind kind) {
+    for (auto& entry : entries_) {
+        if (entry.name == name && entry.kind == kind) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Counter& Registry::GetCounter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = FindLocked(name, Kind::Counter)) {
+        return *static_cast<Counter*>(existing->instrument);
+    }
+    counters_.emplace_back();
+    entries_.push_back({Kind::Counter, name, help, {}, &counters_.back()});
+    return counters_.back();
+}
+
+Gauge& Registry::GetGauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = FindLocked(name, Kind::Gauge)) {
+        return *static_cast<Gauge*>(existing->instrument);
+    }
+    gauges_.emplace_back();
+    entries_.push_back({Kind::Gauge, name, help, {}, &gauges_.back()});
+    return gauges_.back();
+}
+
+Histogram& Registry::GetHistogram(const std::string& name, const std::string& help, const std::string& unit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = FindLocked(name, Kind::Histogram)) {
+        return *static_cast<Histogram*>(existing->instrument);
+    }
+    histograms_.emplace_back();
+    entries_.push_back({Kind::Histogram, name, help, unit, &histograms_.back()});
+    return histograms_.back();
+}
+
+CounterFamily& Registry::GetCounterFamily(const std::string& name, const std::string& help,
+                                          const std::string& label, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = FindLocked(name, Kind::Family)) {
+        return *static_cast<CounterFamily*>(existing->instrument);
+    }
+    families_.push_back(std::make_unique<CounterFamily>(size));
+    entries_.push_back({Kind::Family, name, help, label, families_.back().get()});
+    return *families_.back();
+}
+
+std::string Registry::Render() const {
+    std::vector<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries = entries_;
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return BaseName(a.name) < BaseName(b.name);
+    });
+
+    std::string out;
+    std::string last_base;
+    for (const auto& entry : entries) {
+        std::string base = BaseName(entry.name);
+        if (base != last_base) {
+            const char* type = "counter";
+            if (entry.kind == Kind::Gauge) {
+                type = "gauge";
+            } else if (entry.kind == Kind::Histogram) {
+                type = "histogram";
+            }
+            std::string help = entry.help;
+            if (entry.kind == Kind::Histogram && !entry.extra.empty()) {
+                help += " (" + entry.extra + ")";
+            }
+            out += "# HELP " + base + " " + help + "\n";
+            out += "# TYPE " + base + " " + type + "\n";
+            last_base = base;
+        }
+
+        switch (entry.kind) {
+            case Kind::Counter:
+                out += entry.name + " " + std::to_string(static_cast<Counter*>(entry.instrument)->Value()) + "\n";
+                break;
+            case Kind::Gauge:
+                out += entry.name + " " + std::to_string(static_cast<Gauge*>(entry.instrument)->Value()) + "\n";
+                break;
+            case Kind::Histogram: {
+                const auto* histogram = static_cast<const Histogram*>(entry.instrument);
+                uint64_t cumulative = 0;
+                for (size_t i = 0; i < Histogram::kBuckets; ++i) {
+                    cumulative += histogram->BucketCount(i);
+                    out += WithLabel(entry.name, "_bucket", "le=\"" + std::to_string(1ULL << i) + "\"") + " " +
+                           std::to_string(cumulative) + "\n";
+                }
+                out += WithLabel(entry.name, "_bucket", "le=\"+Inf\"") + " " +
+                       std::to_string(histogram->Count()) + "\n";
+                out += WithSuffix(entry.name, "_sum") + " " + std::to_string(histogram->Sum()) + "\n";
+                out += WithSuffix(entry.name, "_count") + " " + std::to_string(histogram->Count()) + "\n";
+                break;
+            }
+            case Kind::Family: {
+                const auto* family = static_cast<const CounterFamily*>(entry.instrument);
+                for (size_t i = 0; i < family->size(); ++i) {
+                    uint64_t value = family->Value(i);
+                    if (value == 0) {
+                        continue;
+                    }
+                    char index[24];
+                    std::snprintf(index, sizeof(index), "0x%02zx", i);
+                    out += WithLabel(entry.name, "", entry.extra + "=\"" + index + "\"") + " " +
+                           std::to_string(value) + "\n";
+                }
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+Registry& DefaultRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+Counter& ThreadWakeups(const std::string& thread) {
+    return DefaultRegistry().GetCounter("wheel_thread_wakeups_total{thread=\"" + thread + "\"}",
+                                        "Returns from a thread's blocking wait");
+}
+
+std::string Labeled(const std::string& name, const std::string& labels) {
+    return labels.empty() ? name : name + "{" + labels + "}";
+}
+
+}  // namespace metrics
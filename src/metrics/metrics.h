@@ -0,0 +1,115 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+// All instruments are updated with relaxed atomics only; registration takes the
+// registry mutex once, after which call sites keep the returned reference.
+
+class Counter {
+public:
+    void Increment(uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Power-of-two buckets: bucket i counts observations <= 2^i (unit chosen by the caller).
+class Histogram {
+public:
+    static constexpr size_t kBuckets = 32;
+
+    void Observe(uint64_t value);
+    uint64_t BucketCount(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets + 1> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+// Counters indexed by a small integer (e.g. an FFB opcode byte), rendered as
+// name{label="0x.."} and only when non-zero.
+class CounterFamily {
+public:
+    explicit CounterFamily(size_t size) : values_(size) {}
+    void Increment(size_t index, uint64_t amount = 1) {
+        if (index < values_.size()) {
+            values_[index].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+    size_t size() const { return values_.size(); }
+    uint64_t Value(size_t index) const { return values_[index].load(std::memory_order_relaxed); }
+
+private:
+    std::vector<std::atomic<uint64_t>> values_;
+};
+
+class Registry {
+public:
+    // `name` may carry Prometheus labels, e.g. wheel_thread_wakeups_total{thread="ffb"}.
+    // Repeated calls with the same name return the same instrument.
+    Counter& GetCounter(const std::string& name, const std::string& help);
+    Gauge& GetGauge(const std::string& name, const std::string& help);
+    Histogram& GetHistogram(const std::string& name, const std::string& help, const std::string& unit);
+    CounterFamily& GetCounterFamily(const std::string& name, const std::string& help,
+                                    const std::string& label, size_t size);
+
+    // Prometheus text exposition of every registered instrument.
+    std::string Render() const;
+
+private:
+    enum class Kind { Counter, Gauge, Histogram, Family };
+    struct Entry {
+        Kind kind;
+        std::string name;
+        std::string help;
+        std::string extra;  // histogram unit or family label
+        void* instrument;
+    };
+
+    Entry* FindLocked(const std::string& name, Kind kind);
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    std::deque<Counter> counters_;
+    std::deque<Gauge> gauges_;
+    std::deque<Histogram> histograms_;
+    std::deque<std::unique_ptr<CounterFamily>> families_;
+};
+
+Registry& DefaultRegistry();
+
+// wheel_thread_wakeups_total{thread="<name>"}: one increment per return from the
+// thread's blocking wait. Its rate is the thread's wakeups per second, which should
+// fall to zero while the emulator is parked.
+Counter& ThreadWakeups(const std::string& thread);
+
+// `name{labels}`, or `name` when labels is empty (e.g. Labeled("x", "wheel=\"1\"")).
+std::string Labeled(const std::string& name, const std::string& labels);
+
+}  // namespace metrics
+
+#endif  // METRICS_H
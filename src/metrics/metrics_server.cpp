@@ -0,0 +1,157 @@
+#include "metrics_server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "../logging/logger.h"
+
+namespace metrics {
+namespace {
+constexpr const char* kTag = "metrics";
+
+bool EnsureParentDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos || slash == 0) {
+        return true;
+    }
+    std::string dir = path.substr(0, slash);
+    if (mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST) {
+        return true;
+    }
+    LOG_ERROR(kTag, "Cannot create " << dir << ": " << std::strerror(errno));
+    return false;
+}
+}  // namespace
+
+MetricsServer::MetricsServer(Registry& registry)
+        : registry_(registry), listen_fd_(-1), wake_fd_(-1), running_(false) {}
+
+MetricsServer::~MetricsServer() {
+    Stop();
+}
+
+bool MetricsServer::Start(const std::string& socket_path) {
+    if (running_.load(std::memory_order_acquire)) {
+        return true;
+    }
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR(kTag, "Invalid metrics socket path '" << socket_path << "'");
+        return false;
+    }
+    if (!EnsureParentDirectory(socket_path)) {
+        return false;
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR(kTag, "socket() failed: " << std::strerror(errno));
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 4) < 0) {
+        LOG_ERROR(kTag, "Cannot listen on " << socket_path << ": " << std::strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    chmod(socket_path.c_str(), 0660);
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    socket_path_ = socket_path;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&MetricsServer::ThreadMain, this);
+    LOG_INFO(kTag, "Serving metrics on " << socket_path_);
+    return true;
+}
+
+void MetricsServer::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    unlink(socket_path_.c_str());
+}
+
+void MetricsServer::ThreadMain() {
+    struct pollfd pfds[2];
+    pfds[0].fd = listen_fd_;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = wake_fd_;
+    pfds[1].events = POLLIN;
+    while (running_.load(std::memory_order_acquire)) {
+        pfds[0].revents = 0;
+        pfds[1].revents = 0;
+        int rc = poll(pfds, wake_fd_ >= 0 ? 2 : 1, -1);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR(kTag, "poll failed: " << std::strerror(errno));
+            break;
+        }
+        if (pfds[1].revents & POLLIN) {
+            break;
+        }
+        if (!(pfds[0].revents & POLLIN)) {
+            continue;
+        }
+        int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        ServeClient(client);
+        close(client);
+    }
+}
+
+void MetricsServer::ServeClient(int client_fd) {
+    // A stalled reader must not wedge the server thread.
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string body = registry_.Render();
+    size_t sent = 0;
+    while (sent < body.size()) {
+        ssize_t n = send(client_fd, body.data() + sent, body.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+}  // namespace metrics
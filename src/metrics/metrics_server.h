@@ -0,0 +1,39 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace metrics {
+
+class Registry;
+
+// Serves Registry::Render() as plain text to every client that connects to a Unix
+// stream socket, then closes the connection (scrape with `socat - UNIX:<path>`).
+class MetricsServer {
+public:
+    explicit MetricsServer(Registry& registry);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool Start(const std::string& socket_path);
+    void Stop();
+
+private:
+    void ThreadMain();
+    void ServeClient(int client_fd);
+
+    Registry& registry_;
+    std::string socket_path_;
+    int listen_fd_;
+    int wake_fd_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
+
+}  // namespace metrics
+
+#endif  // METRICS_SERVER_H
@@ -0,0 +1,170 @@
+#include "telemetry_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../logging/logger.h"
+
+namespace telemetry {
+namespace {
+constexpr const char* kTag = "telemetry";
+constexpr uint32_t kMinSlots = 16;
+constexpr uint32_t kMaxSlots = 1u << 20;
+
+uint32_t RoundUpPow2(uint32_t value) {
+    uint32_t result = kMinSlots;
+    while (result < value && result < kMaxSlots) {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace
+
+TelemetryWriter::TelemetryWriter()
+        : header_(nullptr), slots_(nullptr), map_size_(0), next_seq_(0), mask_(0) {}
+
+TelemetryWriter::~TelemetryWriter() {
+    Close();
+}
+
+bool TelemetryWriter::Open(const std::string& name, uint32_t slots) {
+    Close();
+    const uint32_t count = RoundUpPow2(slots);
+    const size_t size = sizeof(Header) + static_cast<size_t>(count) * sizeof(Slot);
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR(kTag, "shm_open(" << name << ") failed: " << std::strerror(errno));
+        return false;
+    }
+    // The umask may have stripped the read bits readers rely on.
+    fchmod(fd, 0644);
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        LOG_ERROR(kTag, "Cannot size " << name << ": " << std::strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOG_ERROR(kTag, "Cannot map " << name << ": " << std::strerror(errno));
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate() zero-filled the segment, so every slot already reads as unwritten.
+    header_ = static_cast<Header*>(map);
+    slots_ = reinterpret_cast<Slot*>(static_cast<uint8_t*>(map) + sizeof(Header));
+    header_->version = kVersion;
+    header_->header_size = sizeof(Header);
+    header_->slot_size = sizeof(Slot);
+    header_->slot_count = count;
+    header_->write_seq.store(0, std::memory_order_relaxed);
+    // Readers validate the magic last so they never see a half-initialized header.
+    std::atomic_thread_fence(std::memory_order_release);
+    reinterpret_cast<std::atomic<uint32_t>*>(&header_->magic)->store(kMagic, std::memory_order_release);
+
+    name_ = name;
+    map_size_ = size;
+    next_seq_ = 0;
+    mask_ = count - 1;
+    LOG_INFO(kTag, "Publishing telemetry to /dev/shm" << name_ << " (" << count << " slots)");
+    return true;
+}
+
+void TelemetryWriter::Close() {
+    if (!header_) {
+        return;
+    }
+    munmap(header_, map_size_);
+    shm_unlink(name_.c_str());
+    header_ = nullptr;
+    slots_ = nullptr;
+    map_size_ = 0;
+}
+
+void TelemetryWriter::Publish(const Record& record) {
+    if (!header_) {
+        return;
+    }
+    Slot& slot = slots_[next_seq_ & mask_];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.record, &record, sizeof(Record));
+    ++next_seq_;
+    slot.seq.store(next_seq_, std::memory_order_release);
+    header_->write_seq.store(next_seq_, std::memory_order_release);
+}
+
+TelemetryReader::TelemetryReader() : header_(nullptr), slots_(nullptr), map_size_(0) {}
+
+TelemetryReader::~TelemetryReader() {
+    Close();
+}
+
+bool TelemetryReader::Open(const std::string& name, std::string& error) {
+    Close();
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        error = "shm_open(" + name + "): " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        error = name + " is too small for a telemetry header";
+        close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        error = std::string("mmap: ") + std::strerror(errno);
+        return false;
+    }
+
+    const Header* header = static_cast<const Header*>(map);
+    const uint32_t magic =
+        reinterpret_cast<const std::atomic<uint32_t>*>(&header->magic)->load(std::memory_order_acquire);
+    const uint32_t count = header->slot_count;
+    if (magic != kMagic || header->version != kVersion || header->header_size != sizeof(Header) ||
+        header->slot_size != sizeof(Slot) || count == 0 || (count & (count - 1)) != 0 ||
+        size < sizeof(Header) + static_cast<size_t>(count) * sizeof(Slot)) {
+        error = name + " is not a version " + std::to_string(kVersion) + " telemetry segment";
+        munmap(map, size);
+        return false;
+    }
+
+    header_ = header;
+    slots_ = reinterpret_cast<const Slot*>(static_cast<const uint8_t*>(map) + sizeof(Header));
+    map_size_ = size;
+    return true;
+}
+
+void TelemetryReader::Close() {
+    if (!header_) {
+        return;
+    }
+    munmap(const_cast<Header*>(header_), map_size_);
+    header_ = nullptr;
+    slots_ = nullptr;
+    map_size_ = 0;
+}
+
+bool TelemetryReader::Read(uint64_t seq, Record& out) const {
+    const Slot& slot = slots_[seq & (header_->slot_count - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != seq + 1) {
+        return false;
+    }
+    std::memcpy(&out, &slot.record, sizeof(Record));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == seq + 1;
+}
+
+}  // namespace telemetry
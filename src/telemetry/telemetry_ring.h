@@ -0,0 +1,131 @@
+#ifndef TELEMETRY_RING_H
+#define TELEMETRY_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace telemetry {
+
+// Live wheel state in a POSIX shared-memory segment (/dev/shm/<name>), written by one
+// thread at a time and read by any number of processes without syscalls.
+//
+// Layout (little-endian, all offsets in bytes):
+//   [0, 64)               Header
+//   [64 + i * 64, ...)    Slot i, for i in [0, slot_count); slot_count is a power of two
+//
+// Record n (counting from 0) lives in slot n & (slot_count - 1). The writer
+//   1. stores slot.seq = 0 (record being rewritten),
+//   2. fills slot.record,
+//   3. stores slot.seq = n + 1 (release),
+//   4. stores header.write_seq = n + 1 (release).
+// A reader that wants record n loads slot.seq (acquire), copies the record, issues an
+// acquire fence and loads slot.seq again. The copy is valid only if both loads read
+// n + 1; anything else means the writer lapped the reader and the record is gone.
+// header.write_seq is the number of records published so far; a reader that starts
+// at write_seq sees only new records.
+constexpr uint32_t kMagic = 0x4c544857;  // "WHTL"
+constexpr uint16_t kVersion = 1;
+
+enum class RecordKind : uint32_t {
+    kState = 1,    // input committed to the wheel state (or the state reset to neutral)
+    kFFBTick = 2,  // FFBUpdateThread step; steering/ffb_* reflect the new physics state
+};
+
+struct Record {
+    int64_t time_ns;      // CLOCK_MONOTONIC (the virtual clock under --ffb-sim)
+    uint32_t kind;        // RecordKind
+    uint32_t buttons;     // bit i = WheelButton i pressed
+    float steering;       // reported axis, -32768..32767
+    float user_steering;  // mouse contribution
+    float ffb_offset;     // FFB contribution
+    float ffb_velocity;   // counts/s
+    float ffb_target;     // offset the physics model pulls toward (torque, in counts)
+    float throttle;       // 0-100
+    float brake;          // 0-100
+    float clutch;         // 0-100
+    int8_t dpad_x;        // -1, 0, 1
+    int8_t dpad_y;
+    uint8_t enabled;      // emulation on and output flowing
+    uint8_t reserved0;
+    uint32_t reserved1;
+};
+static_assert(sizeof(Record) == 56, "telemetry record layout is part of the shared format");
+
+struct Slot {
+    std::atomic<uint64_t> seq;  // n + 1 once record n is complete, 0 while being written
+    Record record;
+};
+static_assert(sizeof(Slot) == 64, "one slot per cache line");
+static_assert(offsetof(Slot, record) == 8, "record follows the sequence counter");
+
+struct Header {
+    uint32_t magic;        // kMagic
+    uint16_t version;      // kVersion
+    uint16_t header_size;  // sizeof(Header); first slot starts here
+    uint32_t slot_size;    // sizeof(Slot)
+    uint32_t slot_count;   // power of two
+    std::atomic<uint64_t> write_seq;  // records published
+    uint8_t reserved[40];
+};
+static_assert(sizeof(Header) == 64, "header occupies one cache line");
+static_assert(offsetof(Header, write_seq) == 16, "write_seq offset is part of the shared format");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+// Owns the segment; Publish() must be serialized by the caller (WheelDevice holds
+// state_mutex). Publishing is two relaxed/release stores plus a 56-byte copy.
+class TelemetryWriter {
+public:
+    TelemetryWriter();
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    // `name` is a shm_open() name such as "/wheel-emulator"; `slots` is rounded up to
+    // a power of two. Any existing segment with that name is replaced.
+    bool Open(const std::string& name, uint32_t slots);
+    void Close();  // unlinks the segment
+    bool is_open() const { return header_ != nullptr; }
+
+    void Publish(const Record& record);
+
+private:
+    std::string name_;
+    Header* header_;
+    Slot* slots_;
+    size_t map_size_;
+    uint64_t next_seq_;
+    uint32_t mask_;
+};
+
+// Read-only view of a segment created by TelemetryWriter.
+class TelemetryReader {
+public:
+    TelemetryReader();
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    // Fails if the segment is missing or its header does not match this build.
+    bool Open(const std::string& name, std::string& error);
+    void Close();
+
+    uint64_t WriteSeq() const { return header_->write_seq.load(std::memory_order_acquire); }
+    uint32_t slot_count() const { return header_->slot_count; }
+
+    // Copies record `seq` (0-based). Returns false if it has been overwritten or is
+    // still being written.
+    bool Read(uint64_t seq, Record& out) const;
+
+private:
+    const Header* header_;
+    const Slot* slots_;
+    size_t map_size_;
+};
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_RING_H
@@ -0,0 +1,151 @@
+#include "tools.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tool_common.h"
+#include "../config.h"
+#include "../ffb/effect_engine.h"
+#include "../ffb/torque_curve.h"
+
+namespace tools {
+namespace {
+
+constexpr const char* kDefaultConfigPath = "/etc/wheel-emulator.conf";
+
+// The piecewise curve ShapeFFBTorque evaluated before the table existed; kept only as
+// the benchmark baseline and to report how far the default points drift from it.
+float LegacyShapeTorque(float raw_force) {
+    float abs_force = std::fabs(raw_force);
+    if (abs_force < 80.0f) {
+        return raw_force * (abs_force / 80.0f);
+    }
+    const float min_gain = 0.25f;
+    const float slip_knee = 4000.0f;
+    const float slip_full = 14000.0f;
+    float t = std::clamp((abs_force - 80.0f) / (slip_full - 80.0f), 0.0f, 1.0f);
+    float gain = min_gain + t * t * (1.0f - min_gain);
+    if (abs_force > slip_knee) {
+        float heavy = std::clamp((abs_force - slip_knee) / (slip_full - slip_knee), 0.0f, 1.0f);
+        gain = min_gain + (1.0f - min_gain) * heavy;
+    }
+    return raw_force * gain * 3.0f;
+}
+
+// --curve wins, then the config file (--config or /etc), then the built-in default.
+bool ResolveCurve(int argc, char* argv[], std::vector<ffb::CurvePoint>& points, std::string& source) {
+    const std::string text = StringArg(argc, argv, "curve", "");
+    if (!text.empty()) {
+        std::string error;
+        if (!ffb::ParseCurvePoints(text, points, error)) {
+            std::cerr << "Invalid --curve: " << error << std::endl;
+            return false;
+        }
+        source = "--curve";
+        return true;
+    }
+    const std::string path = StringArg(argc, argv, "config", kDefaultConfigPath);
+    Config config;
+    if (config.LoadFromFile(path.c_str())) {
+        points = config.ffb_curve;
+        source = path;
+        return true;
+    }
+    points = ffb::DefaultCurvePoints();
+    source = "built-in default";
+    return true;
+}
+
+template <typename Fn>
+double NanosPerCall(const std::vector<float>& inputs, int iterations, Fn&& fn) {
+    volatile float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < iterations; ++round) {
+        float acc = 0.0f;
+        for (float value : inputs) {
+            acc += fn(value);
+        }
+        sink = sink + acc;
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (static_cast<double>(inputs.size()) * iterations);
+}
+
+}  // namespace
+
+int RunFFBCurveDump(int argc, char* argv[]) {
+    std::vector<ffb::CurvePoint> points;
+    std::string source;
+    if (!ResolveCurve(argc, argv, points, source)) {
+        return 1;
+    }
+    ffb::TorqueCurve curve(points);
+    const int max_force = IntArg(argc, argv, "max", static_cast<int>(ffb::kEffectSlots * ffb::kFullScaleForce));
+    const int step = std::max(1, IntArg(argc, argv, "step", 250));
+
+    std::cout << "# curve from " << source << ": " << ffb::FormatCurvePoints(curve.points()) << std::endl;
+    std::cout << "force,output,gain,legacy_output" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int force = 0; force <= max_force; force += step) {
+        float output = curve.Apply(static_cast<float>(force));
+        float gain = force > 0 ? output / static_cast<float>(force) : 0.0f;
+        std::cout << force << "," << output << "," << std::setprecision(4) << gain << std::setprecision(1) << ","
+                  << LegacyShapeTorque(static_cast<float>(force)) << std::endl;
+    }
+    return 0;
+}
+
+int RunFFBCurveBench(int argc, char* argv[]) {
+    std::vector<ffb::CurvePoint> points;
+    std::string source;
+    if (!ResolveCurve(argc, argv, points, source)) {
+        return 1;
+    }
+    ffb::TorqueCurve curve(points);
+    const int iterations = std::max(1, IntArg(argc, argv, "iterations", 2000));
+
+    // Forces spread over everything four saturated slots can command, both signs.
+    const float span = ffb::kEffectSlots * ffb::kFullScaleForce;
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> dist(-span, span);
+    std::vector<float> inputs(4096);
+    for (auto& value : inputs) {
+        value = dist(rng);
+    }
+
+    double legacy_ns = NanosPerCall(inputs, iterations, LegacyShapeTorque);
+    double table_ns = NanosPerCall(inputs, iterations, [&](float f) { return curve.Apply(f); });
+    double direct_ns = NanosPerCall(inputs, iterations, [&](float f) { return std::copysign(curve.Evaluate(std::fabs(f)), f); });
+
+    float table_error = 0.0f;
+    float legacy_drift = 0.0f;
+    float drift_at = 0.0f;
+    for (float force = 0.0f; force <= span; force += 0.5f) {
+        float shaped = curve.Apply(force);
+        table_error = std::max(table_error, std::fabs(shaped - curve.Evaluate(force)));
+        float drift = std::fabs(shaped - LegacyShapeTorque(force));
+        if (drift > legacy_drift) {
+            legacy_drift = drift;
+            drift_at = force;
+        }
+    }
+
+    std::cout << "Curve (" << source << "): " << ffb::FormatCurvePoints(curve.points()) << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  legacy piecewise:     " << legacy_ns << " ns/call" << std::endl;
+    std::cout << "  control-point search: " << direct_ns << " ns/call" << std::endl;
+    std::cout << "  compiled table:       " << table_ns << " ns/call (" << ffb::TorqueCurve::kTableSize
+              << " entries)" << std::endl;
+    std::cout << "  table vs control points: max |error| " << table_error << std::endl;
+    std::cout << "  table vs legacy curve:   max |diff| " << legacy_drift << " at force " << drift_at << std::endl;
+    return 0;
+}
+
+}  // namespace tools
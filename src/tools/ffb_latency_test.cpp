@@ -0,0 +1,187 @@
+#include "tools.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "loopback_rig.h"
+#include "tool_common.h"
+#include "../wheel_device.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+constexpr int kResponseTimeoutMs = 500;
+constexpr int kSettleWindowMs = 50;
+constexpr int kSettleLimitMs = 1500;
+constexpr int32_t kSettleTolerance = 8;
+
+constexpr std::array<uint8_t, 7> kAutocenterOff = {0xf5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+constexpr std::array<uint8_t, 7> kAutocenterStrong = {0xfe, 0x0d, 0xff, 0xff, 0x80, 0x00, 0x00};
+constexpr std::array<uint8_t, 7> kStopForce = {0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+std::array<uint8_t, 7> ConstantForcePacket(int direction) {
+    // Host force byte is centred on 0x80; the effect table negates it, so a low byte pushes positive.
+    uint8_t level = static_cast<uint8_t>(direction > 0 ? 0x30 : 0xd0);
+    return {0x11, 0x08, level, 0x80, 0x00, 0x00, 0x00};
+}
+
+struct CommandStats {
+    LatencyStats total;
+    LatencyStats host_to_parse;
+    LatencyStats parse_to_tick;
+    LatencyStats tick_to_report;
+    LatencyStats report_to_host;
+    int misses = 0;
+};
+
+class FFBSession {
+public:
+    explicit FFBSession(LoopbackRig& rig) : rig_(rig) {}
+
+    int32_t steering() const { return steering_; }
+
+    // Lets the steering model come to rest; returns false if it keeps moving.
+    bool Settle() {
+        hid::WheelReport report{};
+        int64_t arrival_ns = 0;
+        int64_t start_ns = MonotonicNowNs();
+        int64_t anchor_ns = start_ns;
+        int32_t anchor = steering_;
+        while (MonotonicNowNs() - start_ns < kSettleLimitMs * 1000000LL) {
+            if (!rig_.ReadReport(report, arrival_ns, kSettleWindowMs)) {
+                return true;
+            }
+            steering_ = LoopbackRig::SteeringFromReport(report);
+            if (arrival_ns - anchor_ns >= kSettleWindowMs * 1000000LL) {
+                if (std::abs(steering_ - anchor) < kSettleTolerance) {
+                    return true;
+                }
+                anchor = steering_;
+                anchor_ns = arrival_ns;
+            }
+        }
+        return false;
+    }
+
+    // Sends packet and records how long until an IN report satisfies reached(steering).
+    void Measure(const std::array<uint8_t, 7>& packet,
+                 const std::function<bool(int32_t)>& reached,
+                 CommandStats& stats) {
+        WheelDevice::FFBTiming before = rig_.wheel().GetFFBTiming();
+        int64_t sent_ns = MonotonicNowNs();
+        if (!rig_.WriteOutputReport(packet)) {
+            ++stats.misses;
+            return;
+        }
+
+        hid::WheelReport report{};
+        int64_t arrival_ns = 0;
+        int64_t deadline_ns = sent_ns + kResponseTimeoutMs * 1000000LL;
+        while (MonotonicNowNs() < deadline_ns) {
+            if (!rig_.ReadReport(report, arrival_ns, kResponseTimeoutMs)) {
+                break;
+            }
+            steering_ = LoopbackRig::SteeringFromReport(report);
+            if (!reached(steering_)) {
+                continue;
+            }
+            stats.total.Add(arrival_ns - sent_ns);
+            WheelDevice::FFBTiming after = rig_.wheel().GetFFBTiming();
+            if (after.command_seq != before.command_seq && after.parsed_ns >= sent_ns &&
+                after.applied_ns >= after.parsed_ns && after.reported_ns >= after.applied_ns) {
+                stats.host_to_parse.Add(after.parsed_ns - sent_ns);
+                stats.parse_to_tick.Add(after.applied_ns - after.parsed_ns);
+                stats.tick_to_report.Add(after.reported_ns - after.applied_ns);
+                stats.report_to_host.Add(arrival_ns - after.reported_ns);
+            }
+            return;
+        }
+        ++stats.misses;
+    }
+
+private:
+    LoopbackRig& rig_;
+    int32_t steering_ = 0;
+};
+
+void PrintCommandStats(const std::string& name, const CommandStats& stats) {
+    stats.total.Print(std::cout, "  " + name + " write->report");
+    stats.host_to_parse.Print(std::cout, "    host write->FFB mailbox");
+    stats.parse_to_tick.Print(std::cout, "    FFB mailbox->FFBUpdateThread");
+    stats.tick_to_report.Print(std::cout, "    FFBUpdateThread->report write");
+    stats.report_to_host.Print(std::cout, "    report write->host read");
+    std::cout << "    missed: " << stats.misses << std::endl;
+}
+
+}  // namespace
+
+int RunFFBLatencyTest(int argc, char* argv[]) {
+    const int samples = IntArg(argc, argv, "samples", 20);
+    const int32_t threshold = IntArg(argc, argv, "threshold", 32);
+    const std::vector<int> tick_rates = IntListArg(argc, argv, "tick-rates", {250, 500, 1000, 2000});
+
+    LoopbackRig::Options options;
+    options.ffb_tick_hz = tick_rates.front();
+    LoopbackRig rig;
+    if (!rig.Start(options)) {
+        std::cerr << "Loopback rig failed to start" << std::endl;
+        return 1;
+    }
+    std::cout << "Loopback host node: " << rig.hidraw_path() << std::endl;
+    rig.DrainReports(200);
+
+    bool any_samples = false;
+    for (int tick_hz : tick_rates) {
+        if (!running.load(std::memory_order_relaxed)) {
+            break;
+        }
+        rig.wheel().SetFFBTickRate(tick_hz);
+        FFBSession session(rig);
+        rig.WriteOutputReport(kAutocenterOff);
+        rig.WriteOutputReport(kStopForce);
+        session.Settle();
+
+        CommandStats constant;
+        CommandStats autocenter;
+        CommandStats stop;
+        for (int i = 0; i < samples && running.load(std::memory_order_relaxed); ++i) {
+            const int direction = (i % 2 == 0) ? 1 : -1;
+            const int32_t base = session.steering();
+            session.Measure(ConstantForcePacket(direction),
+                            [&](int32_t s) { return direction * (s - base) >= threshold; },
+                            constant);
+            session.Settle();
+
+            const int32_t loaded = std::abs(session.steering());
+            session.Measure(kAutocenterStrong,
+                            [&](int32_t s) { return std::abs(s) <= loaded - threshold; },
+                            autocenter);
+            rig.WriteOutputReport(kAutocenterOff);
+            session.Settle();
+
+            const int32_t released = std::abs(session.steering());
+            session.Measure(kStopForce,
+                            [&](int32_t s) { return std::abs(s) <= released - threshold; },
+                            stop);
+            session.Settle();
+        }
+
+        std::cout << "FFB tick rate " << tick_hz << " Hz:" << std::endl;
+        PrintCommandStats("0x11 constant force", constant);
+        PrintCommandStats("0xfe autocenter", autocenter);
+        PrintCommandStats("0x13 stop", stop);
+        any_samples = any_samples || constant.total.Count() > 0;
+    }
+
+    rig.Stop();
+    return any_samples ? 0 : 1;
+}
+
+}  // namespace tools
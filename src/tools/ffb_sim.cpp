@@ -0,0 +1,211 @@
+#include "tools.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "tool_common.h"
+#include "loopback_rig.h"
+#include "../config.h"
+#include "../wheel_device.h"
+#include "../ffb/trace.h"
+#include "../metrics/metrics.h"
+#include "../util/clock.h"
+
+namespace tools {
+namespace {
+
+constexpr const char* kDefaultConfigPath = "/etc/wheel-emulator.conf";
+constexpr int64_t kNsPerMs = 1000000;
+constexpr int64_t kNsPerSecond = 1000000000;
+// Simulated time keeps running this long after the last trace packet so the rim settles.
+constexpr int64_t kTraceSettleNs = kNsPerSecond;
+
+// Deterministic stand-in for a racing game when no recorded trace is given: a road
+// force streamed on slot 0 at 250 Hz, a centering spring on slot 1, and a short
+// rumble on slot 2 every few seconds.
+class SyntheticTraffic {
+public:
+    SyntheticTraffic(int64_t duration_ns, uint32_t seed) : duration_ns_(duration_ns), rng_(seed) {}
+
+    bool Next(ffb::TraceRecord& record) {
+        if (!spring_sent_) {
+            spring_sent_ = true;
+            record.time_ns = 0;
+            record.packet = {0x21, 0x0b, 0x7c, 0x83, 0x33, 0x00, 0xc0};
+            return true;
+        }
+        if (rumble_stop_ns_ >= 0 && rumble_stop_ns_ <= next_level_ns_) {
+            record.time_ns = rumble_stop_ns_;
+            record.packet = {0x43, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+            rumble_stop_ns_ = -1;
+            return true;
+        }
+        if (next_level_ns_ >= duration_ns_) {
+            return false;
+        }
+        record.time_ns = next_level_ns_;
+        if (next_level_ns_ >= next_rumble_ns_) {
+            record.packet = {0x41, 0x0a, 0x28, 0x0a, 0x0a, 0x00, 0x00};
+            rumble_stop_ns_ = next_rumble_ns_ + 300 * kNsPerMs;
+            next_rumble_ns_ += 7 * kNsPerSecond;
+            return true;
+        }
+        double t = static_cast<double>(next_level_ns_) / kNsPerSecond;
+        double level = 0x80 + 60.0 * std::sin(2.0 * M_PI * 0.3 * t) + 18.0 * std::sin(2.0 * M_PI * 2.7 * t) +
+                       noise_(rng_);
+        uint8_t op = level_started_ ? 0x1c : 0x11;
+        level_started_ = true;
+        record.packet = {op, 0x00, static_cast<uint8_t>(std::clamp(level, 0.0, 255.0)), 0x00, 0x00, 0x00, 0x00};
+        next_level_ns_ += 4 * kNsPerMs;
+        return true;
+    }
+
+private:
+    int64_t duration_ns_;
+    std::mt19937 rng_;
+    std::normal_distribution<double> noise_{0.0, 4.0};
+    bool spring_sent_ = false;
+    bool level_started_ = false;
+    int64_t next_level_ns_ = 0;
+    int64_t next_rumble_ns_ = 3 * kNsPerSecond;
+    int64_t rumble_stop_ns_ = -1;
+};
+
+}  // namespace
+
+int RunFFBSimulation(int argc, char* argv[]) {
+    const std::string trace_path = StringArg(argc, argv, "trace", "");
+    const std::string trajectory_path = StringArg(argc, argv, "trajectory", "");
+    const int duration_s = std::max(1, IntArg(argc, argv, "duration-s", 3600));
+    const int sample_ms = std::max(1, IntArg(argc, argv, "sample-ms", 10));
+
+    Config config;
+    const std::string config_path = StringArg(argc, argv, "config", kDefaultConfigPath);
+    if (!config.LoadFromFile(config_path.c_str())) {
+        config.ffb_gain = 1.0f;
+    }
+    const int tick_hz = std::clamp(IntArg(argc, argv, "tick-rate", config.ffb_tick_rate), 100, 4000);
+
+    ffb::TraceReader reader;
+    if (!trace_path.empty() && !reader.Open(trace_path)) {
+        std::cerr << "Cannot open trace " << trace_path << std::endl;
+        return 1;
+    }
+    SyntheticTraffic synthetic(static_cast<int64_t>(duration_s) * kNsPerSecond, 12345);
+    auto next_packet = [&](ffb::TraceRecord& record) {
+        return trace_path.empty() ? synthetic.Next(record) : reader.Next(record);
+    };
+
+    std::ofstream trajectory;
+    if (!trajectory_path.empty()) {
+        trajectory.open(trajectory_path);
+        if (!trajectory) {
+            std::cerr << "Cannot write " << trajectory_path << std::endl;
+            return 1;
+        }
+        trajectory << "time_ms,steering" << std::endl;
+    }
+
+    // Virtual time starts away from zero so "never stamped" timestamps stay distinguishable.
+    util::VirtualClock clock(kNsPerSecond);
+    int32_t steering = 0;
+    uint64_t reports = 0;
+    WheelDevice wheel;
+    wheel.SetClock(&clock);
+    wheel.SetReportSink([&](const hid::WheelReport& report) {
+        steering = LoopbackRig::SteeringFromReport(report);
+        ++reports;
+        return true;
+    });
+    wheel.SetFFBGain(config.ffb_gain);
+    wheel.SetFFBTickRate(tick_hz);
+    wheel.SetFFBCurve(config.ffb_curve);
+    wheel.SetFFBPhysics(config.ffb_physics);
+    wheel.EnableSimulation();
+
+    metrics::Counter& physics_steps =
+        metrics::DefaultRegistry().GetCounter("wheel_ffb_physics_steps_total", "Fixed integration steps run by the steering model");
+    const uint64_t steps_before = physics_steps.Value();
+    metrics::Counter& suppressed = metrics::DefaultRegistry().GetCounter(
+        "wheel_reports_suppressed_total", "Reports not written because they matched the last report sent");
+    const uint64_t suppressed_before = suppressed.Value();
+
+    std::cout << "FFB simulation: " << (trace_path.empty() ? "synthetic traffic" : trace_path) << ", tick "
+              << tick_hz << " Hz, physics " << config.ffb_physics.step_hz << " Hz, gain " << config.ffb_gain
+              << std::endl;
+
+    const int64_t tick_ns = kNsPerSecond / tick_hz;
+    const int64_t sample_ns = sample_ms * kNsPerMs;
+    ffb::TraceRecord pending;
+    bool have_pending = next_packet(pending);
+    int64_t end_ns = trace_path.empty() ? static_cast<int64_t>(duration_s) * kNsPerSecond : 0;
+    uint64_t packets = 0;
+    uint64_t ticks = 0;
+    uint64_t settled_ticks = 0;
+    int32_t min_steering = 0;
+    int32_t max_steering = 0;
+    double abs_sum = 0.0;
+    LatencyStats tick_cost;
+    int64_t next_sample_ns = 0;
+
+    const int64_t wall_start = MonotonicNowNs();
+    for (int64_t sim_ns = 0; have_pending || sim_ns < end_ns; sim_ns += tick_ns) {
+        clock.Advance(tick_ns);
+        while (have_pending && pending.time_ns <= sim_ns) {
+            wheel.InjectOutputReport(pending.packet.data(), pending.packet.size());
+            ++packets;
+            end_ns = std::max(end_ns, pending.time_ns + (trace_path.empty() ? 0 : kTraceSettleNs));
+            have_pending = next_packet(pending);
+        }
+
+        const int64_t start = MonotonicNowNs();
+        if (!wheel.StepFFB()) {
+            ++settled_ticks;
+        }
+        wheel.EmitPendingReport();
+        tick_cost.Add(MonotonicNowNs() - start);
+        ++ticks;
+
+        min_steering = std::min(min_steering, steering);
+        max_steering = std::max(max_steering, steering);
+        abs_sum += std::abs(steering);
+        if (trajectory.is_open() && sim_ns >= next_sample_ns) {
+            trajectory << sim_ns / kNsPerMs << "," << steering << "\n";
+            next_sample_ns += sample_ns;
+        }
+    }
+    const int64_t wall_ns = MonotonicNowNs() - wall_start;
+    const uint64_t steps = physics_steps.Value() - steps_before;
+    const double sim_s = static_cast<double>(ticks) * tick_ns / kNsPerSecond;
+    const double wall_s = static_cast<double>(wall_ns) / kNsPerSecond;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Simulated " << sim_s << " s in " << wall_s << " s wall (" << (wall_s > 0.0 ? sim_s / wall_s : 0.0)
+              << "x real time)" << std::endl;
+    std::cout << "  packets injected: " << packets;
+    if (!trace_path.empty()) {
+        std::cout << " (" << reader.skipped() << " malformed lines skipped)";
+    }
+    std::cout << std::endl;
+    std::cout << "  ticks: " << ticks << " (" << settled_ticks << " settled, where the FFB thread would park)"
+              << ", physics steps: " << steps << ", reports: " << reports << " (" << suppressed.Value() - suppressed_before
+              << " duplicates suppressed)" << std::endl;
+    std::cout << "  steering: min " << min_steering << " max " << max_steering << " mean |s| "
+              << (ticks ? abs_sum / static_cast<double>(ticks) : 0.0) << std::endl;
+    tick_cost.Print(std::cout, "  cost per tick");
+    std::cout << std::fixed << std::setprecision(1) << "  cost per physics step (amortized): "
+              << (steps ? static_cast<double>(wall_ns) / static_cast<double>(steps) : 0.0) << " ns" << std::endl;
+    if (trajectory.is_open()) {
+        std::cout << "  trajectory written to " << trajectory_path << std::endl;
+    }
+    return 0;
+}
+
+}  // namespace tools
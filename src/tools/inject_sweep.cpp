@@ -0,0 +1,120 @@
+#include "tools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "tool_common.h"
+#include "../config.h"
+#include "../input/injection_channel.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+constexpr const char* kDefaultConfigPath = "/etc/wheel-emulator.conf";
+constexpr double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+// Drives one [inject] lane of a running emulator with a steering sine (absolute
+// positions, or the equivalent per-message deltas with --deltas), optionally holding
+// the throttle, then releases everything. Doubles as a reference producer.
+int RunInjectSweep(int argc, char* argv[]) {
+    std::string name = StringArg(argc, argv, "shm", "");
+    if (name.empty()) {
+        Config config;
+        if (config.LoadFromFile(StringArg(argc, argv, "config", kDefaultConfigPath).c_str())) {
+            name = config.inject_shm;
+        }
+    }
+    if (name.empty()) {
+        std::cerr << "No injection segment: pass --shm=NAME or set [inject] shm= in the config" << std::endl;
+        return 1;
+    }
+    if (name[0] != '/') {
+        name.insert(name.begin(), '/');
+    }
+    const std::string lane = StringArg(argc, argv, "lane", "external");
+
+    inject::Producer producer;
+    std::string error;
+    if (!producer.Open(name, lane, error)) {
+        std::cerr << "Cannot open injection lane: " << error << std::endl;
+        return 1;
+    }
+
+    const int rate = std::clamp(IntArg(argc, argv, "rate", 1000), 1, 20000);
+    const int duration_ms = std::max(1, IntArg(argc, argv, "duration-ms", 5000));
+    const double amplitude = std::clamp(IntArg(argc, argv, "amplitude", 8000), 0, 32767);
+    const double period_s = std::max(10, IntArg(argc, argv, "period-ms", 2000)) / 1000.0;
+    const int throttle = IntArg(argc, argv, "throttle", -1);
+    const bool deltas = HasFlag(argc, argv, "deltas");
+
+    std::cout << "Injecting into " << name << " lane '" << lane << "' at " << rate << " Hz for " << duration_ms
+              << " ms (" << (deltas ? "steering deltas" : "absolute steering") << ")" << std::endl;
+
+    LatencyStats push_cost;
+    push_cost.Reserve(static_cast<size_t>(rate) * duration_ms / 1000 + 1);
+    uint64_t sent = 0;
+    uint64_t full = 0;
+    double last_position = 0.0;
+    const int64_t period_ns = 1000000000LL / rate;
+    const int64_t start_ns = MonotonicNowNs();
+    int64_t next_ns = start_ns;
+    while (running.load(std::memory_order_relaxed)) {
+        const int64_t now_ns = MonotonicNowNs();
+        if (now_ns - start_ns >= int64_t{duration_ms} * 1000000) {
+            break;
+        }
+        const double position = amplitude * std::sin(2.0 * kPi * (now_ns - start_ns) * 1e-9 / period_s);
+
+        inject::Message message{};
+        message.time_ns = now_ns;
+        if (deltas) {
+            message.set = inject::kSteeringDelta;
+            message.steering_delta = static_cast<float>(position - last_position);
+        } else {
+            message.set = inject::kSteering;
+            message.steering = static_cast<float>(position);
+        }
+        if (throttle >= 0) {
+            message.set |= inject::kThrottle;
+            message.throttle = static_cast<uint8_t>(std::min(throttle, 100));
+        }
+
+        const int64_t before_ns = MonotonicNowNs();
+        if (producer.Push(message)) {
+            push_cost.Add(MonotonicNowNs() - before_ns);
+            last_position = position;
+            ++sent;
+        } else {
+            ++full;
+        }
+
+        next_ns += period_ns;
+        const int64_t sleep_ns = next_ns - MonotonicNowNs();
+        if (sleep_ns > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+        }
+    }
+
+    inject::Message release{};
+    release.time_ns = MonotonicNowNs();
+    release.release = inject::kSteering | inject::kThrottle;
+    if (!producer.Push(release)) {
+        std::cerr << "Lane full; the release was not delivered" << std::endl;
+    }
+
+    std::cout << "sent=" << sent << " lane_full=" << full << std::endl;
+    push_cost.Print(std::cout, "push cost");
+    return full == 0 ? 0 : 2;
+}
+
+}  // namespace tools
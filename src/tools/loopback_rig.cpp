@@ -0,0 +1,230 @@
+#include "loopback_rig.h"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+#include "tool_common.h"
+#include "../input/input_manager.h"
+#include "../logging/logger.h"
+#include "../wheel_device.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+constexpr const char* kTag = "loopback";
+constexpr const char* kG29HidId = "HID_ID=0003:0000046D:0000C24F";
+}
+
+LoopbackRig::LoopbackRig() : pump_running_(false), hidraw_fd_(-1) {}
+
+LoopbackRig::~LoopbackRig() {
+    Stop();
+}
+
+bool LoopbackRig::Start(const Options& options) {
+    options_ = options;
+    if (!keyboard_.Create(UinputDevice::Kind::Keyboard, "wheel-emulator loopback keyboard") ||
+        !mouse_.Create(UinputDevice::Kind::Mouse, "wheel-emulator loopback mouse")) {
+        return false;
+    }
+
+    wheel_ = std::make_unique<WheelDevice>();
+    wheel_->SetFFBGain(options.ffb_gain);
+    wheel_->SetFFBTickRate(options.ffb_tick_hz);
+    if (!wheel_->Create()) {
+        LOG_ERROR(kTag, "Failed to create gadget; loopback needs dummy_hcd");
+        return false;
+    }
+
+    input_manager_ = std::make_unique<InputManager>();
+    if (!input_manager_->Initialize(keyboard_.event_path(), mouse_.event_path())) {
+        LOG_ERROR(kTag, "Failed to attach synthetic devices");
+        return false;
+    }
+
+    pump_running_.store(true, std::memory_order_release);
+    pump_thread_ = std::thread(&LoopbackRig::PumpFrames, this);
+
+    wheel_->SetEnabled(true, *input_manager_);
+    if (!wheel_->IsEnabled()) {
+        LOG_ERROR(kTag, "Emulation did not enable");
+        return false;
+    }
+
+    if (!OpenHidraw(options.hidraw_wait_ms)) {
+        LOG_ERROR(kTag, "No host-side hidraw node for the gadget; is the UDC dummy_udc?");
+        return false;
+    }
+    LOG_INFO(kTag, "Loopback host node " << hidraw_path_);
+    return true;
+}
+
+void LoopbackRig::Stop() {
+    if (hidraw_fd_ >= 0) {
+        close(hidraw_fd_);
+        hidraw_fd_ = -1;
+    }
+    if (wheel_ && input_manager_) {
+        wheel_->SetEnabled(false, *input_manager_);
+    }
+    pump_running_.store(false, std::memory_order_release);
+    if (wheel_) {
+        wheel_->NotifyAllShutdownCVs();
+    }
+    if (input_manager_) {
+        input_manager_->Shutdown();
+    }
+    if (pump_thread_.joinable()) {
+        pump_thread_.join();
+    }
+    if (wheel_) {
+        wheel_->ShutdownThreads();
+    }
+    input_manager_.reset();
+    wheel_.reset();
+    keyboard_.Destroy();
+    mouse_.Destroy();
+}
+
+void LoopbackRig::PumpFrames() {
+    InputFrame frame;
+    while (pump_running_.load(std::memory_order_acquire) && running.load(std::memory_order_relaxed)) {
+        if (!input_manager_->WaitForFrame(frame)) {
+            continue;
+        }
+        if (wheel_->IsEnabled()) {
+            wheel_->ProcessInputFrame(frame, options_.sensitivity);
+        }
+    }
+}
+
+std::string LoopbackRig::FindLoopbackHidraw() {
+    DIR* dir = opendir("/sys/class/hidraw");
+    if (!dir) {
+        return {};
+    }
+    std::string fallback;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (std::strncmp(entry->d_name, "hidraw", 6) != 0) {
+            continue;
+        }
+        const std::string sys_path = std::string("/sys/class/hidraw/") + entry->d_name;
+        std::ifstream uevent(sys_path + "/device/uevent");
+        std::string line;
+        bool is_g29 = false;
+        while (std::getline(uevent, line)) {
+            if (line == kG29HidId) {
+                is_g29 = true;
+                break;
+            }
+        }
+        if (!is_g29) {
+            continue;
+        }
+        // A real G29 may be plugged in too; prefer the node hanging off dummy_hcd.
+        std::string node = std::string("/dev/") + entry->d_name;
+        char resolved[PATH_MAX];
+        if (realpath(sys_path.c_str(), resolved) && std::strstr(resolved, "dummy_hcd")) {
+            closedir(dir);
+            return node;
+        }
+        if (fallback.empty()) {
+            fallback = node;
+        }
+    }
+    closedir(dir);
+    return fallback;
+}
+
+bool LoopbackRig::OpenHidraw(int wait_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+    while (std::chrono::steady_clock::now() < deadline && running.load(std::memory_order_relaxed)) {
+        std::string path = FindLoopbackHidraw();
+        if (!path.empty()) {
+            hidraw_fd_ = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (hidraw_fd_ >= 0) {
+                hidraw_path_ = path;
+                return true;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+bool LoopbackRig::ReadReport(hid::WheelReport& report, int64_t& arrival_ns, int timeout_ms) {
+    if (hidraw_fd_ < 0) {
+        return false;
+    }
+    struct pollfd pfd;
+    pfd.fd = hidraw_fd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    while (true) {
+        int rc = poll(&pfd, 1, timeout_ms);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            return false;
+        }
+        break;
+    }
+    arrival_ns = MonotonicNowNs();
+
+    uint8_t buffer[64];
+    ssize_t bytes = read(hidraw_fd_, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(report.size())) {
+        return false;
+    }
+    std::memcpy(report.data(), buffer, report.size());
+    return true;
+}
+
+void LoopbackRig::DrainReports(int quiet_ms) {
+    hid::WheelReport report{};
+    int64_t arrival_ns = 0;
+    while (ReadReport(report, arrival_ns, quiet_ms)) {
+    }
+}
+
+bool LoopbackRig::WriteOutputReport(const std::array<uint8_t, 7>& packet) {
+    if (hidraw_fd_ < 0) {
+        return false;
+    }
+    // The G29 descriptor has no report IDs, so hidraw expects a leading zero byte.
+    uint8_t buffer[8];
+    buffer[0] = 0;
+    std::memcpy(buffer + 1, packet.data(), packet.size());
+    while (true) {
+        ssize_t written = write(hidraw_fd_, buffer, sizeof(buffer));
+        if (written >= 0) {
+            return true;
+        }
+        if (errno != EINTR) {
+            LOG_ERROR(kTag, "hidraw write failed: " << std::strerror(errno));
+            return false;
+        }
+    }
+}
+
+int32_t LoopbackRig::SteeringFromReport(const hid::WheelReport& report) {
+    return static_cast<int32_t>(hid::G29Report::Get<hid::G29Axes, hid::G29Axes::kSteering>(report)) - 32768;
+}
+
+uint16_t LoopbackRig::ThrottleFromReport(const hid::WheelReport& report) {
+    return static_cast<uint16_t>(hid::G29Report::Get<hid::G29Axes, hid::G29Axes::kThrottle>(report));
+}
+
+}  // namespace tools
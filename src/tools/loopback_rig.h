@@ -0,0 +1,73 @@
+#ifndef LOOPBACK_RIG_H
+#define LOOPBACK_RIG_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "uinput_device.h"
+#include "../hid/g29_profile.h"
+
+class InputManager;
+class WheelDevice;
+
+namespace tools {
+
+// Brings up the full emulator pipeline against synthetic uinput devices and the
+// host-side hidraw node that dummy_hcd exposes for our own gadget, so timing can
+// be measured end to end on a single machine.
+class LoopbackRig {
+public:
+    struct Options {
+        int sensitivity = 50;
+        float ffb_gain = 1.0f;
+        int ffb_tick_hz = 1000;
+        int hidraw_wait_ms = 5000;
+    };
+
+    LoopbackRig();
+    ~LoopbackRig();
+
+    LoopbackRig(const LoopbackRig&) = delete;
+    LoopbackRig& operator=(const LoopbackRig&) = delete;
+
+    bool Start(const Options& options);
+    void Stop();
+
+    UinputDevice& keyboard() { return keyboard_; }
+    UinputDevice& mouse() { return mouse_; }
+    WheelDevice& wheel() { return *wheel_; }
+    const std::string& hidraw_path() const { return hidraw_path_; }
+
+    // Waits up to timeout_ms for the next IN report seen by the host.
+    bool ReadReport(hid::WheelReport& report, int64_t& arrival_ns, int timeout_ms);
+    // Discards reports until the host side has been quiet for quiet_ms.
+    void DrainReports(int quiet_ms);
+    // Sends a 7-byte OUTPUT report to the gadget through hidraw, as a host FFB driver would.
+    bool WriteOutputReport(const std::array<uint8_t, 7>& packet);
+
+    static int32_t SteeringFromReport(const hid::WheelReport& report);
+    static uint16_t ThrottleFromReport(const hid::WheelReport& report);
+
+private:
+    void PumpFrames();
+    bool OpenHidraw(int wait_ms);
+    static std::string FindLoopbackHidraw();
+
+    Options options_;
+    UinputDevice keyboard_;
+    UinputDevice mouse_;
+    std::unique_ptr<WheelDevice> wheel_;
+    std::unique_ptr<InputManager> input_manager_;
+    std::thread pump_thread_;
+    std::atomic<bool> pump_running_;
+    std::string hidraw_path_;
+    int hidraw_fd_;
+};
+
+}  // namespace tools
+
+#endif  // LOOPBACK_RIG_H
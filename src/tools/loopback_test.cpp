@@ -0,0 +1,183 @@
+#include "tools.h"
+
+#include <linux/input-event-codes.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "loopback_rig.h"
+#include "tool_common.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+constexpr int kReportTimeoutMs = 250;
+constexpr uint16_t kThrottleReleased = 0xFFFF;
+constexpr uint16_t kThrottlePressed = 0x0000;
+
+// Spreads injections across the host polling interval so samples are not phase-locked to it.
+int InterSampleDelayUs(int index) {
+    return 3000 + (index * 1237) % 4000;
+}
+
+void MeasureKeyLatency(LoopbackRig& rig, int samples, LatencyStats& stats, int& misses) {
+    bool pressed = false;
+    hid::WheelReport report{};
+    for (int i = 0; i < samples && running.load(std::memory_order_relaxed); ++i) {
+        pressed = !pressed;
+        uint16_t expected = pressed ? kThrottlePressed : kThrottleReleased;
+        int64_t injected_ns = MonotonicNowNs();
+        rig.keyboard().EmitKey(KEY_W, pressed);
+
+        bool matched = false;
+        int64_t arrival_ns = 0;
+        while (rig.ReadReport(report, arrival_ns, kReportTimeoutMs)) {
+            if (LoopbackRig::ThrottleFromReport(report) == expected) {
+                matched = true;
+                break;
+            }
+        }
+        if (matched) {
+            stats.Add(arrival_ns - injected_ns);
+        } else {
+            ++misses;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(InterSampleDelayUs(i)));
+    }
+    if (pressed) {
+        rig.keyboard().EmitKey(KEY_W, false);
+    }
+    rig.DrainReports(20);
+}
+
+void MeasureMouseLatency(LoopbackRig& rig, int samples, LatencyStats& stats, int& misses) {
+    hid::WheelReport report{};
+    int64_t arrival_ns = 0;
+    int32_t last_steering = 0;
+    if (rig.ReadReport(report, arrival_ns, 0)) {
+        last_steering = LoopbackRig::SteeringFromReport(report);
+    }
+
+    for (int i = 0; i < samples && running.load(std::memory_order_relaxed); ++i) {
+        int delta = (i % 2 == 0) ? 20 : -20;
+        int64_t injected_ns = MonotonicNowNs();
+        rig.mouse().EmitRelX(delta);
+
+        bool matched = false;
+        while (rig.ReadReport(report, arrival_ns, kReportTimeoutMs)) {
+            int32_t steering = LoopbackRig::SteeringFromReport(report);
+            if (steering != last_steering) {
+                last_steering = steering;
+                matched = true;
+                break;
+            }
+        }
+        if (matched) {
+            stats.Add(arrival_ns - injected_ns);
+        } else {
+            ++misses;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(InterSampleDelayUs(i)));
+    }
+    rig.DrainReports(20);
+}
+
+void MeasureReportStream(LoopbackRig& rig, int rate_hz, int duration_ms,
+                         LatencyStats& intervals, size_t& reports, size_t& injected) {
+    std::atomic<bool> injecting{true};
+    std::atomic<size_t> injected_count{0};
+    std::thread injector([&]() {
+        auto period = std::chrono::nanoseconds(1000000000LL / rate_hz);
+        auto next = std::chrono::steady_clock::now();
+        int direction = 1;
+        size_t count = 0;
+        while (injecting.load(std::memory_order_relaxed)) {
+            // Sweep back and forth so steering never saturates and every event changes the report.
+            if (count % 200 == 0) {
+                direction = -direction;
+            }
+            rig.mouse().EmitRelX(direction * 4);
+            ++count;
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+        injected_count.store(count, std::memory_order_relaxed);
+    });
+
+    hid::WheelReport report{};
+    int64_t arrival_ns = 0;
+    int64_t previous_ns = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration_ms);
+    while (std::chrono::steady_clock::now() < end && running.load(std::memory_order_relaxed)) {
+        if (!rig.ReadReport(report, arrival_ns, kReportTimeoutMs)) {
+            continue;
+        }
+        if (previous_ns != 0) {
+            intervals.Add(arrival_ns - previous_ns);
+        }
+        previous_ns = arrival_ns;
+        ++reports;
+    }
+    injecting.store(false, std::memory_order_relaxed);
+    injector.join();
+    injected = injected_count.load(std::memory_order_relaxed);
+    rig.DrainReports(20);
+}
+
+}  // namespace
+
+int RunLoopbackLatencyTest(int argc, char* argv[]) {
+    const int samples = IntArg(argc, argv, "samples", 200);
+    const int stream_hz = IntArg(argc, argv, "stream-hz", 1000);
+    const int stream_ms = IntArg(argc, argv, "stream-ms", 2000);
+
+    LoopbackRig::Options options;
+    options.sensitivity = IntArg(argc, argv, "sensitivity", options.sensitivity);
+
+    LoopbackRig rig;
+    if (!rig.Start(options)) {
+        std::cerr << "Loopback rig failed to start" << std::endl;
+        return 1;
+    }
+    std::cout << "Loopback host node: " << rig.hidraw_path() << std::endl;
+    rig.DrainReports(200);
+
+    LatencyStats key_stats;
+    key_stats.Reserve(static_cast<size_t>(samples));
+    int key_misses = 0;
+    MeasureKeyLatency(rig, samples, key_stats, key_misses);
+
+    LatencyStats mouse_stats;
+    mouse_stats.Reserve(static_cast<size_t>(samples));
+    int mouse_misses = 0;
+    MeasureMouseLatency(rig, samples, mouse_stats, mouse_misses);
+
+    LatencyStats intervals;
+    size_t reports = 0;
+    size_t injected = 0;
+    if (stream_hz > 0 && stream_ms > 0) {
+        MeasureReportStream(rig, stream_hz, stream_ms, intervals, reports, injected);
+    }
+
+    rig.Stop();
+
+    key_stats.Print(std::cout, "key -> report latency");
+    std::cout << "  missed: " << key_misses << std::endl;
+    mouse_stats.Print(std::cout, "mouse -> report latency");
+    std::cout << "  missed: " << mouse_misses << std::endl;
+    if (stream_hz > 0 && stream_ms > 0) {
+        double seconds = static_cast<double>(stream_ms) / 1000.0;
+        std::cout << "stream: injected " << injected << " events at " << stream_hz << " Hz, host received "
+                  << reports << " reports (" << static_cast<double>(reports) / seconds << " reports/s)"
+                  << std::endl;
+        intervals.Print(std::cout, "report interval (jitter)");
+    }
+    return (key_stats.Count() > 0 && mouse_stats.Count() > 0) ? 0 : 1;
+}
+
+}  // namespace tools
@@ -0,0 +1,174 @@
+#include "tools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "tool_common.h"
+#include "../input/remote_input.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+// What the sender did, so the receiver's bookkeeping can be checked exactly.
+struct SendLog {
+    uint64_t unique = 0;      // distinct packets put on the wire
+    uint64_t duplicates = 0;  // extra copies of already-sent packets
+    uint64_t dropped = 0;     // packets numbered but never sent
+    uint64_t reordered = 0;   // packets sent after a newer one
+    uint64_t poisoned = 0;    // well-formed packets carrying a NaN; must count as malformed
+    uint8_t final_throttle = 0;
+};
+
+}  // namespace
+
+// Sends a numbered stream of UDP input packets through loopback with deliberate loss,
+// duplication and reordering, and checks that RemoteReceiver drops exactly the copies,
+// keeps every late steering delta, ends on the newest absolute value and rejects a
+// packet whose steering is NaN. Prints the one-way latency. With --target the stream goes to a running emulator instead.
+int RunRemoteLoopbackTest(int argc, char* argv[]) {
+    const int packets = std::max(2, IntArg(argc, argv, "packets", 20000));
+    const int rate = std::clamp(IntArg(argc, argv, "rate", 5000), 1, 200000);
+    const int drop_pct = std::clamp(IntArg(argc, argv, "drop", 2), 0, 50);
+    const int duplicate_pct = std::clamp(IntArg(argc, argv, "duplicate", 2), 0, 50);
+    const int reorder_pct = std::clamp(IntArg(argc, argv, "reorder", 5), 0, 50);
+    const int reorder_depth = std::clamp(IntArg(argc, argv, "reorder-depth", 4), 1, 60);
+    const std::string target = StringArg(argc, argv, "target", "");
+
+    inject::RemoteReceiver receiver;
+    std::string error;
+    std::string address = target;
+    if (target.empty()) {
+        if (!receiver.Open("127.0.0.1:0", error)) {
+            std::cerr << "Cannot open receiver: " << error << std::endl;
+            return 1;
+        }
+        address = "127.0.0.1:" + std::to_string(receiver.port());
+    }
+    inject::RemoteSender sender;
+    if (!sender.Open(address, error)) {
+        std::cerr << "Cannot open sender: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "Sending " << packets << " packets to " << address << " at " << rate << " Hz (drop " << drop_pct
+              << "%, duplicate " << duplicate_pct << "%, reorder " << reorder_pct << "% by up to " << reorder_depth
+              << ")" << std::endl;
+
+    std::atomic<bool> receiving{true};
+    float delta_sum = 0.0f;
+    uint8_t throttle = 0;
+    LatencyStats latency;
+    latency.Reserve(static_cast<size_t>(packets));
+    std::thread receive_thread;
+    if (target.empty()) {
+        receive_thread = std::thread([&]() {
+            while (receiving.load(std::memory_order_acquire)) {
+                receiver.Wait(10);
+                receiver.Drain([&](const inject::Message& message) {
+                    latency.Add(MonotonicNowNs() - message.time_ns);
+                    if (message.set & inject::kSteeringDelta) {
+                        delta_sum += message.steering_delta;
+                    }
+                    if (message.set & inject::kThrottle) {
+                        throttle = message.throttle;
+                    }
+                });
+            }
+        });
+    }
+
+    std::mt19937 rng(static_cast<uint32_t>(IntArg(argc, argv, "seed", 1)));
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::deque<std::pair<int, inject::RemotePacket>> held;  // reordered packets and their release index
+    SendLog log;
+    const int64_t period_ns = 1000000000LL / rate;
+    int64_t next_ns = MonotonicNowNs();
+    for (int i = 0; i < packets && running.load(std::memory_order_relaxed); ++i) {
+        inject::Message message{};
+        message.set = inject::kSteeringDelta | inject::kThrottle;
+        message.steering_delta = 1.0f;
+        message.throttle = static_cast<uint8_t>(i % 101);
+        inject::RemotePacket packet;
+        sender.Stamp(message, packet);
+
+        // The last packet always goes out in order so the final absolute value is known.
+        const bool last = i == packets - 1;
+        if (!last && percent(rng) < drop_pct) {
+            ++log.dropped;
+        } else if (!last && percent(rng) < reorder_pct) {
+            held.emplace_back(i + 1 + static_cast<int>(rng() % reorder_depth), packet);
+            ++log.reordered;
+        } else {
+            sender.SendRaw(packet);
+            ++log.unique;
+            log.final_throttle = message.throttle;
+            if (percent(rng) < duplicate_pct) {
+                sender.SendRaw(packet);
+                ++log.duplicates;
+            }
+        }
+        while (!held.empty() && (held.front().first <= i || last)) {
+            sender.SendRaw(held.front().second);
+            ++log.unique;
+            held.pop_front();
+        }
+
+        next_ns += period_ns;
+        const int64_t sleep_ns = next_ns - MonotonicNowNs();
+        if (sleep_ns > 0) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sleep_ns));
+        }
+    }
+    if (running.load(std::memory_order_relaxed)) {
+        // Valid framing, poisoned payload: it must be dropped before it can steer.
+        inject::Message message{};
+        message.set = inject::kSteeringDelta | inject::kThrottle;
+        message.steering_delta = std::numeric_limits<float>::quiet_NaN();
+        message.throttle = static_cast<uint8_t>(log.final_throttle + 1);
+        inject::RemotePacket packet;
+        sender.Stamp(message, packet);
+        sender.SendRaw(packet);
+        ++log.poisoned;
+    }
+    if (!target.empty()) {
+        std::cout << "sent=" << log.unique << " duplicates=" << log.duplicates << " dropped=" << log.dropped
+                  << " reordered=" << log.reordered << " poisoned=" << log.poisoned << std::endl;
+        return 0;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    receiving.store(false, std::memory_order_release);
+    receiver.Wake();
+    receive_thread.join();
+
+    const inject::RemoteStats& stats = receiver.stats();
+    std::cout << "sent: unique=" << log.unique << " duplicates=" << log.duplicates << " dropped=" << log.dropped
+              << " reordered=" << log.reordered << " poisoned=" << log.poisoned << std::endl;
+    std::cout << "received: accepted=" << stats.accepted << " late=" << stats.late
+              << " duplicates=" << stats.duplicates << " stale=" << stats.stale << " malformed=" << stats.malformed
+              << " gaps=" << stats.gaps << std::endl;
+    latency.Print(std::cout, "one-way latency");
+
+    bool ok = true;
+    auto check = [&ok](bool condition, const std::string& what) {
+        std::cout << (condition ? "PASS " : "FAIL ") << what << std::endl;
+        ok = ok && condition;
+    };
+    check(stats.duplicates == log.duplicates, "every duplicate dropped, nothing else");
+    check(stats.accepted + stats.late == log.unique, "every distinct packet admitted once");
+    check(static_cast<uint64_t>(delta_sum) == log.unique, "late steering deltas applied");
+    check(throttle == log.final_throttle, "final absolute value is the newest sent");
+    check(stats.malformed == log.poisoned, "NaN packet counted as malformed and not applied");
+    return ok ? 0 : 1;
+}
+
+}  // namespace tools
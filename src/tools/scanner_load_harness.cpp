@@ -0,0 +1,327 @@
+#include "tools.h"
+
+#include <linux/input-event-codes.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tool_common.h"
+#include "uinput_device.h"
+#include "../input/device_scanner.h"
+#include "../metrics/metrics.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+constexpr int kDiscoverTimeoutMs = 5000;
+constexpr int kReleaseTimeoutMs = 2000;
+constexpr int kProbeKey = KEY_F20;
+constexpr int kTrafficKey = KEY_F21;
+// Unbound key the keyboards use for --noise packets; mice use REL_Y.
+constexpr int kNoiseKey = KEY_F22;
+
+struct ReaderCounters {
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<int64_t> mouse_units{0};
+    std::atomic<int64_t> wait_ns{0};
+    std::atomic<int64_t> read_ns{0};
+};
+
+// Mirrors InputManager::ReaderLoop but only counts what the scanner delivers.
+class ScannerReader {
+public:
+    explicit ScannerReader(DeviceScanner& scanner) : scanner_(scanner), active_(false) {}
+    ~ScannerReader() { Stop(); }
+
+    void Start() {
+        active_.store(true, std::memory_order_release);
+        thread_ = std::thread([this]() {
+            while (active_.load(std::memory_order_acquire) && running.load(std::memory_order_relaxed)) {
+                int64_t before_wait = MonotonicNowNs();
+                bool ready = scanner_.WaitForEvents(-1);
+                int64_t before_read = MonotonicNowNs();
+                int dx = 0;
+                scanner_.Read(dx);
+                int64_t after_read = MonotonicNowNs();
+                counters_.wakeups.fetch_add(1, std::memory_order_relaxed);
+                if (ready) {
+                    counters_.reads.fetch_add(1, std::memory_order_relaxed);
+                }
+                counters_.mouse_units.fetch_add(dx, std::memory_order_relaxed);
+                counters_.wait_ns.fetch_add(before_read - before_wait, std::memory_order_relaxed);
+                counters_.read_ns.fetch_add(after_read - before_read, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    void Stop() {
+        if (!thread_.joinable()) {
+            return;
+        }
+        active_.store(false, std::memory_order_release);
+        scanner_.NotifyInputChanged();
+        thread_.join();
+    }
+
+    ReaderCounters& counters() { return counters_; }
+
+private:
+    DeviceScanner& scanner_;
+    std::atomic<bool> active_;
+    std::thread thread_;
+    ReaderCounters counters_;
+};
+
+bool WaitUntil(int timeout_ms, const std::function<bool()>& predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline && running.load(std::memory_order_relaxed)) {
+        if (predicate()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+    return predicate();
+}
+
+// Creates the devices in bulk and records how long the scanner takes to open each node.
+void SpawnDevices(DeviceScanner& scanner, std::vector<UinputDevice>& devices, int keyboards, int mice,
+                  LatencyStats& discover, int& undiscovered) {
+    std::vector<int64_t> created_ns;
+    for (int i = 0; i < keyboards + mice; ++i) {
+        UinputDevice device;
+        bool keyboard = i < keyboards;
+        std::string name = std::string("wheel-emulator load ") + (keyboard ? "kbd " : "mouse ") + std::to_string(i);
+        if (!device.Create(keyboard ? UinputDevice::Kind::Keyboard : UinputDevice::Kind::Mouse, name)) {
+            continue;
+        }
+        created_ns.push_back(MonotonicNowNs());
+        devices.push_back(std::move(device));
+    }
+
+    std::vector<bool> seen(devices.size(), false);
+    size_t remaining = devices.size();
+    WaitUntil(kDiscoverTimeoutMs, [&]() {
+        for (size_t i = 0; i < devices.size(); ++i) {
+            if (!seen[i] && scanner.HasDevice(devices[i].event_path())) {
+                seen[i] = true;
+                discover.Add(MonotonicNowNs() - created_ns[i]);
+                --remaining;
+            }
+        }
+        return remaining == 0;
+    });
+    undiscovered += static_cast<int>(remaining);
+}
+
+// Only the last `active` devices (mice first, then keyboards) inject; the rest stay
+// open and idle, which is what the reader's ready-set handling is measured against.
+// Each injected event is followed by `noise` packets the scanner's key filter drops.
+void InjectTraffic(std::vector<UinputDevice>& devices, int keyboards, int active, int noise, int rate_hz,
+                   int duration_ms, uint64_t& injected_mouse_events) {
+    std::atomic<bool> injecting{true};
+    std::vector<std::thread> injectors;
+    std::vector<uint64_t> per_device(devices.size(), 0);
+    const size_t first_active = devices.size() - std::min(devices.size(), static_cast<size_t>(std::max(0, active)));
+    for (size_t i = first_active; i < devices.size(); ++i) {
+        injectors.emplace_back([&, i]() {
+            const bool keyboard = static_cast<int>(i) < keyboards;
+            auto period = std::chrono::nanoseconds(1000000000LL / std::max(1, rate_hz));
+            auto next = std::chrono::steady_clock::now();
+            bool pressed = false;
+            bool noise_pressed = false;
+            while (injecting.load(std::memory_order_relaxed)) {
+                if (keyboard) {
+                    pressed = !pressed;
+                    devices[i].EmitKey(kTrafficKey, pressed);
+                } else {
+                    devices[i].EmitRelX(1);
+                }
+                for (int n = 0; n < noise; ++n) {
+                    if (keyboard) {
+                        noise_pressed = !noise_pressed;
+                        devices[i].EmitKey(kNoiseKey, noise_pressed);
+                    } else {
+                        devices[i].EmitRelY(1);
+                    }
+                }
+                ++per_device[i];
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            if (keyboard && pressed) {
+                devices[i].EmitKey(kTrafficKey, false);
+            }
+            if (keyboard && noise_pressed) {
+                devices[i].EmitKey(kNoiseKey, false);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    injecting.store(false, std::memory_order_relaxed);
+    for (auto& thread : injectors) {
+        thread.join();
+    }
+    injected_mouse_events = 0;
+    for (size_t i = static_cast<size_t>(keyboards); i < devices.size(); ++i) {
+        injected_mouse_events += per_device[i];
+    }
+}
+
+double CpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+}  // namespace
+
+int RunScannerLoadHarness(int argc, char* argv[]) {
+    const int keyboards = IntArg(argc, argv, "keyboards", 16);
+    const int mice = IntArg(argc, argv, "mice", 16);
+    const int rate_hz = IntArg(argc, argv, "rate", 1000);
+    const int duration_ms = IntArg(argc, argv, "duration-ms", 3000);
+    const int replug_cycles = IntArg(argc, argv, "replug-cycles", 3);
+    const int active = IntArg(argc, argv, "active", keyboards + mice);
+    const int noise = std::max(0, IntArg(argc, argv, "noise", 0));
+    const bool masked = !HasFlag(argc, argv, "no-mask");
+    io::Backend requested = io::Backend::kEpoll;
+    const std::string backend_arg = StringArg(argc, argv, "backend", "epoll");
+    if (!io::ParseBackend(backend_arg, requested)) {
+        std::cerr << "Unknown --backend=" << backend_arg << " (expected epoll or io_uring)" << std::endl;
+        return 2;
+    }
+
+    DeviceScanner scanner;
+    const io::Backend backend = scanner.SetIoBackend(requested);
+    if (masked) {
+        scanner.SetKeyFilter({kProbeKey, kTrafficKey});
+    }
+    scanner.DiscoverKeyboard("");
+    scanner.DiscoverMouse("");
+
+    std::vector<UinputDevice> devices;
+    devices.reserve(static_cast<size_t>(keyboards + mice));
+    LatencyStats discover;
+    int undiscovered = 0;
+    SpawnDevices(scanner, devices, keyboards, mice, discover, undiscovered);
+    std::cout << "Spawned " << devices.size() << " synthetic devices ("
+              << (masked ? "EVIOCSMASK filter on" : "unfiltered") << ", " << noise << " noise packets per event, "
+              << io::BackendName(backend) << " reads)" << std::endl;
+    discover.Print(std::cout, "initial time-to-discover");
+    std::cout << "  undiscovered: " << undiscovered << std::endl;
+
+    ScannerReader reader(scanner);
+    reader.Start();
+
+    metrics::Counter& drains = metrics::DefaultRegistry().GetCounter(
+        "wheel_scanner_device_drains_total", "Per-device drain passes in Read (one per ready node)");
+    metrics::Counter& completions = metrics::DefaultRegistry().GetCounter(
+        "wheel_scanner_ring_completions_total", "io_uring read completions reaped from evdev nodes");
+    uint64_t injected_mouse = 0;
+    double cpu_before = CpuSeconds();
+    const uint64_t drains_before = drains.Value();
+    const uint64_t completions_before = completions.Value();
+    const uint64_t wakeups_before = reader.counters().wakeups.load();
+    int64_t start_ns = MonotonicNowNs();
+    InjectTraffic(devices, keyboards, active, noise, rate_hz, duration_ms, injected_mouse);
+    // Give the reader a moment to drain what is still queued in the kernel.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    double elapsed = static_cast<double>(MonotonicNowNs() - start_ns) / 1e9;
+    double cpu_used = CpuSeconds() - cpu_before;
+
+    ReaderCounters& counters = reader.counters();
+    uint64_t wakeups = counters.wakeups.load();
+    const uint64_t traffic_drains = drains.Value() - drains_before;
+    const uint64_t traffic_completions = completions.Value() - completions_before;
+    const uint64_t traffic_wakeups = wakeups - wakeups_before;
+    int64_t mouse_units = counters.mouse_units.load();
+    std::cout << std::fixed << std::setprecision(1)
+              << "throughput: injected " << injected_mouse << " mouse events, read " << mouse_units
+              << " (" << static_cast<double>(mouse_units) / elapsed << "/s)" << std::endl
+              << "  reader wakeups: " << wakeups << " (" << static_cast<double>(wakeups) / elapsed << "/s, "
+              << (wakeups ? static_cast<double>(mouse_units) / static_cast<double>(wakeups) : 0.0)
+              << " mouse events/wakeup)" << std::endl
+              << "  mean WaitForEvents: "
+              << (wakeups ? static_cast<double>(counters.wait_ns.load()) / static_cast<double>(wakeups) / 1000.0 : 0.0)
+              << "us, mean Read: "
+              << (wakeups ? static_cast<double>(counters.read_ns.load()) / static_cast<double>(wakeups) / 1000.0 : 0.0)
+              << "us" << std::endl
+              << "  devices drained per wakeup: "
+              << (traffic_wakeups ? static_cast<double>(traffic_drains) / static_cast<double>(traffic_wakeups) : 0.0)
+              << " (" << std::min(active, static_cast<int>(devices.size())) << " of " << devices.size()
+              << " open nodes active)" << std::endl
+              << "  ring completions per wakeup: "
+              << (traffic_wakeups ? static_cast<double>(traffic_completions) / static_cast<double>(traffic_wakeups)
+                                  : 0.0)
+              << std::endl
+              << "  process CPU: " << cpu_used / elapsed * 100.0 << "% of one core (includes injectors)"
+              << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    LatencyStats release;
+    LatencyStats rediscover;
+    int stuck_keys = 0;
+    int lost = 0;
+    for (int cycle = 0; cycle < replug_cycles && running.load(std::memory_order_relaxed); ++cycle) {
+        for (size_t i = 0; i < devices.size() && running.load(std::memory_order_relaxed); ++i) {
+            const bool keyboard = static_cast<int>(i) < keyboards;
+            const std::string name = devices[i].event_path();
+            if (keyboard) {
+                devices[i].EmitKey(kProbeKey, true);
+                if (!WaitUntil(kReleaseTimeoutMs, [&]() { return scanner.IsKeyPressed(kProbeKey); })) {
+                    ++stuck_keys;
+                    continue;
+                }
+            }
+            devices[i].Destroy();
+            int64_t unplugged_ns = MonotonicNowNs();
+            if (keyboard) {
+                if (WaitUntil(kReleaseTimeoutMs, [&]() { return !scanner.IsKeyPressed(kProbeKey); })) {
+                    release.Add(MonotonicNowNs() - unplugged_ns);
+                } else {
+                    ++stuck_keys;
+                }
+            }
+
+            UinputDevice replacement;
+            if (!replacement.Create(keyboard ? UinputDevice::Kind::Keyboard : UinputDevice::Kind::Mouse,
+                                    "wheel-emulator load replug " + std::to_string(i))) {
+                ++lost;
+                continue;
+            }
+            int64_t plugged_ns = MonotonicNowNs();
+            const std::string path = replacement.event_path();
+            if (WaitUntil(kDiscoverTimeoutMs, [&]() { return scanner.HasDevice(path); })) {
+                rediscover.Add(MonotonicNowNs() - plugged_ns);
+            } else {
+                ++lost;
+            }
+            devices[i] = std::move(replacement);
+        }
+    }
+
+    reader.Stop();
+    if (replug_cycles > 0) {
+        release.Print(std::cout, "unplug -> key release");
+        std::cout << "  stuck keys: " << stuck_keys << std::endl;
+        rediscover.Print(std::cout, "replug time-to-discover");
+        std::cout << "  lost devices: " << lost << std::endl;
+    }
+    devices.clear();
+    return (undiscovered == 0 && stuck_keys == 0 && lost == 0) ? 0 : 1;
+}
+
+}  // namespace tools
@@ -0,0 +1,95 @@
+#include "tools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "tool_common.h"
+#include "../config.h"
+#include "../telemetry/telemetry_ring.h"
+
+extern std::atomic<bool> running;
+
+namespace tools {
+namespace {
+
+constexpr const char* kDefaultConfigPath = "/etc/wheel-emulator.conf";
+
+void PrintRecord(const telemetry::Record& record) {
+    std::cout << record.time_ns << ","
+              << (record.kind == static_cast<uint32_t>(telemetry::RecordKind::kFFBTick) ? "ffb" : "state") << ","
+              << static_cast<int>(record.enabled) << "," << record.steering << "," << record.user_steering << ","
+              << record.ffb_offset << "," << record.ffb_velocity << "," << record.ffb_target << ","
+              << record.throttle << "," << record.brake << "," << record.clutch << ","
+              << static_cast<int>(record.dpad_x) << "," << static_cast<int>(record.dpad_y) << ",0x" << std::hex
+              << record.buttons << std::dec << "\n";
+}
+
+}  // namespace
+
+// Follows a running emulator's telemetry ring from the newest record on, printing CSV.
+// Reading is pure loads from the mapping; the only syscall in the loop is the sleep
+// between polls, which a real overlay would replace with its frame tick.
+int RunTelemetryDump(int argc, char* argv[]) {
+    std::string name = StringArg(argc, argv, "shm", "");
+    if (name.empty()) {
+        Config config;
+        if (config.LoadFromFile(StringArg(argc, argv, "config", kDefaultConfigPath).c_str())) {
+            name = config.telemetry_shm;
+        }
+    }
+    if (name.empty()) {
+        std::cerr << "No telemetry segment: pass --shm=NAME or set [telemetry] shm= in the config" << std::endl;
+        return 1;
+    }
+    if (name[0] != '/') {
+        name.insert(name.begin(), '/');
+    }
+
+    telemetry::TelemetryReader reader;
+    std::string error;
+    if (!reader.Open(name, error)) {
+        std::cerr << "Cannot open telemetry: " << error << std::endl;
+        return 1;
+    }
+
+    const int duration_ms = IntArg(argc, argv, "duration-ms", 0);
+    const int poll_us = std::max(50, IntArg(argc, argv, "poll-us", 1000));
+    const int64_t deadline_ns = duration_ms > 0 ? MonotonicNowNs() + int64_t{duration_ms} * 1000000 : 0;
+
+    std::cerr << "Following " << name << " (" << reader.slot_count() << " slots)" << std::endl;
+    std::cout << "time_ns,kind,enabled,steering,user_steering,ffb_offset,ffb_velocity,ffb_target,"
+                 "throttle,brake,clutch,dpad_x,dpad_y,buttons\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    uint64_t cursor = reader.WriteSeq();
+    uint64_t printed = 0;
+    uint64_t lost = 0;
+    telemetry::Record record;
+    while (running.load(std::memory_order_relaxed) && (deadline_ns == 0 || MonotonicNowNs() < deadline_ns)) {
+        const uint64_t head = reader.WriteSeq();
+        if (head - cursor > reader.slot_count()) {
+            lost += head - cursor - reader.slot_count();
+            cursor = head - reader.slot_count();
+        }
+        for (; cursor < head; ++cursor) {
+            if (!reader.Read(cursor, record)) {
+                ++lost;
+                continue;
+            }
+            PrintRecord(record);
+            ++printed;
+        }
+        std::cout.flush();
+        std::this_thread::sleep_for(std::chrono::microseconds(poll_us));
+    }
+    std::cerr << "records=" << printed << " lost=" << lost << std::endl;
+    return 0;
+}
+
+}  // namespace tools
@@ -0,0 +1,131 @@
+#include "tool_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace tools {
+namespace {
+
+bool MatchArg(const std::string& arg, const std::string& name, std::string* inline_value) {
+    const std::string flag = "--" + name;
+    if (arg == flag) {
+        return true;
+    }
+    if (arg.rfind(flag + "=", 0) == 0) {
+        if (inline_value) {
+            *inline_value = arg.substr(flag.size() + 1);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool FindArg(int argc, char* argv[], const std::string& name, std::string& value) {
+    for (int i = 1; i < argc; ++i) {
+        std::string inline_value;
+        std::string arg(argv[i]);
+        if (!MatchArg(arg, name, &inline_value)) {
+            continue;
+        }
+        if (arg != "--" + name) {
+            value = inline_value;
+            return true;
+        }
+        if (i + 1 < argc && argv[i + 1][0] != '-') {
+            value = argv[i + 1];
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool HasFlag(int argc, char* argv[], const std::string& name) {
+    for (int i = 1; i < argc; ++i) {
+        if (MatchArg(argv[i], name, nullptr)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int IntArg(int argc, char* argv[], const std::string& name, int fallback) {
+    std::string value;
+    if (!FindArg(argc, argv, name, value)) {
+        return fallback;
+    }
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+std::string StringArg(int argc, char* argv[], const std::string& name, const std::string& fallback) {
+    std::string value;
+    if (!FindArg(argc, argv, name, value)) {
+        return fallback;
+    }
+    return value;
+}
+
+std::vector<int> IntListArg(int argc, char* argv[], const std::string& name, const std::vector<int>& fallback) {
+    std::string value;
+    if (!FindArg(argc, argv, name, value)) {
+        return fallback;
+    }
+    std::vector<int> parsed;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            parsed.push_back(std::stoi(item));
+        } catch (...) {
+            return fallback;
+        }
+    }
+    return parsed.empty() ? fallback : parsed;
+}
+
+void LatencyStats::Print(std::ostream& out, const std::string& label) const {
+    out << label << ": ";
+    if (samples_ns_.empty()) {
+        out << "no samples" << std::endl;
+        return;
+    }
+    std::vector<int64_t> sorted = samples_ns_;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        size_t index = static_cast<size_t>(std::lround(p * static_cast<double>(sorted.size() - 1)));
+        return static_cast<double>(sorted[index]) / 1000.0;
+    };
+
+    double sum = 0.0;
+    for (int64_t sample : sorted) {
+        sum += static_cast<double>(sample);
+    }
+    double mean = sum / static_cast<double>(sorted.size());
+    double variance = 0.0;
+    for (int64_t sample : sorted) {
+        double diff = static_cast<double>(sample) - mean;
+        variance += diff * diff;
+    }
+    double stddev = std::sqrt(variance / static_cast<double>(sorted.size()));
+
+    out << std::fixed << std::setprecision(1)
+        << "n=" << sorted.size()
+        << " min=" << static_cast<double>(sorted.front()) / 1000.0 << "us"
+        << " mean=" << mean / 1000.0 << "us"
+        << " p50=" << percentile(0.50) << "us"
+        << " p90=" << percentile(0.90) << "us"
+        << " p99=" << percentile(0.99) << "us"
+        << " max=" << static_cast<double>(sorted.back()) / 1000.0 << "us"
+        << " stddev=" << stddev / 1000.0 << "us" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+}  // namespace tools
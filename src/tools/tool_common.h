@@ -0,0 +1,43 @@
+#ifndef TOOL_COMMON_H
+#define TOOL_COMMON_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+// Returns true when argv contains `--name` or `--name=...`.
+bool HasFlag(int argc, char* argv[], const std::string& name);
+
+// Reads `--name=value` or `--name value`; returns fallback when absent or malformed.
+int IntArg(int argc, char* argv[], const std::string& name, int fallback);
+std::string StringArg(int argc, char* argv[], const std::string& name, const std::string& fallback);
+std::vector<int> IntListArg(int argc, char* argv[], const std::string& name, const std::vector<int>& fallback);
+
+inline int64_t MonotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Collects latency/interval samples (nanoseconds) and prints percentile summaries.
+class LatencyStats {
+public:
+    void Reserve(size_t count) { samples_ns_.reserve(count); }
+    void Add(int64_t sample_ns) { samples_ns_.push_back(sample_ns); }
+    void Clear() { samples_ns_.clear(); }
+    size_t Count() const { return samples_ns_.size(); }
+
+    // Prints "label: n=.. min=.. mean=.. p50=.. p90=.. p99=.. max=.. stddev=.." in microseconds.
+    void Print(std::ostream& out, const std::string& label) const;
+
+private:
+    std::vector<int64_t> samples_ns_;
+};
+
+}  // namespace tools
+
+#endif  // TOOL_COMMON_H
@@ -0,0 +1,72 @@
+#include "tools.h"
+
+#include <iostream>
+#include <string>
+
+namespace tools {
+namespace {
+
+const ToolMode kToolModes[] = {
+    {"--loopback-test",
+     "End-to-end input latency and report jitter over dummy_hcd "
+     "[--samples=N] [--stream-hz=HZ] [--stream-ms=MS] [--sensitivity=N]",
+     true, &RunLoopbackLatencyTest},
+    {"--ffb-latency-test",
+     "FFB OUTPUT report -> steering round trip over dummy_hcd "
+     "[--samples=N] [--tick-rates=250,500,1000,2000] [--threshold=COUNTS]",
+     true, &RunFFBLatencyTest},
+    {"--scanner-load",
+     "DeviceScanner throughput/hotplug harness with synthetic uinput devices "
+     "[--keyboards=N] [--mice=N] [--active=N] [--noise=N] [--no-mask] [--rate=HZ] [--duration-ms=MS] "
+     "[--replug-cycles=N] [--backend=epoll|io_uring]",
+     true, &RunScannerLoadHarness},
+    {"--ffb-curve-dump",
+     "Print the compiled FFB torque curve as CSV "
+     "[--curve=F:OUT,...] [--config=PATH] [--max=FORCE] [--step=FORCE]",
+     false, &RunFFBCurveDump},
+    {"--ffb-curve-bench",
+     "Time the torque lookup table against the legacy curve "
+     "[--curve=F:OUT,...] [--config=PATH] [--iterations=N]",
+     false, &RunFFBCurveBench},
+    {"--ffb-sim",
+     "Replay FFB traffic through WheelDevice on a virtual clock, faster than real time "
+     "[--trace=PATH | --duration-s=S] [--tick-rate=HZ] [--trajectory=CSV] [--sample-ms=MS] [--config=PATH]",
+     false, &RunFFBSimulation},
+    {"--telemetry-dump",
+     "Follow the [telemetry] shared-memory ring of a running emulator and print CSV "
+     "[--shm=NAME] [--config=PATH] [--duration-ms=MS] [--poll-us=US]",
+     false, &RunTelemetryDump},
+    {"--inject-sweep",
+     "Steer a running emulator through an [inject] lane with a sine and report push cost "
+     "[--lane=NAME] [--shm=NAME] [--config=PATH] [--rate=HZ] [--duration-ms=MS] [--amplitude=COUNTS] "
+     "[--period-ms=MS] [--throttle=PCT] [--deltas]",
+     false, &RunInjectSweep},
+    {"--remote-loopback",
+     "UDP remote input over loopback with injected loss/duplication/reordering, checked end to end "
+     "[--packets=N] [--rate=HZ] [--drop=PCT] [--duplicate=PCT] [--reorder=PCT] [--reorder-depth=N] "
+     "[--seed=N] [--target=HOST:PORT]",
+     false, &RunRemoteLoopbackTest},
+};
+
+}  // namespace
+
+const ToolMode* FindRequestedTool(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        for (const auto& mode : kToolModes) {
+            if (arg == mode.flag) {
+                return &mode;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void PrintToolUsage() {
+    std::cout << "Diagnostic modes:" << std::endl;
+    for (const auto& mode : kToolModes) {
+        std::cout << "  " << mode.flag << "  " << mode.description << std::endl;
+    }
+}
+
+}  // namespace tools
@@ -0,0 +1,31 @@
+#ifndef TOOLS_H
+#define TOOLS_H
+
+// Diagnostic modes bundled into the emulator binary. Each entry point receives the
+// full command line and returns the process exit code.
+namespace tools {
+
+struct ToolMode {
+    const char* flag;
+    const char* description;
+    bool needs_root;
+    int (*run)(int argc, char* argv[]);
+};
+
+// Returns the mode selected on the command line, or nullptr for normal operation.
+const ToolMode* FindRequestedTool(int argc, char* argv[]);
+void PrintToolUsage();
+
+int RunLoopbackLatencyTest(int argc, char* argv[]);
+int RunFFBLatencyTest(int argc, char* argv[]);
+int RunScannerLoadHarness(int argc, char* argv[]);
+int RunFFBCurveDump(int argc, char* argv[]);
+int RunFFBCurveBench(int argc, char* argv[]);
+int RunFFBSimulation(int argc, char* argv[]);
+int RunTelemetryDump(int argc, char* argv[]);
+int RunInjectSweep(int argc, char* argv[]);
+int RunRemoteLoopbackTest(int argc, char* argv[]);
+
+}  // namespace tools
+
+#endif  // TOOLS_H
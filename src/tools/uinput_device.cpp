@@ -0,0 +1,180 @@
+#include "uinput_device.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "../logging/logger.h"
+
+namespace tools {
+namespace {
+constexpr const char* kTag = "uinput";
+constexpr int kEventNodeWaitMs = 2000;
+}
+
+UinputDevice::UinputDevice() : fd_(-1) {}
+
+UinputDevice::~UinputDevice() {
+    Destroy();
+}
+
+UinputDevice::UinputDevice(UinputDevice&& other) noexcept
+        : fd_(other.fd_), event_path_(std::move(other.event_path_)) {
+    other.fd_ = -1;
+}
+
+UinputDevice& UinputDevice::operator=(UinputDevice&& other) noexcept {
+    if (this != &other) {
+        Destroy();
+        fd_ = other.fd_;
+        event_path_ = std::move(other.event_path_);
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+bool UinputDevice::Create(Kind kind, const std::string& name) {
+    Destroy();
+    fd_ = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOG_ERROR(kTag, "Failed to open /dev/uinput: " << std::strerror(errno));
+        return false;
+    }
+
+    bool ok = true;
+    if (kind == Kind::Keyboard) {
+        ok = ok && ioctl(fd_, UI_SET_EVBIT, EV_KEY) == 0;
+        ok = ok && ioctl(fd_, UI_SET_EVBIT, EV_MSC) == 0;
+        ok = ok && ioctl(fd_, UI_SET_MSCBIT, MSC_SCAN) == 0;
+        for (int code = KEY_ESC; code <= KEY_MICMUTE && ok; ++code) {
+            ok = ioctl(fd_, UI_SET_KEYBIT, code) == 0;
+        }
+    } else {
+        ok = ok && ioctl(fd_, UI_SET_EVBIT, EV_KEY) == 0;
+        ok = ok && ioctl(fd_, UI_SET_KEYBIT, BTN_LEFT) == 0;
+        ok = ok && ioctl(fd_, UI_SET_KEYBIT, BTN_RIGHT) == 0;
+        ok = ok && ioctl(fd_, UI_SET_EVBIT, EV_REL) == 0;
+        ok = ok && ioctl(fd_, UI_SET_RELBIT, REL_X) == 0;
+        ok = ok && ioctl(fd_, UI_SET_RELBIT, REL_Y) == 0;
+        ok = ok && ioctl(fd_, UI_SET_RELBIT, REL_WHEEL) == 0;
+    }
+
+    struct uinput_setup setup;
+    std::memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = (kind == Kind::Keyboard) ? 0x0001 : 0x0002;
+    std::strncpy(setup.name, name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+
+    ok = ok && ioctl(fd_, UI_DEV_SETUP, &setup) == 0;
+    ok = ok && ioctl(fd_, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        LOG_ERROR(kTag, "Failed to create uinput device '" << name << "': " << std::strerror(errno));
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    if (!ResolveEventPath()) {
+        LOG_ERROR(kTag, "uinput device '" << name << "' never exposed an event node");
+        Destroy();
+        return false;
+    }
+    LOG_DEBUG(kTag, "Created '" << name << "' at " << event_path_);
+    return true;
+}
+
+void UinputDevice::Destroy() {
+    if (fd_ < 0) {
+        return;
+    }
+    ioctl(fd_, UI_DEV_DESTROY);
+    close(fd_);
+    fd_ = -1;
+    event_path_.clear();
+}
+
+bool UinputDevice::ResolveEventPath() {
+    char sysname[64] = {0};
+    if (ioctl(fd_, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) {
+        return false;
+    }
+    const std::string sys_dir = std::string("/sys/devices/virtual/input/") + sysname;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kEventNodeWaitMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        DIR* dir = opendir(sys_dir.c_str());
+        if (dir) {
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (std::strncmp(entry->d_name, "event", 5) != 0) {
+                    continue;
+                }
+                std::string candidate = std::string("/dev/input/") + entry->d_name;
+                if (access(candidate.c_str(), R_OK) == 0) {
+                    event_path_ = candidate;
+                    closedir(dir);
+                    return true;
+                }
+            }
+            closedir(dir);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+bool UinputDevice::Emit(int type, int code, int value) {
+    if (fd_ < 0) {
+        return false;
+    }
+    struct input_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.type = static_cast<__u16>(type);
+    ev.code = static_cast<__u16>(code);
+    ev.value = value;
+    while (true) {
+        ssize_t written = write(fd_, &ev, sizeof(ev));
+        if (written == static_cast<ssize_t>(sizeof(ev))) {
+            return true;
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+}
+
+bool UinputDevice::EmitKey(int code, bool pressed, bool sync) {
+    if (!Emit(EV_KEY, code, pressed ? 1 : 0)) {
+        return false;
+    }
+    return !sync || Sync();
+}
+
+bool UinputDevice::EmitRelX(int delta, bool sync) {
+    if (!Emit(EV_REL, REL_X, delta)) {
+        return false;
+    }
+    return !sync || Sync();
+}
+
+bool UinputDevice::EmitRelY(int delta, bool sync) {
+    if (!Emit(EV_REL, REL_Y, delta)) {
+        return false;
+    }
+    return !sync || Sync();
+}
+
+bool UinputDevice::Sync() {
+    return Emit(EV_SYN, SYN_REPORT, 0);
+}
+
+}  // namespace tools
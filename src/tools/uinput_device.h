@@ -0,0 +1,44 @@
+#ifndef UINPUT_DEVICE_H
+#define UINPUT_DEVICE_H
+
+#include <string>
+
+namespace tools {
+
+// Minimal /dev/uinput wrapper used by the self-test and load harness modes to
+// create synthetic keyboards/mice that DeviceScanner picks up like real hardware.
+class UinputDevice {
+public:
+    enum class Kind { Keyboard, Mouse };
+
+    UinputDevice();
+    ~UinputDevice();
+
+    UinputDevice(const UinputDevice&) = delete;
+    UinputDevice& operator=(const UinputDevice&) = delete;
+    UinputDevice(UinputDevice&& other) noexcept;
+    UinputDevice& operator=(UinputDevice&& other) noexcept;
+
+    bool Create(Kind kind, const std::string& name);
+    void Destroy();
+
+    bool IsOpen() const { return fd_ >= 0; }
+    // /dev/input/eventN node backing this device (empty until Create succeeds).
+    const std::string& event_path() const { return event_path_; }
+
+    bool EmitKey(int code, bool pressed, bool sync = true);
+    bool EmitRelX(int delta, bool sync = true);
+    bool EmitRelY(int delta, bool sync = true);
+    bool Sync();
+
+private:
+    bool Emit(int type, int code, int value);
+    bool ResolveEventPath();
+
+    int fd_;
+    std::string event_path_;
+};
+
+}  // namespace tools
+
+#endif  // UINPUT_DEVICE_H
@@ -0,0 +1,25 @@
+#include "clock.h"
+
+#include <chrono>
+#include <thread>
+
+namespace util {
+
+int64_t SteadyClock::NowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void SteadyClock::SleepFor(int64_t ns) {
+    if (ns > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+    }
+}
+
+Clock& DefaultClock() {
+    static SteadyClock clock;
+    return clock;
+}
+
+}  // namespace util
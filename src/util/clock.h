@@ -0,0 +1,46 @@
+#ifndef UTIL_CLOCK_H
+#define UTIL_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace util {
+
+// Time source for code that must be steppable outside real time. Timestamps are
+// monotonic nanoseconds. SteadyClock::SleepFor() really sleeps; VirtualClock's only
+// advances time, so a single-threaded simulation never waits.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual int64_t NowNs() const = 0;
+    virtual void SleepFor(int64_t ns) = 0;
+};
+
+// std::chrono::steady_clock; the default for every component.
+class SteadyClock : public Clock {
+public:
+    int64_t NowNs() const override;
+    void SleepFor(int64_t ns) override;
+};
+
+// Manually advanced clock for deterministic simulation.
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(int64_t start_ns = 0) : now_ns_(start_ns) {}
+
+    int64_t NowNs() const override { return now_ns_.load(std::memory_order_acquire); }
+    void SleepFor(int64_t ns) override { Advance(ns); }
+
+    void Advance(int64_t ns) { now_ns_.fetch_add(ns > 0 ? ns : 0, std::memory_order_acq_rel); }
+    void Set(int64_t ns) { now_ns_.store(ns, std::memory_order_release); }
+
+private:
+    std::atomic<int64_t> now_ns_;
+};
+
+// Process-wide steady clock instance.
+Clock& DefaultClock();
+
+}  // namespace util
+
+#endif  // UTIL_CLOCK_H
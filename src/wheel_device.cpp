@@ -7,36 +7,108 @@
 #include <cmath>
 #include <cstring>
 #include <iostream>
-#include <poll.h>
+#include <sys/epoll.h>
 #include <string>
 #include <thread>
 #include <unistd.h>
 
+#include "ffb/effect_engine.h"
 #include "logging/logger.h"
+#include "metrics/metrics.h"
 
 extern std::atomic<bool> running;
 
 namespace {
 
-constexpr size_t kFFBPacketSize = 7;
+constexpr size_t kFFBPacketSize = hid::kG29OutputReportSize;
+static_assert(std::tuple_size<ffb::CommandPacket>::value == kFFBPacketSize, "FFB packets are whole OUTPUT reports");
+static_assert(hid::G29Buttons::kCount == static_cast<size_t>(WheelButton::Count),
+              "every WheelButton needs a bit in the report");
 constexpr const char* kTag = "wheel_device";
+constexpr int kDefaultFFBTickHz = 1000;
+constexpr int64_t kIdleSleepNs = 2000000;
+constexpr int kEndpointRetryMinMs = 5;
+constexpr int kEndpointRetryMaxMs = 1000;
+// Steering counts (and counts/s) within which the FFB model counts as settled.
+constexpr float kSettleTolerance = 0.5f;
+// Shortest span a mouse delta is spread over (one report of an 8 kHz mouse).
+constexpr float kMinMotionSpanS = 125e-6f;
+// io_uring output reader: a few 7-byte OUTPUT reports per buffer.
+constexpr unsigned kOutputRingEntries = 8;
+constexpr unsigned kOutputRingBuffers = 16;
+constexpr unsigned kOutputRingBufferSize = 64;
+
+struct WheelMetrics {
+    metrics::Counter& reports_written;
+    metrics::Counter& reports_suppressed;
+    metrics::Counter& reports_keepalive;
+    metrics::CounterFamily& ffb_packets;
+    metrics::Counter& ffb_tick_overruns;
+    metrics::Histogram& ffb_tick_interval;
+    metrics::Counter& ffb_collapsed;
+    metrics::Counter& ffb_queue_stalls;
+    metrics::Counter& ffb_physics_steps;
+    metrics::Counter& ffb_wakeups;
+    metrics::Counter& writer_wakeups;
+    metrics::Counter& output_wakeups;
+    metrics::Histogram& input_latency;
+};
+
+WheelMetrics& Metrics() {
+    auto& registry = metrics::DefaultRegistry();
+    static WheelMetrics instance{
+        registry.GetCounter("wheel_reports_written_total", "13-byte IN reports written to the gadget"),
+        registry.GetCounter("wheel_reports_suppressed_total",
+                            "Reports not written because they matched the last report sent"),
+        registry.GetCounter("wheel_reports_keepalive_total", "Unchanged reports resent by the keepalive timer"),
+        registry.GetCounterFamily("wheel_ffb_packets_total", "7-byte FFB OUTPUT packets by opcode",
+                                  "opcode", 256),
+        registry.GetCounter("wheel_ffb_tick_overruns_total",
+                            "FFB ticks that woke more than two periods after the previous one"),
+        registry.GetHistogram("wheel_ffb_tick_interval_us", "Time between active FFB ticks", "microseconds"),
+        registry.GetCounter("wheel_ffb_commands_collapsed_total",
+                            "Constant-force updates superseded within one OUTPUT read burst"),
+        registry.GetCounter("wheel_ffb_queue_stalls_total", "Packets that waited for room in the FFB mailbox"),
+        registry.GetCounter("wheel_ffb_physics_steps_total", "Fixed integration steps run by the steering model"),
+        metrics::ThreadWakeups("ffb"),
+        metrics::ThreadWakeups("report_writer"),
+        metrics::ThreadWakeups("gadget_output"),
+        registry.GetHistogram("wheel_input_frame_latency_us",
+                              "Oldest kernel event timestamp in a frame to the frame being applied to the wheel state",
+                              "microseconds"),
+    };
+    return instance;
+}
 
 }  // namespace
 
 void WheelDevice::NotifyAllShutdownCVs() {
-    state_cv.notify_all();
-    ffb_cv.notify_all();
+    WakeReportWriter();
+    WakeFFB();
+    hid_device_.WakeEndpointWaiters();
 }
 WheelDevice::WheelDevice()
         : gadget_running(false), gadget_output_running(false),
-            enabled(false), steering(0.0f), user_steering(0.0f), ffb_offset(0.0f),
-      ffb_velocity(0.0f), ffb_gain(1.0f), throttle(0.0f), brake(0.0f),
-      clutch(0.0f), dpad_x(0), dpad_y(0), ffb_force(0),
-            ffb_autocenter(0), gadget_output_pending_len(0) {
+            clock_(&util::DefaultClock()), ffb_recorder_(nullptr), telemetry_(nullptr), io_backend_(io::Backend::kEpoll), ffb_scheduler_(nullptr), ffb_slot_(0), enabled(false), steering(0.0f), user_steering(0.0f), user_motion_ns(0), ffb_offset(0.0f),
+      ffb_velocity(0.0f), ffb_target(0.0f), ffb_gain(1.0f),
+      ffb_curve(std::make_shared<ffb::TorqueCurve>()), ffb_physics_version(0), throttle(0.0f), brake(0.0f),
+      clutch(0.0f), dpad_x(0), dpad_y(0),
+      last_report_valid_(false), last_report_ns_(0), gadget_output_pending_len(0) {
     ffb_running = false;
+    ffb_wake = false;
+    ffb_parked = false;
     state_dirty = false;
         warmup_frames.store(0, std::memory_order_relaxed);
     output_enabled.store(false, std::memory_order_relaxed);
+    ffb_tick_hz.store(kDefaultFFBTickHz, std::memory_order_relaxed);
+    report_keepalive_ns.store(0, std::memory_order_relaxed);
+    report_resync.store(true, std::memory_order_relaxed);
+    ffb_command_seq.store(0, std::memory_order_relaxed);
+    ffb_parsed_ns.store(0, std::memory_order_relaxed);
+    ffb_applied_seq.store(0, std::memory_order_relaxed);
+    ffb_applied_ns.store(0, std::memory_order_relaxed);
+    ffb_reported_seq.store(0, std::memory_order_relaxed);
+    ffb_reported_ns.store(0, std::memory_order_relaxed);
     button_states.fill(0);
 }
 
@@ -51,8 +123,8 @@ void WheelDevice::ShutdownThreads() {
         warmup_frames.store(0, std::memory_order_relaxed);
     output_enabled.store(false, std::memory_order_relaxed);
 
-    state_cv.notify_all();
-    ffb_cv.notify_all();
+    WakeReportWriter();
+    WakeFFB();
 
     StopGadgetThreads();
     if (ffb_thread.joinable()) {
@@ -72,7 +144,9 @@ bool WheelDevice::Create() {
     SendNeutral(true);
 
     ffb_running = true;
-    ffb_thread = std::thread(&WheelDevice::FFBUpdateThread, this);
+    if (!ffb_scheduler_) {
+        ffb_thread = std::thread(&WheelDevice::FFBUpdateThread, this);
+    }
     return true;
 }
 
@@ -93,10 +167,11 @@ void WheelDevice::EnsureGadgetThreadsStarted() {
 void WheelDevice::StopGadgetThreads() {
     if (gadget_running) {
         gadget_running = false;
-        state_cv.notify_all();
+        WakeReportWriter();
     }
     if (gadget_output_running) {
         gadget_output_running = false;
+        hid_device_.WakeEndpointWaiters();
     }
     if (gadget_thread.joinable()) {
         gadget_thread.join();
@@ -153,7 +228,7 @@ void WheelDevice::SetEnabled(bool enable, InputManager& input_manager) {
         warmup_frames.store(0, std::memory_order_release);
         state_dirty.store(false, std::memory_order_release);
 
-        std::array<uint8_t, 13> neutral_report;
+        hid::WheelReport neutral_report;
         {
             std::lock_guard<std::mutex> lock(state_mutex);
             ApplyNeutralLocked(false);
@@ -183,6 +258,7 @@ void WheelDevice::SetEnabled(bool enable, InputManager& input_manager) {
         EnsureGadgetThreadsStarted();
 
         bool neutral_sent = false;
+        report_resync.store(true, std::memory_order_release);
         output_enabled.store(true, std::memory_order_release);
         warmup_frames.store(0, std::memory_order_release);
         state_dirty.store(false, std::memory_order_release);
@@ -192,8 +268,17 @@ void WheelDevice::SetEnabled(bool enable, InputManager& input_manager) {
             ApplyNeutralLocked(false);
         }
         state_dirty.store(true, std::memory_order_release);
-        state_cv.notify_all();
-        neutral_sent = WaitForStateFlush(150);
+        WakeReportWriter();
+        hid_device_.RefreshUdcState();
+        if (hid_device_.HostConfigured()) {
+            neutral_sent = WaitForStateFlush(150);
+        } else {
+            // Host suspended or detached: the writer flushes the pending neutral report
+            // when the UDC is configured again.
+            LOG_INFO(kTag, "Host not configured (" << hid::UdcStateName(hid_device_.udc_state())
+                                                   << "); deferring first report");
+            neutral_sent = true;
+        }
 
         if (!neutral_sent) {
             output_enabled.store(false, std::memory_order_release);
@@ -207,15 +292,16 @@ void WheelDevice::SetEnabled(bool enable, InputManager& input_manager) {
                 }
                 return;
             }
+            report_resync.store(true, std::memory_order_release);
             output_enabled.store(true, std::memory_order_release);
         }
 
         warmup_frames.store(25, std::memory_order_release);
-        state_cv.notify_all();
+        WakeReportWriter();
     } else {
         warmup_frames.store(0, std::memory_order_release);
 
-        std::array<uint8_t, 13> neutral_report;
+        hid::WheelReport neutral_report;
         {
             std::lock_guard<std::mutex> lock(state_mutex);
             ApplyNeutralLocked(true);
@@ -225,19 +311,21 @@ void WheelDevice::SetEnabled(bool enable, InputManager& input_manager) {
         bool neutral_sent = false;
         if (gadget_running.load(std::memory_order_acquire) && output_enabled.load(std::memory_order_acquire)) {
             state_dirty.store(true, std::memory_order_release);
-            state_cv.notify_all();
+            WakeReportWriter();
             neutral_sent = WaitForStateFlush(150);
         }
 
         output_enabled.store(false, std::memory_order_release);
         state_dirty.store(false, std::memory_order_release);
 
-        if (!neutral_sent && !WriteReportBlocking(neutral_report)) {
+        if (!neutral_sent && hid_device_.HostConfigured() && !WriteReportBlocking(neutral_report)) {
             std::cerr << "[WheelDevice] Failed to send neutral frame while disabling" << std::endl;
         }
         input_manager.ResyncKeyStates();
         input_manager.GrabDevices(false);
     }
+    // The FFB thread parks while disabled; let it resume or park promptly.
+    WakeFFB();
     LOG_INFO(kTag, (enable ? "Emulation ENABLED" : "Emulation DISABLED"));
 }
 
@@ -256,8 +344,96 @@ void WheelDevice::SetFFBGain(float gain) {
     } else if (gain > 4.0f) {
         gain = 4.0f;
     }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ffb_gain = gain;
+    }
+    WakeFFB();
+}
+
+void WheelDevice::SetFFBTickRate(int hz) {
+    hz = std::clamp(hz, 100, 4000);
+    ffb_tick_hz.store(hz, std::memory_order_relaxed);
+    WakeFFB();
+}
+
+void WheelDevice::SetReportKeepalive(int ms) {
+    ms = std::clamp(ms, 0, 10000);
+    report_keepalive_ns.store(static_cast<int64_t>(ms) * 1000000, std::memory_order_relaxed);
+    WakeReportWriter();
+}
+
+void WheelDevice::SetIoBackend(io::Backend backend) {
+    io_backend_ = hid_device_.SetIoBackend(backend);
+}
+
+void WheelDevice::SetGadgetOptions(const hid::GadgetOptions& options) {
+    hid_device_.Configure(options);
+}
+
+void WheelDevice::SetMetricsLabels(const std::string& labels) {
+    hid_device_.SetMetricsLabels(labels);
+}
+
+void WheelDevice::SetFFBScheduler(ffb::TickScheduler* scheduler) {
+    ffb_scheduler_ = scheduler;
+    if (scheduler) {
+        ffb_slot_ = scheduler->Add([this]() { return StepFFB(); });
+    }
+}
+
+void WheelDevice::SetFFBCurve(const std::vector<ffb::CurvePoint>& points) {
+    // Compile outside the lock; the FFB thread picks up the new table on its next tick.
+    auto curve = std::make_shared<const ffb::TorqueCurve>(points);
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ffb_curve = std::move(curve);
+    }
+    WakeFFB();
+}
+
+void WheelDevice::SetFFBPhysics(const ffb::PhysicsParams& params) {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ffb_physics = params;
+        ++ffb_physics_version;
+    }
+    WakeFFB();
+}
+
+void WheelDevice::SetClock(util::Clock* clock) {
+    clock_ = clock ? clock : &util::DefaultClock();
+}
+
+void WheelDevice::SetReportSink(ReportSink sink) {
+    report_sink_ = std::move(sink);
+}
+
+void WheelDevice::SetFFBRecorder(ffb::TraceWriter* recorder) {
+    ffb_recorder_ = recorder;
+}
+
+void WheelDevice::SetTelemetry(telemetry::TelemetryWriter* writer) {
     std::lock_guard<std::mutex> lock(state_mutex);
-    ffb_gain = gain;
+    telemetry_ = writer;
+}
+
+void WheelDevice::EnableSimulation() {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    enabled = true;
+    ApplyNeutralLocked(true);
+    report_resync.store(true, std::memory_order_release);
+    output_enabled.store(true, std::memory_order_release);
+    state_dirty.store(true, std::memory_order_release);
+}
+
+WheelDevice::FFBTiming WheelDevice::GetFFBTiming() const {
+    FFBTiming timing;
+    timing.command_seq = ffb_command_seq.load(std::memory_order_acquire);
+    timing.parsed_ns = ffb_parsed_ns.load(std::memory_order_acquire);
+    timing.applied_ns = ffb_applied_ns.load(std::memory_order_acquire);
+    timing.reported_ns = ffb_reported_ns.load(std::memory_order_acquire);
+    return timing;
 }
 
 void WheelDevice::ProcessInputFrame(const InputFrame& frame, int sensitivity) {
@@ -267,8 +443,20 @@ void WheelDevice::ProcessInputFrame(const InputFrame& frame, int sensitivity) {
     bool changed = false;
     {
         std::lock_guard<std::mutex> lock(state_mutex);
+        changed |= ApplyInjectedSteeringLocked(frame);
         changed |= ApplySteeringDeltaLocked(frame.mouse_dx, sensitivity);
         changed |= ApplySnapshotLocked(frame.logical);
+        const bool moved = frame.mouse_dx != 0 || frame.steering_set || frame.steering_delta != 0.0f;
+        if (moved && frame.newest_event_ns > 0) {
+            user_motion_ns = frame.newest_event_ns;
+        }
+        if (changed) {
+            PublishTelemetryLocked(telemetry::RecordKind::kState);
+        }
+    }
+    if (frame.oldest_event_ns > 0) {
+        int64_t latency_ns = clock_->NowNs() - frame.oldest_event_ns;
+        Metrics().input_latency.Observe(static_cast<uint64_t>(std::max<int64_t>(latency_ns, 0) / 1000));
     }
     if (changed) {
         NotifyStateChanged();
@@ -280,6 +468,9 @@ void WheelDevice::ApplySnapshot(const WheelInputState& snapshot) {
     {
         std::lock_guard<std::mutex> lock(state_mutex);
         changed = ApplySnapshotLocked(snapshot);
+        if (changed) {
+            PublishTelemetryLocked(telemetry::RecordKind::kState);
+        }
     }
     if (changed) {
         NotifyStateChanged();
@@ -298,16 +489,39 @@ void WheelDevice::SendNeutral(bool reset_ffb) {
 
 void WheelDevice::NotifyStateChanged() {
     state_dirty.store(true, std::memory_order_release);
-    state_cv.notify_all();
+    WakeReportWriter();
+    WakeFFB();
+}
+
+void WheelDevice::WakeFFB() {
+    if (ffb_scheduler_) {
+        ffb_scheduler_->Wake(ffb_slot_);
+        return;
+    }
+    ffb_wake.store(true);
+    // Pairs with the seq_cst store of ffb_parked in FFBUpdateThread: either the thread
+    // sees ffb_wake in its predicate, or we see it parked and serialize on the mutex so
+    // the notify cannot land between its predicate check and the wait. The lock-free
+    // mailbox path therefore only touches state_mutex when the thread is asleep.
+    if (ffb_parked.load()) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+    }
     ffb_cv.notify_all();
 }
 
+void WheelDevice::WakeReportWriter() {
+    // The writer waits without a timeout, and its flags are set outside state_mutex;
+    // passing through the mutex orders this notify after its predicate check.
+    { std::lock_guard<std::mutex> lock(state_mutex); }
+    state_cv.notify_all();
+}
+
 bool WheelDevice::WaitForStateFlush(int timeout_ms) {
     if (timeout_ms <= 0) {
         return !state_dirty.load(std::memory_order_acquire);
     }
-    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
-    while (std::chrono::steady_clock::now() < deadline) {
+    const int64_t deadline_ns = clock_->NowNs() + static_cast<int64_t>(timeout_ms) * 1000000;
+    while (clock_->NowNs() < deadline_ns) {
         if (!state_dirty.load(std::memory_order_acquire)) {
             return true;
         }
@@ -316,7 +530,7 @@ bool WheelDevice::WaitForStateFlush(int timeout_ms) {
             !output_enabled.load(std::memory_order_acquire)) {
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        clock_->SleepFor(kIdleSleepNs);
     }
     return !state_dirty.load(std::memory_order_acquire);
 }
@@ -337,10 +551,22 @@ bool WheelDevice::ApplySteeringDeltaLocked(int delta, int sensitivity) {
     return ApplySteeringLocked();
 }
 
+bool WheelDevice::ApplyInjectedSteeringLocked(const InputFrame& frame) {
+    if (!frame.steering_set && frame.steering_delta == 0.0f) {
+        return false;
+    }
+    const float max_angle = 32767.0f;
+    if (frame.steering_set) {
+        user_steering = frame.steering;
+    }
+    user_steering = std::clamp(user_steering + frame.steering_delta, -max_angle, max_angle);
+    return ApplySteeringLocked();
+}
+
 bool WheelDevice::ApplySnapshotLocked(const WheelInputState& snapshot) {
     bool changed = false;
-    auto set_axis = [&](float& axis, bool pressed) {
-        float next = pressed ? 100.0f : 0.0f;
+    auto set_axis = [&](float& axis, uint8_t percent) {
+        float next = static_cast<float>(percent);
         if (axis != next) {
             axis = next;
             changed = true;
@@ -371,9 +597,11 @@ bool WheelDevice::ApplySnapshotLocked(const WheelInputState& snapshot) {
 void WheelDevice::ApplyNeutralLocked(bool reset_ffb) {
     steering = 0.0f;
     user_steering = 0.0f;
+    user_motion_ns = 0;
     if (reset_ffb) {
         ffb_offset = 0.0f;
         ffb_velocity = 0.0f;
+        ffb_target = 0.0f;
     }
     throttle = 0.0f;
     brake = 0.0f;
@@ -381,34 +609,27 @@ void WheelDevice::ApplyNeutralLocked(bool reset_ffb) {
     dpad_x = 0;
     dpad_y = 0;
     button_states.fill(0);
+    PublishTelemetryLocked(telemetry::RecordKind::kState);
 }
 
 
-std::array<uint8_t, 13> WheelDevice::BuildHIDReport() {
+hid::WheelReport WheelDevice::BuildHIDReport() {
     std::lock_guard<std::mutex> lock(state_mutex);
     return BuildHIDReportLocked();
 }
 
-std::array<uint8_t, 13> WheelDevice::BuildHIDReportLocked() const {
-    std::array<uint8_t, 13> report{};
+hid::WheelReport WheelDevice::BuildHIDReportLocked() const {
+    using Report = hid::G29Report;
+    using Axes = hid::G29Axes;
+    hid::WheelReport report{};
 
     uint16_t steering_u = static_cast<uint16_t>(static_cast<int16_t>(steering) + 32768);
-    report[0] = steering_u & 0xFF;
-    report[1] = (steering_u >> 8) & 0xFF;
+    Report::Set<Axes, Axes::kSteering>(report, steering_u);
+    Report::Set<Axes, Axes::kClutch>(report, 65535 - static_cast<uint16_t>(clutch * 655.35f));
+    Report::Set<Axes, Axes::kThrottle>(report, 65535 - static_cast<uint16_t>(throttle * 655.35f));
+    Report::Set<Axes, Axes::kBrake>(report, 65535 - static_cast<uint16_t>(brake * 655.35f));
 
-    uint16_t clutch_u = 65535 - static_cast<uint16_t>(clutch * 655.35f);
-    report[2] = clutch_u & 0xFF;
-    report[3] = (clutch_u >> 8) & 0xFF;
-
-    uint16_t throttle_u = 65535 - static_cast<uint16_t>(throttle * 655.35f);
-    report[4] = throttle_u & 0xFF;
-    report[5] = (throttle_u >> 8) & 0xFF;
-
-    uint16_t brake_u = 65535 - static_cast<uint16_t>(brake * 655.35f);
-    report[6] = brake_u & 0xFF;
-    report[7] = (brake_u >> 8) & 0xFF;
-
-    uint8_t hat = 0x0F;
+    uint32_t hat = hid::G29Hat::kCentered;
     if (dpad_y == -1 && dpad_x == 0) hat = 0;
     else if (dpad_y == -1 && dpad_x == 1) hat = 1;
     else if (dpad_y == 0 && dpad_x == 1) hat = 2;
@@ -418,116 +639,288 @@ std::array<uint8_t, 13> WheelDevice::BuildHIDReportLocked() const {
     else if (dpad_y == 0 && dpad_x == -1) hat = 6;
     else if (dpad_y == -1 && dpad_x == -1) hat = 7;
 
-    report[8] = hat & 0x0F;
-
-    uint32_t button_bits = BuildButtonBitsLocked();
-    report[9] = button_bits & 0xFF;
-    report[10] = (button_bits >> 8) & 0xFF;
-    report[11] = (button_bits >> 16) & 0xFF;
-    report[12] = (button_bits >> 24) & 0xFF;
-
+    Report::Set<hid::G29Hat>(report, hat);
+    Report::SetAll<hid::G29Buttons>(report, BuildButtonBitsLocked());
     return report;
 }
 
-bool WheelDevice::SendGadgetReport() {
-    auto report_data = BuildHIDReport();
-    return hid_device_.WriteReportBlocking(report_data);
-}
-
-bool WheelDevice::WriteReportBlocking(const std::array<uint8_t, 13>& report) {
-    return hid_device_.WriteReportBlocking(report);
+bool WheelDevice::WriteReportBlocking(const hid::WheelReport& report) {
+    bool written = report_sink_ ? report_sink_(report) : hid_device_.WriteReportBlocking(report);
+    if (!written) {
+        return false;
+    }
+    Metrics().reports_written.Increment();
+    return true;
 }
 
 
 void WheelDevice::USBGadgetPollingThread() {
     std::unique_lock<std::mutex> lock(state_mutex);
     while (gadget_running && running) {
-        state_cv.wait_for(lock, std::chrono::milliseconds(2), [&] {
+        // Pending state is held back while the host is suspended or detached; the output
+        // thread wakes the writer when the UDC reaches `configured` again.
+        auto pending = [&] {
             return !gadget_running || !running ||
-                   state_dirty.load(std::memory_order_acquire) ||
-                   warmup_frames.load(std::memory_order_acquire) > 0;
-        });
+                   (HostReady() && (state_dirty.load(std::memory_order_acquire) ||
+                                    warmup_frames.load(std::memory_order_acquire) > 0));
+        };
+        // No timeout unless a keepalive is due: every producer of state_dirty/warmup_frames
+        // calls WakeReportWriter(), and so does SetReportKeepalive().
+        const int64_t keepalive_ns = report_keepalive_ns.load(std::memory_order_relaxed);
+        if (keepalive_ns > 0 && last_report_valid_ && output_enabled.load(std::memory_order_acquire) &&
+            HostReady()) {
+            const int64_t remaining_ns = last_report_ns_ + keepalive_ns - clock_->NowNs();
+            state_cv.wait_for(lock, std::chrono::nanoseconds(std::max<int64_t>(remaining_ns, 0)), pending);
+        } else {
+            state_cv.wait(lock, pending);
+        }
         if (!gadget_running || !running) {
             break;
         }
-        bool should_send = state_dirty.exchange(false, std::memory_order_acq_rel);
-        bool warmup = false;
-        int pending = warmup_frames.load(std::memory_order_acquire);
-        if (pending > 0) {
-            warmup = true;
-            warmup_frames.fetch_sub(1, std::memory_order_acq_rel);
-        }
-        bool allow_output = output_enabled.load(std::memory_order_acquire);
+        Metrics().writer_wakeups.Increment();
         lock.unlock();
-        if (allow_output && (should_send || warmup)) {
-            bool ready = hid_device_.IsReady();
-            if (!ready) {
-                if (!hid_device_.IsUdcBound()) {
-                    state_dirty.store(true, std::memory_order_release);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-                } else if (!hid_device_.WaitForEndpointReady(50)) {
-                    state_dirty.store(true, std::memory_order_release);
-                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
-                } else {
-                    ready = true;
-                }
-            }
-            if (ready && !SendGadgetReport()) {
-                hid_device_.ResetEndpoint();
-                state_dirty.store(true, std::memory_order_release);
-            }
-        }
+        EmitPendingReport();
         lock.lock();
     }
 }
 
-void WheelDevice::USBGadgetOutputThread() {
-    while (gadget_output_running && running) {
+bool WheelDevice::HostReady() const {
+    return report_sink_ || hid_device_.HostConfigured();
+}
+
+bool WheelDevice::EmitPendingReport() {
+    if (!HostReady()) {
+        // Leave state_dirty/warmup_frames pending for the flush on reconfiguration.
+        return false;
+    }
+    bool should_send = state_dirty.exchange(false, std::memory_order_acq_rel);
+    bool warmup = false;
+    int pending = warmup_frames.load(std::memory_order_acquire);
+    if (pending > 0) {
+        warmup = true;
+        warmup_frames.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    bool allow_output = output_enabled.load(std::memory_order_acquire);
+    if (report_resync.exchange(false, std::memory_order_acq_rel)) {
+        last_report_valid_ = false;
+    }
+    const int64_t keepalive_ns = report_keepalive_ns.load(std::memory_order_relaxed);
+    bool keepalive = keepalive_ns > 0 && last_report_valid_ && clock_->NowNs() - last_report_ns_ >= keepalive_ns;
+    if (!allow_output || !(should_send || warmup || keepalive)) {
+        return false;
+    }
+
+    bool ready = report_sink_ || hid_device_.IsReady();
+    if (!ready) {
         if (!hid_device_.IsUdcBound()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            continue;
+            state_dirty.store(true, std::memory_order_release);
+            clock_->SleepFor(kIdleSleepNs);
+        } else if (!hid_device_.WaitForEndpointReady(50)) {
+            state_dirty.store(true, std::memory_order_release);
+            clock_->SleepFor(kIdleSleepNs);
+        } else {
+            ready = true;
         }
+    }
+    if (!ready) {
+        last_report_valid_ = false;
+        return false;
+    }
 
-        if (!hid_device_.IsReady() && !hid_device_.WaitForEndpointReady(10)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-            continue;
+    uint64_t applied_seq = ffb_applied_seq.load(std::memory_order_acquire);
+    auto report = BuildHIDReport();
+    // Warmup frames are deliberate repeats; anything else identical to what the host
+    // already holds is dropped until the keepalive (if any) asks for a resend.
+    if (last_report_valid_ && report == last_report_ && !warmup) {
+        if (!keepalive) {
+            Metrics().reports_suppressed.Increment();
+            return false;
         }
-
-        int fd = hid_device_.fd();
-        if (fd < 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-            continue;
+        Metrics().reports_keepalive.Increment();
+    }
+    if (!WriteReportBlocking(report)) {
+        if (!report_sink_ && hid_device_.HostConfigured()) {
+            hid_device_.ResetEndpoint();
         }
+        last_report_valid_ = false;
+        state_dirty.store(true, std::memory_order_release);
+        return false;
+    }
+    last_report_ = report;
+    last_report_valid_ = true;
+    last_report_ns_ = clock_->NowNs();
+    if (applied_seq != ffb_reported_seq.load(std::memory_order_relaxed)) {
+        ffb_reported_ns.store(clock_->NowNs(), std::memory_order_release);
+        ffb_reported_seq.store(applied_seq, std::memory_order_release);
+    }
+    return true;
+}
 
-        struct pollfd pfd;
-        pfd.fd = fd;
-        pfd.events = POLLIN;
-        pfd.revents = 0;
+void WheelDevice::USBGadgetOutputThread() {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        LOG_ERROR(kTag, "epoll_create1 failed: " << std::strerror(errno));
+        return;
+    }
+    const int event_fd = hid_device_.endpoint_event_fd();
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = event_fd;
+    if (event_fd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev);
+    }
 
-        int ret = poll(&pfd, 1, 5);
+    // The UDC state attribute signals EPOLLPRI/EPOLLERR on every link state change.
+    const int state_fd = hid_device_.udc_state_fd();
+    if (state_fd >= 0) {
+        ev.events = EPOLLPRI;
+        ev.data.fd = state_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, state_fd, &ev) != 0) {
+            LOG_ERROR(kTag, "epoll_ctl(ADD udc state) failed: " << std::strerror(errno));
+        }
+    }
+    hid::UdcState udc_state = hid::UdcState::kUnknown;
+
+    // io_uring backend: the endpoint is read by a multishot request whose completions
+    // wake this loop through the ring fd, instead of by EPOLLIN + read() on the fd.
+    io::Uring ring;
+    bool use_ring = false;
+    if (io_backend_ == io::Backend::kIoUring) {
+        use_ring = ring.Init(kOutputRingEntries, kOutputRingBuffers, kOutputRingBufferSize);
+        if (use_ring) {
+            ev.events = EPOLLIN;
+            ev.data.fd = ring.fd();
+            use_ring = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ring.fd(), &ev) == 0;
+        }
+        if (!use_ring) {
+            LOG_WARN(kTag, "io_uring unavailable for the OUTPUT endpoint; using epoll");
+        }
+    }
+    const int ring_fd = use_ring ? ring.fd() : -1;
+    uint64_t ring_tag = 0;  // user_data of the posted multishot read; 0 = none
+    uint64_t next_ring_tag = 1;
+
+    int registered_fd = -1;
+    uint64_t registered_generation = 0;
+    bool refresh = true;
+    int retry_ms = kEndpointRetryMinMs;
+    while (gadget_output_running && running) {
+        // Endpoint/UDC state is only re-read after HidDevice signals a change, so a quiet
+        // host leaves this thread parked in epoll_wait with no timeout.
+        int timeout_ms = -1;
+        if (refresh) {
+            refresh = false;
+            hid::UdcState state = hid_device_.RefreshUdcState();
+            if (state != udc_state) {
+                udc_state = state;
+                if (state == hid::UdcState::kConfigured) {
+                    // Whatever changed while the host was away goes out once, even if it
+                    // matches the last report written before the suspend.
+                    report_resync.store(true, std::memory_order_release);
+                    state_dirty.store(true, std::memory_order_release);
+                    WakeReportWriter();
+                }
+            }
+            const uint64_t generation = hid_device_.endpoint_generation();
+            int fd = -1;
+            if (hid_device_.IsUdcBound()) {
+                fd = hid_device_.fd();
+                if (fd < 0 && hid_device_.WaitForEndpointReady(10)) {
+                    fd = hid_device_.fd();
+                }
+                if (fd < 0) {
+                    // Bound but the endpoint will not open yet; retry without a signal,
+                    // backing off so a host that never opens it costs ~1 wakeup/s.
+                    refresh = true;
+                    timeout_ms = retry_ms;
+                    retry_ms = std::min(retry_ms * 2, kEndpointRetryMaxMs);
+                } else {
+                    retry_ms = kEndpointRetryMinMs;
+                }
+            }
+            // Any reset, including one by the report writer, re-registers the endpoint:
+            // the kernel dropped the closed file from the epoll set (and a posted
+            // multishot read still holds it) even if the reopened fd has the same number.
+            if (fd != registered_fd || generation != registered_generation) {
+                registered_generation = generation;
+                if (use_ring && ring_tag != 0) {
+                    ring.PrepareCancel(ring_tag, 0);
+                    ring.Submit();
+                    ring_tag = 0;
+                } else if (registered_fd >= 0 && !use_ring) {
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, registered_fd, nullptr);
+                }
+                registered_fd = -1;
+                if (fd >= 0 && use_ring) {
+                    ring_tag = next_ring_tag++;
+                    ring.PrepareReadMultishot(fd, ring_tag);
+                    ring.Submit();
+                    registered_fd = fd;
+                } else if (fd >= 0) {
+                    ev.events = EPOLLIN;
+                    ev.data.fd = fd;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+                        registered_fd = fd;
+                    } else {
+                        LOG_ERROR(kTag, "epoll_ctl(ADD hidg) failed: " << std::strerror(errno));
+                        refresh = true;
+                        timeout_ms = kEndpointRetryMinMs;
+                    }
+                }
+            }
+        }
+
+        struct epoll_event events[3];
+        int ready = epoll_wait(epoll_fd, events, 3, timeout_ms);
         if (!gadget_output_running || !running) {
             break;
         }
-        if (ret < 0) {
+        Metrics().output_wakeups.Increment();
+        if (ready < 0) {
             if (errno == EINTR) {
                 continue;
             }
-            hid_device_.ResetEndpoint();
+            LOG_ERROR(kTag, "epoll_wait failed: " << std::strerror(errno));
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
             continue;
         }
-        if (ret == 0) {
-            continue;
-        }
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-            hid_device_.ResetEndpoint();
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
-            continue;
-        }
-        if (pfd.revents & POLLIN) {
-            ReadGadgetOutput(fd);
+
+        for (int i = 0; i < ready; ++i) {
+            if (events[i].data.fd == event_fd) {
+                uint64_t counter;
+                while (read(event_fd, &counter, sizeof(counter)) > 0) {
+                }
+                refresh = true;
+                continue;
+            }
+            if (events[i].data.fd == state_fd) {
+                // The refresh re-reads the attribute, which re-arms the notification.
+                refresh = true;
+                continue;
+            }
+            if (events[i].data.fd == ring_fd) {
+                ReapGadgetOutput(ring, ring_tag, registered_fd);
+                if (ring_tag == 0) {
+                    registered_fd = -1;  // re-arm even if the reopened endpoint reuses the fd
+                }
+                continue;
+            }
+            if (events[i].data.fd != registered_fd) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                // ResetEndpoint signals the eventfd, which triggers the refresh.
+                hid_device_.ResetEndpoint();
+                report_resync.store(true, std::memory_order_release);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                ReadGadgetOutput(registered_fd);
+            }
         }
     }
+
+    close(epoll_fd);
 }
 
 void WheelDevice::ReadGadgetOutput(int fd) {
@@ -546,206 +939,239 @@ void WheelDevice::ReadGadgetOutput(int fd) {
                 break;
             }
             hid_device_.ResetEndpoint();
+            report_resync.store(true, std::memory_order_release);
             break;
         }
         if (bytes == 0) {
             break;
         }
 
-        size_t total = static_cast<size_t>(bytes);
-        size_t offset = 0;
-        while (offset < total) {
-            size_t needed = kFFBPacketSize - gadget_output_pending_len;
-            size_t chunk = total - offset;
-            if (chunk > needed) {
-                chunk = needed;
-            }
-            std::memcpy(gadget_output_pending.data() + gadget_output_pending_len,
-                        buffer + offset,
-                        chunk);
-            gadget_output_pending_len += chunk;
-            offset += chunk;
-
-            if (gadget_output_pending_len == kFFBPacketSize) {
-                if (output_enabled.load(std::memory_order_acquire)) {
-                    ParseFFBCommand(gadget_output_pending.data(), kFFBPacketSize);
-                }
-                gadget_output_pending_len = 0;
-            }
-        }
+        ConsumeOutputBytes(buffer, static_cast<size_t>(bytes));
     }
+    FlushFFBCommands();
 }
 
-void WheelDevice::FFBUpdateThread() {
-    float filtered_ffb = 0.0f;
-    using clock = std::chrono::steady_clock;
-    auto last = clock::now();
-
-    while (true) {
-        std::unique_lock<std::mutex> lock(state_mutex);
-        ffb_cv.wait_for(lock, std::chrono::milliseconds(1));
-        if (!ffb_running || !running) {
-            break;
-        }
-
-        if (!enabled || !output_enabled.load(std::memory_order_acquire)) {
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-            continue;
+void WheelDevice::ReapGadgetOutput(io::Uring& ring, uint64_t& ring_tag, int fd) {
+    bool rearm = false;
+    bool failed = false;
+    ring.Reap([&](const io::Uring::Completion& completion) {
+        if (ring_tag == 0 || completion.user_data != ring_tag) {
+            return;  // cancel results and reads of an endpoint already replaced
         }
-
-        int16_t local_force = ffb_force;
-        int16_t local_autocenter = ffb_autocenter;
-        float local_offset = ffb_offset;
-        float local_velocity = ffb_velocity;
-        float local_gain = ffb_gain;
-        float local_steering = steering;
-        lock.unlock();
-
-        auto now = clock::now();
-        float dt = std::chrono::duration<float>(now - last).count();
-        if (dt <= 0.0f) dt = 0.001f;
-        if (dt > 0.01f) dt = 0.01f;
-        last = now;
-
-        float commanded_force = ShapeFFBTorque(static_cast<float>(local_force));
-
-        const float force_filter_hz = 38.0f;
-        float alpha = 1.0f - std::exp(-dt * force_filter_hz);
-        alpha = std::clamp(alpha, 0.0f, 1.0f);
-        filtered_ffb += (commanded_force - filtered_ffb) * alpha;
-
-        float spring = 0.0f;
-        if (local_autocenter > 0) {
-            spring = -(local_steering * static_cast<float>(local_autocenter)) / 32768.0f;
-        }
-
-        const float offset_limit = 22000.0f;
-        float target_offset = (filtered_ffb + spring) * local_gain;
-        target_offset = std::clamp(target_offset, -offset_limit, offset_limit);
-
-        const float stiffness = 120.0f;
-        const float damping = 8.0f;
-        const float max_velocity = 90000.0f;
-        float error = target_offset - local_offset;
-        local_velocity += error * stiffness * dt;
-        float damping_factor = std::exp(-damping * dt);
-        local_velocity *= damping_factor;
-        local_velocity = std::clamp(local_velocity, -max_velocity, max_velocity);
-
-        local_offset += local_velocity * dt;
-        if (local_offset > offset_limit) {
-            local_offset = offset_limit;
-            local_velocity = 0.0f;
-        } else if (local_offset < -offset_limit) {
-            local_offset = -offset_limit;
-            local_velocity = 0.0f;
+        if (completion.res > 0 && completion.data) {
+            ConsumeOutputBytes(completion.data, static_cast<size_t>(completion.res));
+        } else if (completion.res < 0 && completion.res != -ENOBUFS) {
+            failed = true;
+            return;
         }
-
-        lock.lock();
-        if (!ffb_running || !running) {
-            break;
+        if (!completion.more) {
+            rearm = true;
         }
-        ffb_offset = local_offset;
-        ffb_velocity = local_velocity;
-        bool steering_changed = ApplySteeringLocked();
-        lock.unlock();
+    });
+    FlushFFBCommands();
+    if (failed) {
+        // The multishot read has ended; ResetEndpoint signals the refresh that re-arms it.
+        ring_tag = 0;
+        hid_device_.ResetEndpoint();
+        report_resync.store(true, std::memory_order_release);
+        return;
+    }
+    if (rearm && fd >= 0) {
+        ring.PrepareReadMultishot(fd, ring_tag);
+        ring.Submit();
+    }
+}
 
-        if (steering_changed) {
-            state_dirty.store(true, std::memory_order_release);
-            state_cv.notify_all();
+void WheelDevice::ConsumeOutputBytes(const uint8_t* data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+        size_t needed = kFFBPacketSize - gadget_output_pending_len;
+        size_t chunk = std::min(size - offset, needed);
+        std::memcpy(gadget_output_pending.data() + gadget_output_pending_len, data + offset, chunk);
+        gadget_output_pending_len += chunk;
+        offset += chunk;
+
+        if (gadget_output_pending_len == kFFBPacketSize) {
+            Metrics().ffb_packets.Increment(gadget_output_pending[0]);
+            if (ffb_recorder_) {
+                ffb_recorder_->Write(clock_->NowNs(), gadget_output_pending);
+            }
+            if (output_enabled.load(std::memory_order_acquire)) {
+                if (ffb_batch.Full()) {
+                    FlushFFBCommands();
+                }
+                if (ffb_batch.Add(gadget_output_pending)) {
+                    Metrics().ffb_collapsed.Increment();
+                }
+            }
+            gadget_output_pending_len = 0;
         }
     }
 }
 
-void WheelDevice::ParseFFBCommand(const uint8_t* data, size_t size) {
-    if (size != kFFBPacketSize) {
-        return;
-    }
+void WheelDevice::InjectOutputReport(const uint8_t* data, size_t size) {
+    ConsumeOutputBytes(data, size);
+    FlushFFBCommands();
+}
 
-    std::lock_guard<std::mutex> lock(state_mutex);
-    if (!enabled) {
+void WheelDevice::FlushFFBCommands() {
+    if (ffb_batch.Empty()) {
         return;
     }
-    bool state_changed = false;
-
-    uint8_t cmd = data[0];
 
-    switch (cmd) {
-        case 0x11: {  // Constant force slot update
-            int8_t force = static_cast<int8_t>(data[2]) - 0x80;
-            ffb_force = static_cast<int16_t>(-force) * 48;
-            state_changed = true;
-            break;
-        }
-        case 0x13:  // Stop force effect
-            ffb_force = 0;
-            state_changed = true;
-            break;
-        case 0xf5:  // Disable autocenter
-            if (ffb_autocenter != 0) {
-                ffb_autocenter = 0;
-                state_changed = true;
+    for (size_t i = 0; i < ffb_batch.size(); ++i) {
+        bool stalled = false;
+        while (!ffb_commands.Push(ffb_batch[i])) {
+            // Only reachable if the physics loop stalls; never drop a stop/download.
+            if (!stalled) {
+                Metrics().ffb_queue_stalls.Increment();
+                stalled = true;
             }
-            break;
-        case 0xfe:  // Configure autocenter
-            if (data[1] == 0x0d) {
-                int16_t strength = static_cast<int16_t>(data[2]) * 16;
-                if (ffb_autocenter != strength) {
-                    ffb_autocenter = strength;
-                    state_changed = true;
-                }
+            WakeFFB();
+            if (!ffb_running || !running) {
+                // No FFB thread to drain the ring (shutdown or simulation).
+                ffb_batch.Clear();
+                return;
             }
-            break;
-        case 0x14:  // Enable default autocenter
-            if (ffb_autocenter == 0) {
-                ffb_autocenter = 1024;
-                state_changed = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    ffb_batch.Clear();
+
+    ffb_parsed_ns.store(clock_->NowNs(), std::memory_order_release);
+    ffb_command_seq.fetch_add(1, std::memory_order_acq_rel);
+    WakeFFB();
+}
+
+void WheelDevice::FFBUpdateThread() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            auto woken = [this]() { return ffb_wake.load() || !ffb_running || !running; };
+            if (ffb_loop_.parked) {
+                // Disabled, or settled with no time-varying effect: nothing changes
+                // until a command, input, setting or enable change calls WakeFFB().
+                ffb_parked.store(true);
+                ffb_cv.wait(lock, woken);
+                ffb_parked.store(false);
+            } else {
+                const int tick_hz = ffb_tick_hz.load(std::memory_order_relaxed);
+                ffb_cv.wait_for(lock, std::chrono::microseconds(1000000 / tick_hz), woken);
             }
-            break;
-        case 0xf8:  // Extended commands
-            switch (data[1]) {
-                case 0x81:  // Wheel range
-                case 0x12:  // LEDs
-                case 0x09:  // Mode switch
-                case 0x0a:  // Mode revert on reset
-                default:
-                    break;
+            if (!ffb_running || !running) {
+                break;
             }
-            break;
-        default:
-            break;
+            ffb_wake.store(false, std::memory_order_relaxed);
+        }
+        Metrics().ffb_wakeups.Increment();
+        StepFFB();
     }
+}
 
-    if (state_changed) {
-        ffb_cv.notify_all();
+bool WheelDevice::StepFFB() {
+    FFBLoopState& loop = ffb_loop_;
+    ffb::CommandPacket packet;
+
+    std::unique_lock<std::mutex> lock(state_mutex);
+    if (!enabled || !output_enabled.load(std::memory_order_acquire)) {
+        loop.last_tick_valid = false;
+        loop.parked = true;
+        lock.unlock();
+        while (ffb_commands.Pop(packet)) {
+        }
+        return false;
     }
-}
+    const bool resumed = loop.parked;
+    loop.parked = false;
 
-float WheelDevice::ShapeFFBTorque(float raw_force) const {
-    float abs_force = std::fabs(raw_force);
-    if (abs_force < 80.0f) {
-        return raw_force * (abs_force / 80.0f);
+    if (loop.physics_version != ffb_physics_version) {
+        loop.physics_version = ffb_physics_version;
+        loop.model.SetParams(ffb_physics);
     }
+    loop.model.SetState(ffb_offset, ffb_velocity);
+    float local_gain = ffb_gain;
+    if (loop.curve != ffb_curve) {
+        loop.curve = ffb_curve;
+    }
+    float local_user_steering = user_steering;
+    int64_t local_motion_ns = user_motion_ns;
+    uint64_t command_seq = ffb_command_seq.load(std::memory_order_acquire);
+    lock.unlock();
 
-    const float min_gain = 0.25f;
-    const float slip_knee = 4000.0f;
-    const float slip_full = 14000.0f;
-    float t = (abs_force - 80.0f) / (slip_full - 80.0f);
-    t = std::clamp(t, 0.0f, 1.0f);
-    float slip_weight = t * t;
+    while (ffb_commands.Pop(packet)) {
+        loop.effects.ApplyCommand(packet.data(), packet.size());
+    }
 
-    float gain = min_gain;
-    if (abs_force > slip_knee) {
-        float heavy = (abs_force - slip_knee) / (slip_full - slip_knee);
-        heavy = std::clamp(heavy, 0.0f, 1.0f);
-        gain = min_gain + (1.0f - min_gain) * heavy;
+    const int64_t now_ns = clock_->NowNs();
+    const int64_t period_us = 1000000 / ffb_tick_hz.load(std::memory_order_relaxed);
+    float elapsed = 0.0f;
+    if (loop.last_tick_valid && resumed) {
+        // The model sat at rest while parked; resume as if the previous tick just ran.
+        elapsed = static_cast<float>(period_us) * 1e-6f;
+    } else if (loop.last_tick_valid) {
+        int64_t interval_us = (now_ns - loop.last_ns) / 1000;
+        Metrics().ffb_tick_interval.Observe(static_cast<uint64_t>(std::max<int64_t>(interval_us, 0)));
+        if (interval_us > 2 * period_us) {
+            Metrics().ffb_tick_overruns.Increment();
+        }
+        elapsed = static_cast<float>(now_ns - loop.last_ns) * 1e-9f;
     } else {
-        gain = min_gain + (slip_weight * (1.0f - min_gain));
+        loop.model.ResetClock();
+    }
+    loop.last_ns = now_ns;
+
+    // Mouse motion between wakes is spread evenly over the fixed steps. Motion made
+    // while parked is applied as a position change only. The velocity is weighted by
+    // the kernel time the motion took (newest event now vs. at the previous tick), not
+    // by the tick interval it landed in, so queueing jitter between the mouse and this
+    // thread does not show up as velocity noise. A gap longer than two ticks means the
+    // motion just started, and the tick interval is used instead.
+    float user_velocity = 0.0f;
+    if (loop.last_tick_valid && !resumed && elapsed > 0.0f) {
+        float moved = local_user_steering - loop.last_user_steering;
+        float span = elapsed;
+        if (moved != 0.0f && loop.last_motion_ns > 0 && local_motion_ns > loop.last_motion_ns) {
+            float motion_span = static_cast<float>(local_motion_ns - loop.last_motion_ns) * 1e-9f;
+            if (motion_span <= 2.0f * elapsed) {
+                span = std::max(motion_span, kMinMotionSpanS);
+            }
+        }
+        user_velocity = moved / span;
+    }
+    loop.last_user_steering = local_user_steering;
+    loop.last_motion_ns = local_motion_ns;
+    loop.last_tick_valid = true;
+
+    const ffb::TorqueCurve& curve = *loop.curve;
+    int steps = loop.model.Advance(elapsed, local_gain, [&](float offset, float velocity, float step) {
+        float position = std::clamp((local_user_steering + offset) / 32768.0f, -1.0f, 1.0f);
+        float wheel_velocity = (user_velocity + velocity) / 32768.0f;
+        ffb::EffectForces forces = loop.kernel.Evaluate(loop.effects.slots(), position, wheel_velocity, step);
+        forces.open_loop = curve.Apply(forces.open_loop);
+        return forces;
+    });
+    Metrics().ffb_physics_steps.Increment(static_cast<uint64_t>(steps));
+    loop.parked = steps > 0 && user_velocity == 0.0f && ffb_commands.Empty() && !loop.effects.HasPeriodic() &&
+                  !loop.kernel.Sweeping(loop.effects.slots()) && loop.model.Settled(kSettleTolerance);
+
+    lock.lock();
+    ffb_offset = loop.model.offset();
+    ffb_velocity = loop.model.velocity();
+    ffb_target = loop.model.target();
+    bool steering_changed = ApplySteeringLocked();
+    PublishTelemetryLocked(telemetry::RecordKind::kFFBTick);
+    lock.unlock();
+
+    if (command_seq != ffb_applied_seq.load(std::memory_order_relaxed)) {
+        ffb_applied_ns.store(clock_->NowNs(), std::memory_order_release);
+        ffb_applied_seq.store(command_seq, std::memory_order_release);
     }
 
-    const float boost = 3.0f;
-    return raw_force * gain * boost;
+    if (steering_changed) {
+        state_dirty.store(true, std::memory_order_release);
+        WakeReportWriter();
+    }
+    return !loop.parked;
 }
 
 bool WheelDevice::ApplySteeringLocked() {
@@ -767,3 +1193,25 @@ uint32_t WheelDevice::BuildButtonBitsLocked() const {
     }
     return bits;
 }
+
+void WheelDevice::PublishTelemetryLocked(telemetry::RecordKind kind) {
+    if (!telemetry_) {
+        return;
+    }
+    telemetry::Record record{};
+    record.time_ns = clock_->NowNs();
+    record.kind = static_cast<uint32_t>(kind);
+    record.buttons = BuildButtonBitsLocked();
+    record.steering = steering;
+    record.user_steering = user_steering;
+    record.ffb_offset = ffb_offset;
+    record.ffb_velocity = ffb_velocity;
+    record.ffb_target = ffb_target;
+    record.throttle = throttle;
+    record.brake = brake;
+    record.clutch = clutch;
+    record.dpad_x = dpad_x;
+    record.dpad_y = dpad_y;
+    record.enabled = enabled && output_enabled.load(std::memory_order_relaxed);
+    telemetry_->Publish(record);
+}
@@ -4,12 +4,23 @@
 #include <array>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <string>
+#include <vector>
 
+#include "ffb/command_queue.h"
+#include "ffb/steering_model.h"
+#include "ffb/tick_scheduler.h"
+#include "ffb/torque_curve.h"
+#include "ffb/trace.h"
 #include "hid/hid_device.h"
 #include "input/wheel_input.h"
+#include "io/uring.h"
+#include "telemetry/telemetry_ring.h"
+#include "util/clock.h"
 #include "wheel_types.h"
 
 class InputManager;
@@ -17,6 +28,15 @@ extern std::atomic<bool> running;
 
 class WheelDevice {
 public:
+    // Clock timestamps (ns) of the most recent FFB command batch as it moves through
+    // the mailbox -> FFBUpdateThread -> USBGadgetPollingThread. Zero until seen.
+    struct FFBTiming {
+        uint64_t command_seq = 0;
+        int64_t parsed_ns = 0;
+        int64_t applied_ns = 0;
+        int64_t reported_ns = 0;
+    };
+
     WheelDevice();
     ~WheelDevice();
 
@@ -33,28 +53,81 @@ public:
     void SetEnabled(bool enable, InputManager& input_manager);
     void ToggleEnabled(InputManager& input_manager);
     void SetFFBGain(float gain);
+    void SetFFBTickRate(int hz);
+    void SetFFBCurve(const std::vector<ffb::CurvePoint>& points);
+    void SetFFBPhysics(const ffb::PhysicsParams& params);
+    // Byte-identical reports are not rewritten; with a keepalive period > 0 the last
+    // report is resent after that long without a write. 0 disables the keepalive.
+    void SetReportKeepalive(int ms);
+    // Call before Create(). kIoUring keeps a multishot read posted on the hidg
+    // OUTPUT endpoint and writes IN reports through a ring; falls back to epoll.
+    void SetIoBackend(io::Backend backend);
+    // Call before Create(). Which gadget, UDC and hidg node this wheel uses.
+    void SetGadgetOptions(const hid::GadgetOptions& options);
+    // Call before Create(). See HidDevice::SetMetricsLabels.
+    void SetMetricsLabels(const std::string& labels);
+    // Call before Create(). The scheduler's thread steps this wheel's FFB model
+    // instead of a thread of its own; it must outlive the device.
+    void SetFFBScheduler(ffb::TickScheduler* scheduler);
+    FFBTiming GetFFBTiming() const;
 
     void ProcessInputFrame(const InputFrame& frame, int sensitivity);
     void SendNeutral(bool reset_ffb = true);
     void ApplySnapshot(const WheelInputState& snapshot);
 
+    // Injection points for deterministic runs. Set them before Create() or
+    // EnableSimulation(); the clock and recorder must outlive the device.
+    using ReportSink = std::function<bool(const hid::WheelReport&)>;
+    void SetClock(util::Clock* clock);
+    void SetReportSink(ReportSink sink);     // replaces /dev/hidg0 writes
+    void SetFFBRecorder(ffb::TraceWriter* recorder);  // logs every OUTPUT packet
+    // Publishes every committed state change and FFB tick; see telemetry_ring.h.
+    void SetTelemetry(telemetry::TelemetryWriter* writer);
+
+    // Enables output without USB hardware or threads. The caller then drives the
+    // same code the threads run: InjectOutputReport (output thread), StepFFB (FFB
+    // thread, one wake) and EmitPendingReport (report writer, one iteration).
+    void EnableSimulation();
+    void InjectOutputReport(const uint8_t* data, size_t size);
+    bool StepFFB();  // false once disabled or settled; the FFB thread then parks
+    bool EmitPendingReport();  // true if a report was written
+
 private:
+    // FFB-thread-owned state carried between wakes.
+    struct FFBLoopState {
+        ffb::EffectTable effects;
+        ffb::EffectKernel kernel;
+        ffb::SteeringModel model;
+        std::shared_ptr<const ffb::TorqueCurve> curve;
+        int64_t last_ns = 0;
+        bool last_tick_valid = false;
+        float last_user_steering = 0.0f;
+        int64_t last_motion_ns = 0;
+        uint64_t physics_version = 0;
+        bool parked = false;  // last step found nothing to do; wait for WakeFFB()
+    };
+
     void NotifyStateChanged();
-    bool SendGadgetReport();
-    std::array<uint8_t, 13> BuildHIDReport();
-    std::array<uint8_t, 13> BuildHIDReportLocked() const;
+    void WakeFFB();
+    void WakeReportWriter();
+    bool HostReady() const;  // a report sink, or the UDC is configured (or unmonitored)
+    hid::WheelReport BuildHIDReport();
+    hid::WheelReport BuildHIDReportLocked() const;
     void USBGadgetPollingThread();
     void USBGadgetOutputThread();
     void ReadGadgetOutput(int fd);
+    void ReapGadgetOutput(io::Uring& ring, uint64_t& ring_tag, int fd);
+    void ConsumeOutputBytes(const uint8_t* data, size_t size);
     void FFBUpdateThread();
-    void ParseFFBCommand(const uint8_t* data, size_t size);
-    float ShapeFFBTorque(float raw_force) const;
+    void FlushFFBCommands();
     bool ApplySteeringLocked();
     bool ApplySteeringDeltaLocked(int delta, int sensitivity);
+    bool ApplyInjectedSteeringLocked(const InputFrame& frame);  // absolute, then delta
     bool ApplySnapshotLocked(const WheelInputState& snapshot);
     void ApplyNeutralLocked(bool reset_ffb);
     uint32_t BuildButtonBitsLocked() const;
-    bool WriteReportBlocking(const std::array<uint8_t, 13>& report);
+    void PublishTelemetryLocked(telemetry::RecordKind kind);
+    bool WriteReportBlocking(const hid::WheelReport& report);
     bool WaitForStateFlush(int timeout_ms);
     void EnsureGadgetThreadsStarted();
     void StopGadgetThreads();
@@ -65,22 +138,46 @@ private:
     std::atomic<bool> gadget_output_running;
     std::thread ffb_thread;
     std::atomic<bool> ffb_running;
+    std::atomic<bool> ffb_wake;    // set with every reason for the FFB thread to step
+    std::atomic<bool> ffb_parked;  // FFB thread is in an untimed wait
     std::atomic<bool> state_dirty;
     std::atomic<int> warmup_frames;
     std::atomic<bool> output_enabled;
+    std::atomic<int> ffb_tick_hz;
+    std::atomic<int64_t> report_keepalive_ns;
+    std::atomic<bool> report_resync;  // next report goes out even if unchanged
+    std::atomic<uint64_t> ffb_command_seq;
+    std::atomic<int64_t> ffb_parsed_ns;
+    std::atomic<uint64_t> ffb_applied_seq;
+    std::atomic<int64_t> ffb_applied_ns;
+    std::atomic<uint64_t> ffb_reported_seq;
+    std::atomic<int64_t> ffb_reported_ns;
     std::mutex enable_mutex;
     std::mutex state_mutex;
     std::condition_variable state_cv;
     std::condition_variable ffb_cv;
 
     hid::HidDevice hid_device_;
+    util::Clock* clock_;
+    ReportSink report_sink_;
+    ffb::TraceWriter* ffb_recorder_;
+    telemetry::TelemetryWriter* telemetry_;  // written under state_mutex
+    io::Backend io_backend_;
+    ffb::TickScheduler* ffb_scheduler_;  // null = own FFBUpdateThread
+    size_t ffb_slot_;
+    FFBLoopState ffb_loop_;
 
     bool enabled;
     float steering;
     float user_steering;
+    int64_t user_motion_ns;  // kernel time of the newest mouse motion folded into user_steering
     float ffb_offset;
     float ffb_velocity;
+    float ffb_target;  // telemetry only: the model's pull target after the last tick
     float ffb_gain;
+    std::shared_ptr<const ffb::TorqueCurve> ffb_curve;
+    ffb::PhysicsParams ffb_physics;
+    uint64_t ffb_physics_version;
     float throttle;
     float brake;
     float clutch;
@@ -88,9 +185,14 @@ private:
     int8_t dpad_x;
     int8_t dpad_y;
 
-    int16_t ffb_force;
-    int16_t ffb_autocenter;
-    std::array<uint8_t, 7> gadget_output_pending{};
+    // Owned by the report writer (USBGadgetPollingThread / EmitPendingReport).
+    hid::WheelReport last_report_{};
+    bool last_report_valid_;
+    int64_t last_report_ns_;
+
+    ffb::CommandQueue ffb_commands;  // output thread -> FFB thread
+    ffb::CommandBatch ffb_batch;     // owned by USBGadgetOutputThread
+    ffb::CommandPacket gadget_output_pending{};
     size_t gadget_output_pending_len;
 };
 
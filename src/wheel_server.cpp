@@ -0,0 +1,236 @@
+#include "wheel_server.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include "logging/logger.h"
+
+extern std::atomic<bool> running;
+
+namespace {
+
+constexpr const char* kTag = "wheel_server";
+
+// Per-wheel name of a shared resource: wheel 0 keeps the configured name, wheel N
+// gets a ".N" suffix.
+std::string ForWheel(const std::string& name, int index) {
+    if (index == 0 || name.empty()) {
+        return name;
+    }
+    return name + "." + std::to_string(index);
+}
+
+std::string WheelLabel(int index) {
+    return index == 0 ? std::string() : " for wheel " + std::to_string(index);
+}
+
+// Auto-detection grabs the same keyboard and mouse for every wheel, so with several
+// wheels each must name its own devices. Symlinks (/dev/input/by-id/...) are resolved
+// before comparing.
+bool DistinctDevices(const std::vector<std::pair<int, WheelConfig>>& settings) {
+    std::vector<std::pair<std::string, int>> held;
+    for (const auto& entry : settings) {
+        const std::string section = entry.first == 0 ? "[devices]" : "[wheel." + std::to_string(entry.first) + "]";
+        for (const std::string* path : {&entry.second.keyboard_device, &entry.second.mouse_device}) {
+            if (path->empty()) {
+                std::cerr << section << " needs keyboard= and mouse= when more than one wheel is configured"
+                          << std::endl;
+                return false;
+            }
+            char resolved[PATH_MAX];
+            const std::string node = realpath(path->c_str(), resolved) ? std::string(resolved) : *path;
+            for (const auto& other : held) {
+                if (other.first == node && other.second != entry.first) {
+                    std::cerr << section << " uses " << *path << ", which wheel " << other.second
+                              << " already reads" << std::endl;
+                    return false;
+                }
+            }
+            held.emplace_back(node, entry.first);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+WheelServer::WheelServer() : frames_pending_(false) {}
+
+WheelServer::~WheelServer() {
+    Shutdown();
+}
+
+bool WheelServer::Start(const Config& config) {
+    WheelConfig first;
+    first.keyboard_device = config.keyboard_device;
+    first.mouse_device = config.mouse_device;
+    first.sensitivity = config.sensitivity;
+    first.udc = config.udc;
+    first.remote_listen = config.remote_listen;
+    std::vector<std::pair<int, WheelConfig>> settings = {{0, first}};
+    for (const auto& entry : config.extra_wheels) {
+        settings.emplace_back(entry.first, entry.second);
+    }
+
+    const bool shared_ffb = settings.size() > 1;
+    if (shared_ffb && !DistinctDevices(settings)) {
+        return false;
+    }
+    ffb_scheduler_.SetTickRate(config.ffb_tick_rate);
+    // Every wheel is registered with the scheduler before any is created: once a wheel's
+    // threads run they call TickScheduler::Wake, which must not race with Add.
+    for (const auto& entry : settings) {
+        wheels_.push_back(std::make_unique<Wheel>());
+        Wheel& wheel = *wheels_.back();
+        wheel.index = entry.first;
+        wheel.sensitivity = entry.second.sensitivity > 0 ? entry.second.sensitivity : config.sensitivity;
+        if (shared_ffb) {
+            // Per-wheel gauges get their own series; one wheel keeps the plain names.
+            const std::string labels = "wheel=\"" + std::to_string(wheel.index) + "\"";
+            wheel.device.SetFFBScheduler(&ffb_scheduler_);
+            wheel.device.SetMetricsLabels(labels);
+            wheel.input.SetMetricsLabels(labels);
+        }
+    }
+    // Shutdown() also cleans up wheels that were never started or failed halfway.
+    for (size_t i = 0; i < wheels_.size(); ++i) {
+        if (!StartWheel(*wheels_[i], config, settings[i].second)) {
+            return false;
+        }
+    }
+    if (shared_ffb) {
+        ffb_scheduler_.Start();
+        LOG_INFO(kTag, "Running " << wheels_.size() << " wheels with a shared FFB tick");
+    }
+    return true;
+}
+
+bool WheelServer::StartWheel(Wheel& wheel, const Config& config, const WheelConfig& settings) {
+    const int index = wheel.index;
+    const std::string label = WheelLabel(index);
+    WheelDevice& device = wheel.device;
+
+    const std::string record_path = ForWheel(config.ffb_record_path, index);
+    if (!record_path.empty()) {
+        if (wheel.recorder.Open(record_path)) {
+            device.SetFFBRecorder(&wheel.recorder);
+            std::cout << "Recording FFB traffic to " << record_path << std::endl;
+        } else {
+            std::cerr << "Cannot open FFB trace " << record_path << "; recording disabled" << std::endl;
+        }
+    }
+    const std::string telemetry_shm = ForWheel(config.telemetry_shm, index);
+    if (!telemetry_shm.empty()) {
+        if (wheel.telemetry.Open(telemetry_shm, static_cast<uint32_t>(config.telemetry_slots))) {
+            device.SetTelemetry(&wheel.telemetry);
+        } else {
+            std::cerr << "Cannot create telemetry segment " << telemetry_shm << "; telemetry disabled" << std::endl;
+        }
+    }
+
+    hid::GadgetOptions gadget;
+    if (index > 0) {
+        // Distinct serials keep hosts from merging wheels that share VID/PID.
+        char serial[16];
+        std::snprintf(serial, sizeof(serial), "%012d", index + 1);
+        gadget.name += std::to_string(index);
+        gadget.serial = serial;
+    }
+    gadget.udc = settings.udc;
+    device.SetGadgetOptions(gadget);
+    device.SetFFBGain(config.ffb_gain);
+    device.SetFFBTickRate(config.ffb_tick_rate);
+    device.SetFFBCurve(config.ffb_curve);
+    device.SetFFBPhysics(config.ffb_physics);
+    device.SetReportKeepalive(config.report_keepalive_ms);
+    device.SetIoBackend(config.io_backend);
+    if (!device.Create()) {
+        std::cerr << "Failed to create virtual wheel device" << label << std::endl;
+        return false;
+    }
+
+    InputManager& input = wheel.input;
+    input.SetIoBackend(config.io_backend);
+    input.SetKeyBindings(settings.bindings);
+    input.SetFrameListener([this]() { OnFrames(); });
+    const std::string inject_shm = ForWheel(config.inject_shm, index);
+    if (!inject_shm.empty() && !input.EnableInjection(inject_shm, config.inject_lanes, config.inject_hold_ms)) {
+        std::cerr << "Cannot create injection segment " << inject_shm << "; injection disabled" << std::endl;
+    }
+    if (!settings.remote_listen.empty() &&
+        !input.EnableRemote(settings.remote_listen, config.remote_priority, config.remote_hold_ms)) {
+        std::cerr << "Cannot listen for remote input on " << settings.remote_listen << "; remote input disabled"
+                  << std::endl;
+    }
+    if (!input.Initialize(settings.keyboard_device, settings.mouse_device)) {
+        std::cerr << "Failed to initialize input manager" << label << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void WheelServer::OnFrames() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_pending_ = true;
+    }
+    cv_.notify_one();
+}
+
+void WheelServer::Run() {
+    InputFrame frame;
+    while (running) {
+        {
+            // Every input thread of every wheel sets frames_pending_ after queueing and
+            // when it stops, which is also how a shutdown reaches this wait.
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return frames_pending_ || !running.load(std::memory_order_relaxed); });
+            frames_pending_ = false;
+        }
+        for (auto& wheel : wheels_) {
+            while (running && wheel->input.TryGetFrame(frame)) {
+                HandleFrame(*wheel, frame);
+            }
+        }
+    }
+}
+
+void WheelServer::HandleFrame(Wheel& wheel, const InputFrame& frame) {
+    WheelDevice& device = wheel.device;
+    InputManager& input = wheel.input;
+    if (device.IsEnabled() && !input.AllRequiredGrabbed()) {
+        std::cerr << "Required input device lost; disabling emulator" << WheelLabel(wheel.index) << std::endl;
+        device.SetEnabled(false, input);
+        return;
+    }
+
+    if (frame.toggle_pressed) {
+        if (!input.DevicesReady()) {
+            LOG_WARN(kTag, "Toggle pressed before devices ready; ignoring request" << WheelLabel(wheel.index));
+        } else {
+            device.ToggleEnabled(input);
+        }
+    }
+
+    if (device.IsEnabled()) {
+        device.ProcessInputFrame(frame, wheel.sensitivity);
+    }
+}
+
+void WheelServer::Shutdown() {
+    // On shutdown, notify all threads to wake up and exit
+    for (auto& wheel : wheels_) {
+        wheel->device.SetEnabled(false, wheel->input);
+        wheel->device.NotifyAllShutdownCVs();
+    }
+    for (auto& wheel : wheels_) {
+        wheel->input.Shutdown();
+    }
+    ffb_scheduler_.Stop();
+    for (auto& wheel : wheels_) {
+        wheel->device.ShutdownThreads();
+    }
+}
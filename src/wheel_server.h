@@ -0,0 +1,60 @@
+#ifndef WHEEL_SERVER_H
+#define WHEEL_SERVER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "ffb/tick_scheduler.h"
+#include "ffb/trace.h"
+#include "input/input_manager.h"
+#include "telemetry/telemetry_ring.h"
+#include "wheel_device.h"
+
+// Runs every configured wheel in one process. Each wheel has its own gadget, input
+// devices and report writer/OUTPUT reader threads; input frames of all wheels are
+// dispatched by Run() on the calling thread, and with more than one wheel a single
+// ffb::TickScheduler steps every FFB model per pass instead of a thread per wheel.
+class WheelServer {
+public:
+    WheelServer();
+    ~WheelServer();
+
+    WheelServer(const WheelServer&) = delete;
+    WheelServer& operator=(const WheelServer&) = delete;
+
+    // Creates the gadgets and starts input for wheel 0 and every [wheel.N]. Fails if
+    // any wheel cannot be brought up.
+    bool Start(const Config& config);
+    // Applies input frames until `running` is cleared.
+    void Run();
+    void Shutdown();
+
+    size_t wheel_count() const { return wheels_.size(); }
+
+private:
+    struct Wheel {
+        int index = 0;
+        int sensitivity = 50;
+        // Declared before the device so they outlive its threads.
+        ffb::TraceWriter recorder;
+        telemetry::TelemetryWriter telemetry;
+        WheelDevice device;
+        InputManager input;
+    };
+
+    bool StartWheel(Wheel& wheel, const Config& config, const WheelConfig& settings);
+    void HandleFrame(Wheel& wheel, const InputFrame& frame);
+    void OnFrames();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool frames_pending_;  // guarded by mutex_
+    ffb::TickScheduler ffb_scheduler_;
+    std::vector<std::unique_ptr<Wheel>> wheels_;
+};
+
+#endif  // WHEEL_SERVER_H